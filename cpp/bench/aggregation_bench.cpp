@@ -0,0 +1,129 @@
+// Trade-to-candle aggregation as the strategy thread and the shards run it:
+// every trade rolls into the forming 1m..60m bars (or opens the next ones) and
+// refreshes the streaming signal. Also the chart's candle pyramid: one
+// repaint's worth of buckets, and the per-tick upkeep.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "candle_pyramid.hpp"
+#include "multi_market_engine.hpp"
+
+namespace {
+
+// ~10 trades a second around a random walk.
+std::vector<TradeTick> make_trades(size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.0005);
+    std::exponential_distribution<double> gap(1.0 / 100.0);
+    std::vector<TradeTick> out(n);
+    double px = 51'000'000.0;
+    long long ts = 1'700'000'000'000LL;
+    for (TradeTick& t : out) {
+        px *= std::exp(step(rng));
+        ts += 1 + static_cast<long long>(gap(rng));
+        t.ts_ms = ts;
+        t.price = px;
+        t.volume = 0.001;
+        t.is_bid = (rng() & 1) != 0;
+    }
+    return out;
+}
+
+// One-minute bars along a random walk.
+std::vector<Candle> make_bars(size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.001);
+    std::vector<Candle> out(n);
+    double px = 51'000'000.0;
+    for (size_t i = 0; i < n; ++i) {
+        Candle& c = out[i];
+        c.ts_ms = 1'700'000'000'000LL + static_cast<long long>(i) * 60'000;
+        c.open = px;
+        px *= std::exp(step(rng));
+        c.close = px;
+        c.high = std::max(c.open, c.close) * (1.0 + std::abs(step(rng)));
+        c.low = std::min(c.open, c.close) * (1.0 - std::abs(step(rng)));
+        c.volume = 1.0;
+    }
+    return out;
+}
+
+} // namespace
+
+static void BM_CandleAggregation(benchmark::State& state) {
+    const std::vector<TradeTick> tape = make_trades(100'000, 5);
+    const long long span = tape.back().ts_ms - tape.front().ts_ms + 1;
+    MarketState market;
+    std::vector<Candle> seed(MarketState::kMaxCandles);
+    for (size_t i = 0; i < seed.size(); ++i) {
+        seed[i].ts_ms = tape.front().ts_ms - static_cast<long long>(seed.size() - i) * 300'000;
+        seed[i].open = seed[i].high = seed[i].low = seed[i].close = tape.front().price;
+    }
+    market.seed(seed);
+
+    // the tape replays shifted forward each lap, so time only moves on
+    size_t i = 0;
+    long long offset = 0;
+    TradeTick t;
+    for (auto _ : state) {
+        t = tape[i];
+        t.ts_ms += offset;
+        market.on_trade(t);
+        if (++i == tape.size()) {
+            i = 0;
+            offset += span;
+        }
+    }
+    benchmark::DoNotOptimize(market.last_decision);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CandleAggregation);
+
+// A repaint of a 1600 px wide chart at a random pan and zoom: the buckets of
+// the level that puts one to four of them in a pixel column.
+static void BM_CandlePyramidView(benchmark::State& state) {
+    const std::vector<Candle> bars = make_bars(static_cast<size_t>(state.range(0)), 9);
+    CandlePyramid pyramid;
+    pyramid.assign(bars);
+    constexpr size_t kColumns = 1600;
+    std::mt19937_64 rng(3);
+    std::vector<CandleBucket> out;
+    size_t buckets = 0;
+    for (auto _ : state) {
+        const size_t visible = 100 + rng() % (bars.size() - 100);
+        const size_t first = rng() % (bars.size() - visible + 1);
+        size_t level = 0;
+        while (CandlePyramid::span_of(level + 1) * kColumns <= visible) ++level;
+        pyramid.collect(level, first, first + visible, out);
+        buckets += out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.counters["buckets"] = benchmark::Counter(static_cast<double>(buckets) / static_cast<double>(state.iterations()));
+}
+BENCHMARK(BM_CandlePyramidView)->Arg(100'000)->Arg(1'000'000);
+
+// Live upkeep: the forming bar rewritten every tick, a new bar every 16th,
+// the oldest dropped to hold the size.
+static void BM_CandlePyramidTick(benchmark::State& state) {
+    const std::vector<Candle> bars = make_bars(200'000, 11);
+    CandlePyramid pyramid;
+    pyramid.assign(CandleSpan(bars.data(), 100'000));
+    size_t next = 100'000;
+    unsigned tick = 0;
+    for (auto _ : state) {
+        Candle c = bars[next % bars.size()];
+        if ((++tick & 15) == 0) {
+            ++next;
+            pyramid.push_back(c);
+            pyramid.pop_front();
+        } else {
+            c.close *= 1.0001;
+            pyramid.set_back(c);
+        }
+    }
+    benchmark::DoNotOptimize(pyramid.back());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CandlePyramidTick);
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include <curl/curl.h>
+#include <openssl/crypto.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "bench_util.hpp"
+
+namespace {
+
+std::atomic<long long> g_allocs{0};
+
+void* counting_malloc(size_t n, const char*, int) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(n);
+}
+void* counting_realloc(void* p, size_t n, const char*, int) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    return std::realloc(p, n);
+}
+void counting_free(void* p, const char*, int) { std::free(p); }
+
+} // namespace
+
+long long bench_alloc_count() {
+    return g_allocs.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    // must run before OpenSSL allocates anything
+    CRYPTO_set_mem_functions(counting_malloc, counting_realloc, counting_free);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    curl_global_cleanup();
+    return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <benchmark/benchmark.h>
+
+// Heap allocations so far: operator new plus OpenSSL's allocator.
+long long bench_alloc_count();
+
+inline void report_allocs(benchmark::State& state, long long before, const char* name) {
+    state.counters[name] = benchmark::Counter(
+        static_cast<double>(bench_alloc_count() - before), benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,81 @@
+// Per-tick cost of the scalper in its batch and streaming forms (the
+// equivalence check is in tests/indicators_test.cpp).
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "indicators.hpp"
+#include "order_book.hpp"
+#include "strategy_5m_scalper.hpp"
+
+namespace {
+
+struct Tape {
+    std::vector<Candle> bars;                // closed 5m bars
+    std::vector<std::vector<double>> ticks;  // trade prices inside each bar
+};
+
+Tape make_tape(size_t bars, size_t ticks_per_bar, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.002);
+    Tape t;
+    double px = 50'000'000.0;
+    for (size_t i = 0; i < bars; ++i) {
+        Candle c{};
+        c.ts_ms = static_cast<long long>(i) * 300'000;
+        c.open = c.high = c.low = px;
+        std::vector<double> prices;
+        for (size_t k = 0; k < ticks_per_bar; ++k) {
+            px *= std::exp(step(rng));
+            prices.push_back(px);
+            c.high = std::max(c.high, px);
+            c.low = std::min(c.low, px);
+            c.volume += 0.01;
+        }
+        c.close = px;
+        t.bars.push_back(c);
+        t.ticks.push_back(std::move(prices));
+    }
+    return t;
+}
+
+} // namespace
+
+static void BM_ScalperPerTickBatch(benchmark::State& state) {
+    const Tape tape = make_tape(120, 1, 11);
+    Strategy5mScalper strategy;
+    for (auto _ : state) benchmark::DoNotOptimize(strategy.evaluate(tape.bars));
+}
+BENCHMARK(BM_ScalperPerTickBatch);
+
+static void BM_ScalperPerTickStream(benchmark::State& state) {
+    const Tape tape = make_tape(120, 1, 11);
+    ScalperStream stream;
+    stream.seed(tape.bars);
+    for (auto _ : state) benchmark::DoNotOptimize(stream.on_tick(tape.bars.back()));
+}
+BENCHMARK(BM_ScalperPerTickStream);
+
+// The shard path: the same evaluation plus the book's depth-aware checks,
+// on a breakout bar so the book is actually walked.
+static void BM_ScalperEvaluateWithBook(benchmark::State& state) {
+    std::vector<Candle> bars = make_tape(120, 1, 11).bars;
+    double high = 0.0;
+    for (const Candle& c : bars) high = std::max(high, c.high);
+    bars.back().close = bars.back().high = high * 1.01;
+    OrderbookSnapshot snap{};
+    const double mid = bars.back().close;
+    snap.depth = 15;
+    for (int i = 0; i < snap.depth; ++i) {
+        snap.levels[i] = BookLevel{mid * (1.0 + 0.0002 * (i + 1)), 0.05 * (i + 1), mid * (1.0 - 0.0002 * (i + 1)),
+                                   0.06 * (i + 1)};
+    }
+    OrderBook book;
+    book.apply(snap);
+    Strategy5mScalper strategy;
+    const double size = 10'000.0 / mid;
+    if (!strategy.evaluate(bars, book, size).enter_long) state.counters["no_signal"] = 1;
+    for (auto _ : state) benchmark::DoNotOptimize(strategy.evaluate(bars, book, size));
+}
+BENCHMARK(BM_ScalperEvaluateWithBook);
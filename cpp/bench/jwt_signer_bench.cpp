@@ -0,0 +1,166 @@
+// Token signing cost before/after JwtSigner. allocs/token counts both
+// operator new and OpenSSL's allocator (see bench_main.cpp).
+#include <benchmark/benchmark.h>
+#include <curl/curl.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include "bench_util.hpp"
+#include "jwt_signer.hpp"
+#include "upbit_rest.hpp"
+
+namespace {
+
+// The signer as it was before JwtSigner, kept verbatim for comparison.
+namespace legacy {
+
+std::string generate_nonce() {
+    std::array<unsigned char, 16> bytes{};
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (auto& b : bytes) b = static_cast<unsigned char>(dist(gen));
+    std::ostringstream oss;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) oss << '-';
+        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(bytes[i]);
+    }
+    return oss.str();
+}
+
+std::string bytes_to_hex(const unsigned char* data, size_t len) {
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (size_t i = 0; i < len; ++i) {
+        oss << std::setw(2) << static_cast<int>(data[i]);
+    }
+    return oss.str();
+}
+
+std::string base64_url_encode(const std::string& input) {
+    if (input.empty()) return {};
+    int encoded_len = 4 * ((static_cast<int>(input.size()) + 2) / 3);
+    std::string buffer(static_cast<size_t>(encoded_len), '\0');
+    int actual_len = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&buffer[0]),
+                                     reinterpret_cast<const unsigned char*>(input.data()),
+                                     static_cast<int>(input.size()));
+    if (actual_len <= 0) return {};
+    buffer.resize(static_cast<size_t>(actual_len));
+    for (char& c : buffer) {
+        if (c == '+') c = '-';
+        else if (c == '/') c = '_';
+    }
+    while (!buffer.empty() && buffer.back() == '=') buffer.pop_back();
+    return buffer;
+}
+
+std::string url_encode(const std::string& value) {
+    CURL* curl = curl_easy_init();
+    if (!curl) return {};
+    char* escaped = curl_easy_escape(curl, value.c_str(), static_cast<int>(value.size()));
+    std::string result;
+    if (escaped) {
+        result.assign(escaped);
+        curl_free(escaped);
+    }
+    curl_easy_cleanup(curl);
+    return result;
+}
+
+std::string build_authorization_token(const std::string& access_key_, const std::string& secret_key_,
+                                      const std::vector<std::pair<std::string, std::string>>& params) {
+    if (access_key_.empty() || secret_key_.empty()) return {};
+    std::vector<std::pair<std::string, std::string>> sorted(params);
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    std::ostringstream query_stream;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i > 0) query_stream << '&';
+        query_stream << url_encode(sorted[i].first) << '=' << url_encode(sorted[i].second);
+    }
+    const std::string query = query_stream.str();
+    std::string query_hash_hex;
+    if (!query.empty()) {
+        unsigned char hash[SHA512_DIGEST_LENGTH];
+        SHA512(reinterpret_cast<const unsigned char*>(query.data()), query.size(), hash);
+        query_hash_hex = bytes_to_hex(hash, SHA512_DIGEST_LENGTH);
+    }
+
+    const std::string nonce = generate_nonce();
+
+    std::ostringstream payload_oss;
+    payload_oss << R"({"access_key":")" << access_key_ << R"(","nonce":")" << nonce << R"(")";
+    if (!query.empty()) {
+        payload_oss << R"(,"query_hash":")" << query_hash_hex << R"(","query_hash_alg":"SHA512")";
+    }
+    payload_oss << '}';
+
+    const std::string header = R"({"alg":"HS256","typ":"JWT"})";
+    const std::string header_b64 = base64_url_encode(header);
+    const std::string payload_b64 = base64_url_encode(payload_oss.str());
+    if (header_b64.empty() || payload_b64.empty()) return {};
+    const std::string signing_input = header_b64 + "." + payload_b64;
+
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int mac_len = 0;
+    HMAC(EVP_sha256(),
+         reinterpret_cast<const unsigned char*>(secret_key_.data()), static_cast<int>(secret_key_.size()),
+         reinterpret_cast<const unsigned char*>(signing_input.data()), signing_input.size(),
+         mac, &mac_len);
+    std::string signature(reinterpret_cast<char*>(mac), mac_len);
+    const std::string signature_b64 = base64_url_encode(signature);
+    if (signature_b64.empty()) return {};
+    return "Bearer " + signing_input + "." + signature_b64;
+}
+
+} // namespace legacy
+
+const std::string kAccess = "AbCdEfGhIjKlMnOpQrStUvWxYz0123456789abcd";
+const std::string kSecret = "SeCrEtKeY0123456789abcdefghijklmnopqrstu";
+
+const std::vector<std::pair<std::string, std::string>> kOrderParams = {
+    {"market", "KRW-BTC"}, {"side", "bid"}, {"ord_type", "limit"},
+    {"price", "95000000"}, {"volume", "0.00012345"},
+};
+
+} // namespace
+
+static void BM_JwtLegacy(benchmark::State& state) {
+    const long long before = bench_alloc_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy::build_authorization_token(kAccess, kSecret, kOrderParams));
+    }
+    report_allocs(state, before, "allocs/token");
+}
+BENCHMARK(BM_JwtLegacy);
+
+static void BM_JwtSignerString(benchmark::State& state) {
+    JwtSigner signer;
+    signer.set_credentials(kAccess, kSecret);
+    const long long before = bench_alloc_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(signer.sign(kOrderParams));
+    }
+    report_allocs(state, before, "allocs/token");
+}
+BENCHMARK(BM_JwtSignerString);
+
+static void BM_JwtSignerBuffer(benchmark::State& state) {
+    JwtSigner signer;
+    signer.set_credentials(kAccess, kSecret);
+    std::array<QueryParam, 5> params{};
+    for (size_t i = 0; i < params.size(); ++i) params[i] = {kOrderParams[i].first, kOrderParams[i].second};
+    char buf[JwtSigner::kMaxToken];
+    const long long before = bench_alloc_count();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(signer.sign(params.data(), params.size(), buf, sizeof(buf)));
+    }
+    report_allocs(state, before, "allocs/token");
+}
+BENCHMARK(BM_JwtSignerBuffer);
@@ -0,0 +1,270 @@
+// End-to-end numbers against the local mock exchange: REST order round trips
+// through UpbitRestClient (sign, HTTP, parse), the same orders pipelined
+// through OrderGateway, and WebSocket market-data
+// throughput into WsFrameDecoder. Both run over loopback, so they measure
+// the client stack rather than a network.
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "mock_exchange.hpp"
+#include "order_gateway.hpp"
+#include "upbit_rest.hpp"
+#include "ws_decoder.hpp"
+
+namespace {
+
+// The limit buy both order benches post.
+OrderRequest btc_bid() {
+    OrderRequest req;
+    req.market = "KRW-BTC";
+    req.side = "buy";
+    req.ord_type = "limit";
+    req.price = 10'000'000.0;
+    req.volume = 0.001;
+    return req;
+}
+
+// Blocking WebSocket client: just enough to subscribe and read server frames.
+class WsClient {
+public:
+    ~WsClient() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool connect(int port, const std::string& subscription) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        const std::string upgrade = "GET /websocket/v1 HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\n"
+                                    "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                    "Sec-WebSocket-Version: 13\r\n\r\n";
+        if (!write_all(upgrade.data(), upgrade.size())) return false;
+        size_t end;
+        while ((end = buf_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        if (buf_.compare(0, 12, "HTTP/1.1 101") != 0) return false;
+        buf_.erase(0, end + 4);
+
+        // client frames are masked; a zero mask keeps the payload as is
+        std::string frame;
+        frame += static_cast<char>(0x81);
+        if (subscription.size() < 126) {
+            frame += static_cast<char>(0x80 | subscription.size());
+        } else {
+            frame += static_cast<char>(0x80 | 126);
+            frame += static_cast<char>(subscription.size() >> 8);
+            frame += static_cast<char>(subscription.size() & 0xff);
+        }
+        frame.append(4, '\0');
+        frame += subscription;
+        return write_all(frame.data(), frame.size());
+    }
+
+    // Next server frame's payload (server frames are unmasked and unfragmented).
+    bool next(std::string_view& payload) {
+        buf_.erase(0, consumed_);
+        consumed_ = 0;
+        while (true) {
+            if (buf_.size() >= 2) {
+                const auto* b = reinterpret_cast<const unsigned char*>(buf_.data());
+                size_t len = b[1] & 0x7f;
+                size_t pos = 2;
+                if (len == 126 && buf_.size() >= 4) {
+                    len = (static_cast<size_t>(b[2]) << 8) | b[3];
+                    pos = 4;
+                } else if (len == 127 && buf_.size() >= 10) {
+                    len = 0;
+                    for (int i = 0; i < 8; ++i) len = (len << 8) | b[2 + i];
+                    pos = 10;
+                }
+                if ((b[1] & 0x7f) < 126 || pos > 2) {
+                    if (buf_.size() >= pos + len) {
+                        payload = std::string_view(buf_.data() + pos, len);
+                        consumed_ = pos + len;
+                        return true;
+                    }
+                }
+            }
+            if (!fill()) return false;
+        }
+    }
+
+private:
+    bool write_all(const char* p, size_t n) {
+        while (n > 0) {
+            const ssize_t k = ::send(fd_, p, n, MSG_NOSIGNAL);
+            if (k <= 0) return false;
+            p += k;
+            n -= static_cast<size_t>(k);
+        }
+        return true;
+    }
+
+    bool fill() {
+        char tmp[64 * 1024];
+        const ssize_t k = ::recv(fd_, tmp, sizeof(tmp), 0);
+        if (k <= 0) return false;
+        buf_.append(tmp, static_cast<size_t>(k));
+        return true;
+    }
+
+    int fd_{-1};
+    std::string buf_;
+    size_t consumed_{0};
+};
+
+// Resting bid far under the market, then its cancel: two signed requests per iteration.
+void BM_MockOrderRoundTrip(benchmark::State& state) {
+    MockExchangeConfig config;
+    config.market_per_sec = config.candles_per_sec = config.order_per_sec = config.default_per_sec = 0;
+    config.latency_us = state.range(0);
+    config.history_ms = 60LL * 60 * 1000;
+    MockUpbitServer server(config);
+    server.add_market("KRW-BTC");
+    std::string error;
+    if (!server.start(&error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+
+    UpbitRestClient client(server.rest_url());
+    client.set_credentials("mock-access", "mock-secret");
+    client.rate_limiter().configure(RateGroup::Order, 1e6);
+    const OrderRequest req = btc_bid();
+    for (auto _ : state) {
+        const OrderResult placed = client.post_order(req);
+        if (!placed.accepted) {
+            state.SkipWithError(("post_order: " + placed.error_message).c_str());
+            break;
+        }
+        const OrderResult cancelled = client.cancel_order(CancelRequest{placed.uuid});
+        if (!cancelled.accepted) {
+            state.SkipWithError(("cancel_order: " + cancelled.error_message).c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_MockOrderRoundTrip)->Arg(0)->Arg(500)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// A burst of 16 resting bids through the gateway with range(1) of them on
+// the wire at once; one iteration is the whole burst answered.
+void BM_MockGatewayBurst(benchmark::State& state) {
+    constexpr int kBurst = 16;
+    MockExchangeConfig config;
+    config.market_per_sec = config.candles_per_sec = config.order_per_sec = config.default_per_sec = 0;
+    config.latency_us = state.range(0);
+    config.history_ms = 60LL * 60 * 1000;
+    MockUpbitServer server(config);
+    server.add_market("KRW-BTC");
+    std::string error;
+    if (!server.start(&error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+
+    UpbitRestClient client(server.rest_url());
+    client.set_credentials("mock-access", "mock-secret");
+    client.rate_limiter().configure(RateGroup::Order, 1e6);
+    OrderGatewayConfig gateway_config;
+    gateway_config.max_in_flight[static_cast<size_t>(RateGroup::Order)] = static_cast<int>(state.range(1));
+    OrderGateway gateway(client, gateway_config);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    int answered = 0, accepted = 0;
+    const auto on_report = [&](const GatewayReport& r) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++answered;
+        accepted += r.result.accepted;
+        cv.notify_one();
+    };
+    const OrderRequest req = btc_bid();
+    for (auto _ : state) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            answered = accepted = 0;
+        }
+        for (int i = 0; i < kBurst; ++i) gateway.post(req, on_report);
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return answered == kBurst; });
+        if (accepted != kBurst) {
+            state.SkipWithError("order refused");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kBurst);
+    const GatewayStats s = gateway.stats();
+    state.counters["ack_p50_us"] = s.ack.p50_us;
+    state.counters["ack_p99_us"] = s.ack.p99_us;
+}
+BENCHMARK(BM_MockGatewayBurst)
+    ->ArgNames({"latency_us", "in_flight"})
+    ->Args({500, 1})
+    ->Args({500, 4})
+    ->Args({500, 8})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Trade and orderbook frames for every market, replayed as fast as the
+// client reads; one iteration is one decoded frame.
+void BM_MockMarketDataThroughput(benchmark::State& state) {
+    const bool simple = state.range(0) != 0;
+    MockExchangeConfig config;
+    config.feed_speed = 0.0;
+    config.history_ms = 0;
+    MockUpbitServer server(config);
+    std::string codes;
+    for (const char* m : {"KRW-BTC", "KRW-ETH", "KRW-XRP", "KRW-SOL"}) {
+        server.add_market(m);
+        codes += std::string(codes.empty() ? "" : ",") + '"' + m + '"';
+    }
+    std::string error;
+    if (!server.start(&error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    const std::string subscription = R"([{"ticket":"bench"},{"type":"trade","codes":[)" + codes +
+                                     R"(]},{"type":"orderbook","codes":[)" + codes + R"(]},{"format":")" +
+                                     (simple ? "SIMPLE" : "DEFAULT") + "\"}]";
+    WsClient ws;
+    if (!ws.connect(server.port(), subscription)) {
+        state.SkipWithError("websocket connect failed");
+        return;
+    }
+
+    const WsFormat format = simple ? WsFormat::Simple : WsFormat::Default;
+    TradeTick trade;
+    OrderbookSnapshot book;
+    std::string_view payload;
+    long long bytes = 0, trades = 0;
+    for (auto _ : state) {
+        if (!ws.next(payload)) {
+            state.SkipWithError("websocket closed");
+            break;
+        }
+        const WsMessageType type = WsFrameDecoder::decode(payload, trade, book, format);
+        if (type == WsMessageType::Invalid) {
+            state.SkipWithError("undecodable frame");
+            break;
+        }
+        trades += type == WsMessageType::Trade;
+        bytes += static_cast<long long>(payload.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+    state.counters["trades"] = benchmark::Counter(static_cast<double>(trades), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MockMarketDataThroughput)->ArgName("simple")->Arg(0)->Arg(1)->UseRealTime();
+
+} // namespace
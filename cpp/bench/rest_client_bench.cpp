@@ -0,0 +1,52 @@
+// Per-order work in UpbitRestClient before anything reaches the wire: tick
+// and volume normalisation, and signing the order's parameters.
+#include <benchmark/benchmark.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench_util.hpp"
+#include "upbit_rest.hpp"
+
+namespace {
+
+// One price per KRW tick tier, from sub-1 won coins up to BTC.
+const double kPrices[] = {0.41234, 7.8912, 56.789, 432.1, 4'321.7, 23'456.3, 78'912.4,
+                          345'678.9, 789'123.4, 1'234'567.0, 51'234'567.0};
+constexpr size_t kPriceCount = sizeof(kPrices) / sizeof(kPrices[0]);
+
+} // namespace
+
+static void BM_NormalizePrice(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(UpbitRestClient::normalize_price(kPrices[i]));
+        if (++i == kPriceCount) i = 0;
+    }
+}
+BENCHMARK(BM_NormalizePrice);
+
+static void BM_NormalizeVolume(benchmark::State& state) {
+    const bool is_buy = state.range(0) != 0;
+    size_t i = 0;
+    for (auto _ : state) {
+        const double price = kPrices[i];
+        benchmark::DoNotOptimize(UpbitRestClient::normalize_volume(price, 10'000.0 / price, is_buy));
+        if (++i == kPriceCount) i = 0;
+    }
+}
+BENCHMARK(BM_NormalizeVolume)->ArgName("buy")->Arg(0)->Arg(1);
+
+// The token post_order attaches: query string, SHA-512 query hash, HS256 JWT.
+static void BM_BuildAuthorizationToken(benchmark::State& state) {
+    UpbitRestClient client("http://127.0.0.1:1");
+    client.set_credentials("bench-access-key-0123456789abcdef", "bench-secret-key-0123456789abcdef0123456789");
+    std::vector<std::pair<std::string, std::string>> params;
+    if (state.range(0) != 0) {
+        params = {{"market", "KRW-BTC"}, {"side", "bid"}, {"ord_type", "limit"}, {"price", "51234000"},
+                  {"volume", "0.00019518"}, {"identifier", "us-1700000000000-42"}};
+    }
+    const long long before = bench_alloc_count();
+    for (auto _ : state) benchmark::DoNotOptimize(client.build_authorization_token(params));
+    report_allocs(state, before, "allocs/token");
+}
+BENCHMARK(BM_BuildAuthorizationToken)->ArgName("order")->Arg(0)->Arg(1);
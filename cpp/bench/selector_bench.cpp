@@ -0,0 +1,86 @@
+// Market selection over the whole KRW board: one score (24h turnover x 1m
+// realised volatility) per market, then the best one or the best n.
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "market_selector.hpp"
+
+namespace {
+
+struct Board {
+    std::vector<Ticker24h> tickers;
+    std::vector<std::pair<std::string, std::vector<Candle>>> candles_1m;
+};
+
+// `markets` markets with 60 one-minute candles each, as Engine fetches them.
+Board make_board(size_t markets, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::lognormal_distribution<double> turnover(23.0, 1.5);
+    std::normal_distribution<double> step(0.0, 0.001);
+    Board b;
+    for (size_t m = 0; m < markets; ++m) {
+        const std::string code = "KRW-C" + std::to_string(m);
+        b.tickers.push_back(Ticker24h{code, turnover(rng)});
+        std::vector<Candle> candles(60);
+        double px = 1'000.0 * static_cast<double>(m + 1);
+        for (size_t i = 0; i < candles.size(); ++i) {
+            px *= std::exp(step(rng));
+            candles[i].ts_ms = static_cast<long long>(i) * 60'000;
+            candles[i].open = candles[i].high = candles[i].low = candles[i].close = px;
+            candles[i].volume = 1.0;
+        }
+        b.candles_1m.emplace_back(code, std::move(candles));
+    }
+    // the candle batch arrives in a different order than the ticker list
+    std::shuffle(b.candles_1m.begin(), b.candles_1m.end(), rng);
+    return b;
+}
+
+} // namespace
+
+static void BM_SelectTopMarket(benchmark::State& state) {
+    const Board board = make_board(static_cast<size_t>(state.range(0)), 3);
+    MarketSelector selector;
+    for (auto _ : state) benchmark::DoNotOptimize(selector.select_top_market(board.tickers, board.candles_1m));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SelectTopMarket)->ArgName("markets")->Arg(50)->Arg(200)->Arg(400)->Unit(benchmark::kMicrosecond);
+
+static void BM_SelectTopMarkets(benchmark::State& state) {
+    const Board board = make_board(static_cast<size_t>(state.range(0)), 3);
+    MarketSelector selector;
+    for (auto _ : state) benchmark::DoNotOptimize(selector.select_top_markets(board.tickers, board.candles_1m, 10));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SelectTopMarkets)->ArgName("markets")->Arg(200)->Unit(benchmark::kMicrosecond);
+
+// The incremental ranker over the same board: a full re-rank, and one trade.
+static void BM_MarketRankerTop(benchmark::State& state) {
+    const Board board = make_board(static_cast<size_t>(state.range(0)), 3);
+    MarketRanker ranker;
+    for (const auto& t : board.tickers) ranker.set_turnover(t.market, t.acc_trade_price_24h);
+    for (const auto& [market, candles] : board.candles_1m) ranker.seed(market, candles);
+    for (auto _ : state) benchmark::DoNotOptimize(ranker.top(10));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MarketRankerTop)->ArgName("markets")->Arg(200)->Arg(400)->Unit(benchmark::kMicrosecond);
+
+static void BM_MarketRankerTrade(benchmark::State& state) {
+    const Board board = make_board(400, 3);
+    MarketRanker ranker;
+    for (const auto& [market, candles] : board.candles_1m) ranker.seed(market, candles);
+    long long ts = 60 * 60'000;
+    size_t i = 0;
+    for (auto _ : state) {
+        // every market trades once a second, so a minute closes every 60th trade per market
+        const auto& market = board.candles_1m[i % board.candles_1m.size()].first;
+        if (++i % board.candles_1m.size() == 0) ts += 1'000;
+        ranker.on_trade(market, ts, 1'000.0 + static_cast<double>(i % 7));
+    }
+    benchmark::DoNotOptimize(ranker.size());
+}
+BENCHMARK(BM_MarketRankerTrade);
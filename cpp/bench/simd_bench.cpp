@@ -0,0 +1,109 @@
+// Multi-market scans over row (Candle) and column (CandleColumns) layouts.
+// The column benchmarks take the ISA as their argument: 0 scalar, 1 SSE2,
+// 2 AVX2 (tests/simd_kernels_test.cpp checks they agree).
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "candle_columns.hpp"
+#include "indicators.hpp"
+#include "simd_kernels.hpp"
+
+namespace {
+
+constexpr size_t kMarkets = 300;
+constexpr size_t kBars = 1440; // a day of 1m candles
+
+std::vector<std::vector<Candle>> make_markets(size_t markets, size_t bars, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.003);
+    std::uniform_real_distribution<double> wick(0.0, 0.002);
+    std::bernoulli_distribution jump(0.002);
+    std::vector<std::vector<Candle>> out(markets);
+    for (auto& series : out) {
+        double px = 100.0 + 1e6 * std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        series.reserve(bars);
+        for (size_t i = 0; i < bars; ++i) {
+            Candle c{};
+            c.ts_ms = static_cast<long long>(i) * 60'000;
+            c.open = px;
+            px *= std::exp(step(rng));
+            if (jump(rng)) px *= 0.5 + std::uniform_real_distribution<double>(0.0, 1.5)(rng);
+            c.close = px;
+            c.high = std::max(c.open, c.close) * (1.0 + wick(rng));
+            c.low = std::min(c.open, c.close) * (1.0 - wick(rng));
+            c.volume = 1.0 + wick(rng);
+            series.push_back(c);
+        }
+    }
+    return out;
+}
+
+std::vector<CandleColumns> to_columns(const std::vector<std::vector<Candle>>& markets) {
+    std::vector<CandleColumns> out(markets.size());
+    for (size_t i = 0; i < markets.size(); ++i) out[i].assign(markets[i]);
+    return out;
+}
+
+bool select_isa(benchmark::State& state) {
+    const auto isa = static_cast<SimdIsa>(state.range(0));
+    if (simd_set_isa(isa) != isa) {
+        state.SkipWithError("ISA not supported on this CPU");
+        return false;
+    }
+    state.SetLabel(simd_isa_name(isa));
+    return true;
+}
+
+} // namespace
+
+// Realized vol of every market over its whole history.
+static void BM_RealizedVolScanRows(benchmark::State& state) {
+    const auto markets = make_markets(kMarkets, kBars, 5);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (const auto& m : markets) acc += batch_realized_vol(m, kBars);
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMarkets * kBars));
+}
+BENCHMARK(BM_RealizedVolScanRows)->Unit(benchmark::kMicrosecond);
+
+static void BM_RealizedVolScanColumns(benchmark::State& state) {
+    const auto columns = to_columns(make_markets(kMarkets, kBars, 5));
+    if (!select_isa(state)) return;
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (const auto& c : columns) acc += columns_realized_vol(c, kBars);
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMarkets * kBars));
+    simd_set_isa(simd_best_isa());
+}
+BENCHMARK(BM_RealizedVolScanColumns)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+// ATR and the full-history high of every market.
+static void BM_RangeScanRows(benchmark::State& state) {
+    const auto markets = make_markets(kMarkets, kBars, 9);
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (const auto& m : markets) acc += batch_sma_atr(m, kBars - 1) + batch_highest_high(m, 0, kBars);
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMarkets * kBars));
+}
+BENCHMARK(BM_RangeScanRows)->Unit(benchmark::kMicrosecond);
+
+static void BM_RangeScanColumns(benchmark::State& state) {
+    const auto columns = to_columns(make_markets(kMarkets, kBars, 9));
+    if (!select_isa(state)) return;
+    for (auto _ : state) {
+        double acc = 0.0;
+        for (const auto& c : columns) acc += columns_sma_atr(c, kBars - 1) + columns_highest_high(c, 0, kBars);
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kMarkets * kBars));
+    simd_set_isa(simd_best_isa());
+}
+BENCHMARK(BM_RangeScanColumns)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
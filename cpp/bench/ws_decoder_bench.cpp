@@ -0,0 +1,136 @@
+// Parse cost per frame and throughput for the DEFAULT and SIMPLE stream formats.
+// Frame sizes are reported too, since SIMPLE mainly saves bytes on the wire.
+// BM_DecodeSession replays a recorded stream (UPBIT_BENCH_WS_FRAMES: one
+// frame per line, either format) or, without one, a synthetic session.
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "order_tracker.hpp"
+#include "ws_decoder.hpp"
+
+namespace {
+
+std::string trade_frame(WsFormat f) {
+    if (f == WsFormat::Simple) {
+        return R"({"ty":"trade","cd":"KRW-BTC","tms":1700000000123,"td":"2023-11-14","ttm":"22:13:20",)"
+               R"("ttms":1700000000100,"tp":51234000.0,"tv":0.01234567,"ab":"BID","pcp":51000000.0,)"
+               R"("c":"RISE","cp":234000.0,"sid":17000000001230000,"st":"REALTIME"})";
+    }
+    return R"({"type":"trade","code":"KRW-BTC","timestamp":1700000000123,"trade_date":"2023-11-14",)"
+           R"("trade_time":"22:13:20","trade_timestamp":1700000000100,"trade_price":51234000.0,)"
+           R"("trade_volume":0.01234567,"ask_bid":"BID","prev_closing_price":51000000.0,"change":"RISE",)"
+           R"("change_price":234000.0,"sequential_id":17000000001230000,"stream_type":"REALTIME"})";
+}
+
+std::string orderbook_frame(WsFormat f, int levels) {
+    const bool simple = f == WsFormat::Simple;
+    std::string s = simple
+        ? R"({"ty":"orderbook","cd":"KRW-BTC","tms":1700000000999,"tas":12.3456,"tbs":30.5,"obu":[)"
+        : R"({"type":"orderbook","code":"KRW-BTC","timestamp":1700000000999,"total_ask_size":12.3456,"total_bid_size":30.5,"orderbook_units":[)";
+    for (int i = 0; i < levels; ++i) {
+        if (i > 0) s += ',';
+        const std::string ap = std::to_string(51234000 + 1000 * i) + ".0";
+        const std::string bp = std::to_string(51233000 - 1000 * i) + ".0";
+        s += simple ? R"({"ap":)" + ap + R"(,"bp":)" + bp + R"(,"as":0.1234,"bs":0.5678})"
+                    : R"({"ask_price":)" + ap + R"(,"bid_price":)" + bp + R"(,"ask_size":0.1234,"bid_size":0.5678})";
+    }
+    s += simple ? R"(],"st":"REALTIME","lv":0})" : R"(],"stream_type":"REALTIME","level":0})";
+    return s;
+}
+
+void run_decode(benchmark::State& state, const std::string& frame, WsFormat format) {
+    TradeTick trade;
+    OrderbookSnapshot book;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(WsFrameDecoder::decode(frame, trade, book, format));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(frame.size()));
+    state.counters["frame_bytes"] = static_cast<double>(frame.size());
+}
+
+struct Session {
+    std::vector<std::string> frames;
+    WsFormat format{WsFormat::Default};
+};
+
+// Four trades to one 15-level book update over 20 markets, roughly what the
+// combined subscription delivers.
+Session synthetic_session(size_t n) {
+    std::mt19937_64 rng(9);
+    Session s;
+    const std::string trade = trade_frame(WsFormat::Default);
+    const std::string book = orderbook_frame(WsFormat::Default, 15);
+    for (size_t i = 0; i < n; ++i) {
+        std::string f = i % 5 == 4 ? book : trade;
+        const std::string code = "KRW-C" + std::to_string(rng() % 20);
+        f.replace(f.find("KRW-BTC"), 7, code);
+        s.frames.push_back(std::move(f));
+    }
+    return s;
+}
+
+Session load_session() {
+    Session s;
+    if (const char* path = std::getenv("UPBIT_BENCH_WS_FRAMES"); path && *path) {
+        std::ifstream in(path);
+        for (std::string line; std::getline(in, line);) {
+            if (!line.empty()) s.frames.push_back(std::move(line));
+        }
+        if (!s.frames.empty() && s.frames.front().find("\"ty\"") != std::string::npos) s.format = WsFormat::Simple;
+    }
+    if (s.frames.empty()) s = synthetic_session(1000);
+    return s;
+}
+
+} // namespace
+
+static void BM_DecodeTrade(benchmark::State& state) {
+    const auto format = static_cast<WsFormat>(state.range(0));
+    run_decode(state, trade_frame(format), format);
+}
+BENCHMARK(BM_DecodeTrade)->ArgName("simple")->Arg(0)->Arg(1);
+
+static void BM_DecodeOrderbook15(benchmark::State& state) {
+    const auto format = static_cast<WsFormat>(state.range(0));
+    run_decode(state, orderbook_frame(format, 15), format);
+}
+BENCHMARK(BM_DecodeOrderbook15)->ArgName("simple")->Arg(0)->Arg(1);
+
+static void BM_DecodeSession(benchmark::State& state) {
+    const Session session = load_session();
+    TradeTick trade;
+    OrderbookSnapshot book;
+    size_t i = 0;
+    long long bytes = 0;
+    for (auto _ : state) {
+        const std::string& frame = session.frames[i];
+        benchmark::DoNotOptimize(WsFrameDecoder::decode(frame, trade, book, session.format));
+        bytes += static_cast<long long>(frame.size());
+        if (++i == session.frames.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+    state.counters["frames"] = static_cast<double>(session.frames.size());
+}
+BENCHMARK(BM_DecodeSession);
+
+// A private-socket fill report into the order tracker's event form.
+static void BM_ParseOrderEvent(benchmark::State& state) {
+    const std::string frame =
+        R"({"type":"myOrder","code":"KRW-BTC","uuid":"ac2dc2a3-fce9-40a2-a4f6-5987c25c438f","ask_bid":"BID",)"
+        R"("order_type":"limit","state":"trade","trade_uuid":"68315169-fba4-4175-ade3-aff14a616657",)"
+        R"("price":51234000.0,"avg_price":51234000.0,"volume":0.0002,"remaining_volume":0.0001,)"
+        R"("executed_volume":0.0001,"trades_count":1,"reserved_fee":5.1234,"remaining_fee":2.5617,)"
+        R"("paid_fee":2.5617,"locked":5128.5,"executed_funds":5123.4,"trade_price":51234000.0,)"
+        R"("trade_volume":0.0001,"trade_fee":2.5617,"trade_timestamp":1700000000100,)"
+        R"("order_timestamp":1700000000000,"timestamp":1700000000123,"identifier":"us-1700000000000-42",)"
+        R"("stream_type":"REALTIME"})";
+    OrderEvent event;
+    for (auto _ : state) benchmark::DoNotOptimize(parse_order_event(frame, event));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(frame.size()));
+}
+BENCHMARK(BM_ParseOrderEvent);
@@ -0,0 +1,63 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "http_pool.hpp"
+#include "rate_limiter.hpp"
+
+// curl-multi driven request engine. One worker thread multiplexes every
+// in-flight request (HTTP/2 streams where the server allows it). Requests
+// start only when the rate limiter grants their group a token, High-lane
+// requests first. Callbacks run on the worker thread.
+class AsyncHttpClient {
+public:
+    using Callback = std::function<void(HttpResponse)>;
+
+    AsyncHttpClient(HttpConnectionPool& pool, RateLimiter& limiter, int max_in_flight = 8);
+    ~AsyncHttpClient();
+
+    AsyncHttpClient(const AsyncHttpClient&) = delete;
+    AsyncHttpClient& operator=(const AsyncHttpClient&) = delete;
+
+    std::future<HttpResponse> submit(HttpRequest req);
+    void submit(HttpRequest req, Callback cb);
+
+private:
+    struct Job {
+        HttpRequest req;
+        Callback cb;
+        int attempts{0};
+    };
+
+    struct Transfer {
+        Job job;
+        CURL* curl{nullptr};
+        curl_slist* headers{nullptr};
+        HttpResponse response;
+    };
+
+    void run();
+    // Starts whatever the limiter allows; returns ms until the next blocked job may start.
+    long start_ready();
+    void finish(CURL* curl, CURLcode rc);
+    void requeue(Job job);
+
+    HttpConnectionPool& pool_;
+    RateLimiter& limiter_;
+    CURLM* multi_{nullptr};
+    int max_in_flight_;
+
+    std::mutex mutex_;
+    std::deque<Job> high_;
+    std::deque<Job> low_;
+    bool stop_{false};
+
+    // worker-thread state
+    std::unordered_map<CURL*, std::unique_ptr<Transfer>> active_;
+
+    std::thread worker_;
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "candle_series.hpp"
+#include "market_archive.hpp"
+#include "order_venue.hpp"
+#include "strategy_5m_scalper.hpp"
+#include "types.hpp"
+#include "upbit_rest.hpp"
+
+// How SimulatedExchange fills orders against a recorded tape. There is no
+// book in the recording, so an order is matched against the prints alone:
+// it reaches the matcher `latency_ms` of tape time after submission, a limit
+// that crosses the print it arrives on fills there in full, and after that
+// it rests until a print trades through its price.
+struct FillModel {
+    long long latency_ms{50};
+    // Prints at exactly the limit price also fill, up to their volume. Off
+    // by default: the queue ahead of us at that level is unknown.
+    bool fill_on_touch{false};
+    double fee_rate{UpbitRestClient::taker_fee_rate()}; // charged on every fill, maker or taker
+};
+
+struct SimFill {
+    std::uint64_t order_id{};
+    bool is_buy{};
+    double price{};
+    double volume{};
+    double fee{};
+    long long ts_ms{};
+    double remaining{}; // left on the order after this fill
+};
+
+// Single-market matcher for replays. Deterministic: the only clock is the
+// timestamp of the last print passed to on_trade().
+class SimulatedExchange : public OrderVenue {
+public:
+    explicit SimulatedExchange(FillModel model = {});
+
+    void reset();
+    const FillModel& model() const { return model_; }
+    void set_model(const FillModel& model) { model_ = model; }
+
+    // uuid is "sim-<id>"; limit orders need a price and volume, "price"
+    // (market buy) a KRW amount and "market" (market sell) a volume.
+    OrderResult post_order(const OrderRequest& req) override;
+    OrderResult cancel_order(const CancelRequest& req) override;
+
+    // Matches the live orders against one print, appending their fills.
+    void on_trade(const TradeRecord& t, std::vector<SimFill>& fills);
+
+    bool is_open(std::uint64_t order_id) const;
+    size_t open_orders() const { return orders_.size(); }
+    std::uint64_t last_order_id() const { return next_id_ - 1; }
+    // KRW notional of every accepted order, at its limit (or reference) price.
+    double submitted_krw() const { return submitted_krw_; }
+
+private:
+    enum class Kind { Limit, MarketBuy, MarketSell };
+    struct Working {
+        std::uint64_t id;
+        Kind kind;
+        bool is_buy;
+        double price;     // limit price
+        double remaining; // volume, or KRW for a market buy
+        long long live_ms;
+        bool arrived;
+    };
+
+    void fill(Working& o, const TradeRecord& t, double price, double volume, std::vector<SimFill>& fills);
+
+    FillModel model_;
+    std::vector<Working> orders_;
+    std::uint64_t next_id_{1};
+    long long now_ms_{0};
+    double last_price_{0.0};
+    double submitted_krw_{0.0};
+};
+
+struct BacktestConfig {
+    ScalperParams scalper;
+    double initial_krw{1'000'000.0};
+    double max_order_krw{100'000.0};
+    double risk_per_trade{0.01};                     // of equity, per ATR of adverse move
+    double take_profit_atr{1.5};                     // resting sell at entry + k * ATR
+    double stop_loss_atr{1.0};                       // market sell once a print is k * ATR under entry
+    long long max_hold_ms{30LL * 60 * 1000};         // market sell after this long in a position
+    long long entry_ttl_ms{60'000};                  // unfilled entries are cancelled after this
+    double daily_stop_ratio{0.03};                   // no new entries for the rest of the UTC day
+    FillModel fill;
+};
+
+struct BacktestReport {
+    std::string market;
+    size_t prints{};
+    long long first_ts_ms{};
+    long long last_ts_ms{};
+
+    size_t orders{};
+    size_t orders_filled{};    // at least partly
+    size_t orders_cancelled{};
+    double volume_ordered{};   // KRW notional at the order price
+    double volume_filled{};
+    size_t round_trips{};
+    size_t wins{};
+
+    double gross_pnl{};
+    double fees{};
+    double net_pnl{};
+    double final_equity{};
+    double max_drawdown{};     // fraction of the running equity peak
+
+    // Signed per-fill slippage against the price the order was decided at,
+    // in basis points; positive is worse for us.
+    double slippage_mean_bps{};
+    double slippage_p50_bps{};
+    double slippage_p95_bps{};
+
+    double fill_rate() const { return orders ? static_cast<double>(orders_filled) / static_cast<double>(orders) : 0.0; }
+    double volume_fill_rate() const { return volume_ordered > 0.0 ? volume_filled / volume_ordered : 0.0; }
+};
+
+struct MarketState;
+
+// Replays one market's tape through MarketState, Strategy5mScalper's
+// streaming signal, RiskManager and OrderManager, with SimulatedExchange
+// standing in for the exchange. The tape is only read, so many runs can
+// share one mapping; a Backtester keeps its exchange, market state and
+// buffers from run to run, so a run only allocates when the scalper
+// parameters change (the signal's windows are resized) or a buffer grows.
+class Backtester {
+public:
+    explicit Backtester(BacktestConfig config = {});
+    ~Backtester();
+
+    const BacktestConfig& config() const { return config_; }
+    void set_config(const BacktestConfig& config) { config_ = config; }
+
+    // `warmup_5m` are 5m bars before the first print (may be empty).
+    BacktestReport run(const std::string& market, CandleSpan warmup_5m, const TradeRecord* trades, size_t n);
+
+private:
+    BacktestConfig config_;
+    SimulatedExchange exchange_;
+    std::unique_ptr<MarketState> state_;
+    ScalperParams signal_params_; // what state_.signal was built with
+    std::vector<SimFill> fills_;
+    std::vector<double> slippage_;
+};
+
+// The archived tape of one market opened read-only, plus the 5m bars before
+// its first print; safe while a live engine is appending to the archive.
+struct ReplayData {
+    TradeLog trades;
+    CandleLog candles_5m;
+    size_t begin{}; // print range to replay
+    size_t end{};
+    CandleSpan warmup;
+};
+
+// Markets under an archive root that have a trade log, sorted.
+std::vector<std::string> replay_markets(const std::string& root);
+
+bool open_replay(const MarketArchive& archive, const std::string& market, long long from_ms, long long to_ms,
+                 ReplayData& out, std::string* error = nullptr);
+
+// A seeded random-walk tape with trending and ranging stretches, one print
+// every ~2s: stands in for an archive when none is at hand.
+std::vector<TradeRecord> synthetic_tape(long long start_ms, int days, double start_price, unsigned seed);
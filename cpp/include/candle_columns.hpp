@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "candle_series.hpp"
+#include "types.hpp"
+
+// Structure-of-arrays candle store: one contiguous array per field, oldest
+// first, so a scan that needs only closes (or high/low/close) streams just
+// those and the simd_* kernels can load them a register at a time.
+struct CandleColumns {
+    std::vector<long long> ts_ms;
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> volume;
+
+    size_t size() const { return close.size(); }
+    bool empty() const { return close.empty(); }
+    void reserve(size_t n);
+    void clear();
+    void push_back(const Candle& c);
+    void assign(CandleSpan c);
+    Candle row(size_t i) const;
+};
+
+// Column forms of the batch indicators (indicators.hpp), same conventions,
+// computed with the dispatched SIMD kernels.
+double columns_sma_atr(const CandleColumns& c, size_t n); // 0 if fewer than n + 1 bars
+double columns_highest_high(const CandleColumns& c, size_t begin, size_t end);
+double columns_realized_vol(const CandleColumns& c, size_t n);
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "candle_series.hpp"
+#include "types.hpp"
+
+// A run of bars merged into one: bars [first, first + count) of a pyramid.
+struct CandleBucket {
+    size_t first{0};
+    size_t count{0};
+    Candle bar;
+};
+
+// Multi-resolution candle history for drawing long charts. Level 0 holds the
+// bars; each level above merges kFanout buckets of the one below (first open,
+// highest high, lowest low, last close, summed volume), so a chart zoomed out
+// to hundreds of bars per pixel still draws every wick extreme from a few
+// thousand pre-merged buckets.
+//
+// Buckets are aligned to a bar's position since the pyramid was last
+// assigned, so appending, rewriting the newest bar and dropping the oldest
+// only touch one bucket per level. Indices count from the oldest bar held.
+class CandlePyramid {
+public:
+    static constexpr size_t kFanoutBits = 2;
+    static constexpr size_t kFanout = size_t{1} << kFanoutBits;
+
+    CandlePyramid();
+
+    size_t size() const { return levels_[0].size(); }
+    bool empty() const { return levels_[0].empty(); }
+    size_t levels() const { return levels_.size(); }
+    const Candle& operator[](size_t i) const { return levels_[0][i]; }
+    const Candle& front() const { return levels_[0].front(); }
+    const Candle& back() const { return levels_[0].back(); }
+    // Bars per bucket at `level`.
+    static size_t span_of(size_t level) { return size_t{1} << (kFanoutBits * level); }
+
+    void assign(CandleSpan bars);
+    void push_back(const Candle& c);
+    // Rewrites the newest bar (the forming one).
+    void set_back(const Candle& c);
+    void pop_front(size_t n = 1);
+    void pop_back(size_t n = 1);
+    void clear();
+
+    // First bar with ts_ms >= ts_ms (size() if none).
+    size_t lower_bound(long long ts_ms) const;
+    // Bars [first, last) merged into one, from O(kFanout * levels) buckets.
+    Candle merged(size_t first, size_t last) const;
+    // Bars [first, last) as the buckets of `level` (the top one if higher);
+    // buckets cut by the range ends are merged exactly for the part inside.
+    void collect(size_t level, size_t first, size_t last, std::vector<CandleBucket>& out) const;
+
+private:
+    static void merge_into(Candle& into, const Candle& c);
+    Candle bucket_from_below(size_t level, size_t bucket) const;
+    void grow();
+
+    std::vector<std::deque<Candle>> levels_;
+    std::vector<size_t> first_bucket_; // bucket number of levels_[l].front()
+    size_t base_{0};                   // position of the oldest bar since assign()
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "types.hpp"
+
+// Read-only view over consecutive candles, oldest first. Cheap to pass by
+// value; valid until the owning container is next modified.
+class CandleSpan {
+public:
+    CandleSpan() = default;
+    CandleSpan(const Candle* data, size_t size) : data_(data), size_(size) {}
+    CandleSpan(const std::vector<Candle>& v) : data_(v.data()), size_(v.size()) {}
+
+    const Candle* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const Candle& operator[](size_t i) const { return data_[i]; }
+    const Candle& front() const { return data_[0]; }
+    const Candle& back() const { return data_[size_ - 1]; }
+    const Candle* begin() const { return data_; }
+    const Candle* end() const { return data_ + size_; }
+
+    // Last `n` candles (all of them if there are fewer).
+    CandleSpan last(size_t n) const {
+        n = std::min(n, size_);
+        return {data_ + (size_ - n), n};
+    }
+    std::vector<Candle> to_vector() const { return {begin(), end()}; }
+
+private:
+    const Candle* data_{nullptr};
+    size_t size_{0};
+};
+
+// Fixed-capacity candle history, oldest first. Appending to a full series
+// evicts the oldest bar in O(1). Every write lands in both halves of a
+// doubled ring, so the live window is always one contiguous run and view()
+// hands it out without copying.
+//
+// Bars also carry a sequence number that stays fixed while the bar is held:
+// bar i is sequence first_seq() + i, and sequences are never reused.
+template <size_t Capacity>
+class CandleSeries {
+    static_assert(Capacity > 0, "CandleSeries needs room for at least one bar");
+
+public:
+    static constexpr size_t kCapacity = Capacity;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    CandleSpan view() const { return {slots_.data() + head_, size_}; }
+    operator CandleSpan() const { return view(); }
+
+    const Candle& operator[](size_t i) const { return slots_[head_ + i]; }
+    const Candle& front() const { return slots_[head_]; }
+    const Candle& back() const { return slots_[head_ + size_ - 1]; }
+    const Candle* begin() const { return slots_.data() + head_; }
+    const Candle* end() const { return slots_.data() + head_ + size_; }
+
+    std::uint64_t first_seq() const { return next_seq_ - size_; }
+    std::uint64_t end_seq() const { return next_seq_; }
+    bool holds_seq(std::uint64_t seq) const { return seq >= first_seq() && seq < next_seq_; }
+    const Candle& at_seq(std::uint64_t seq) const { return (*this)[static_cast<size_t>(seq - first_seq())]; }
+
+    void push_back(const Candle& c) {
+        if (size_ == Capacity) {
+            head_ = head_ + 1 == Capacity ? 0 : head_ + 1;
+            --size_;
+        }
+        write(slot(size_), c);
+        ++size_;
+        ++next_seq_;
+    }
+
+    // Overwrites the newest bar (the forming one) in place.
+    void set_back(const Candle& c) { write(slot(size_ - 1), c); }
+    void set(size_t i, const Candle& c) { write(slot(i), c); }
+
+    // Replaces the contents with the last Capacity candles of `c` (which may
+    // be this series' own view).
+    void assign(CandleSpan c) {
+        c = c.last(Capacity);
+        // our own slots start at or after slots_[0], so a forward copy is
+        // safe unless the span is already in place
+        if (c.begin() != slots_.data()) std::copy(c.begin(), c.end(), slots_.begin());
+        std::copy(slots_.begin(), slots_.begin() + c.size(), slots_.begin() + Capacity);
+        head_ = 0;
+        size_ = c.size();
+        next_seq_ += c.size();
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    size_t slot(size_t i) const {
+        const size_t s = head_ + i;
+        return s < Capacity ? s : s - Capacity;
+    }
+    void write(size_t s, const Candle& c) {
+        slots_[s] = c;
+        slots_[s + Capacity] = c;
+    }
+
+    std::array<Candle, 2 * Capacity> slots_{};
+    size_t head_{0}; // slot of the oldest bar, < Capacity
+    size_t size_{0};
+    std::uint64_t next_seq_{0};
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <string>
 #include "upbit_rest.hpp"
 #include "market_selector.hpp"
@@ -6,14 +7,23 @@
 #include "risk_manager.hpp"
 #include "order_manager.hpp"
 
+class MarketArchive;
+
 class Engine {
 public:
     Engine();
+    ~Engine();
     int run_once();
+    // Trades the best `top_n` markets at once, one shard-evaluated entry of
+    // `order_krw` each.
+    int run_once_multi(size_t top_n, double order_krw);
+    const UpbitRestClient& rest() const { return rest_; }
 private:
     UpbitRestClient rest_;
     MarketSelector selector_;
     Strategy5mScalper strategy_;
     RiskManager risk_;
+    OrderTracker orders_;
     OrderManager order_mgr_;
+    std::unique_ptr<MarketArchive> archive_; // UPBIT_ARCHIVE_DIR; candles are fetched through it when set
 };
@@ -0,0 +1,75 @@
+#pragma once
+#include <curl/curl.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "rate_limiter.hpp"
+
+struct HttpRequest {
+    std::string method{"GET"}; // GET/POST/DELETE/HEAD
+    std::string url;
+    std::string body;
+    std::vector<std::string> headers;
+    RateGroup group{RateGroup::Default};
+    RateLane lane{RateLane::Low};
+};
+
+struct HttpResponse {
+    int status{0};
+    std::string body;
+    std::string remaining_req; // raw Remaining-Req header, if any
+    std::string error_message;
+    bool connection_reused{false};
+};
+
+struct HttpPoolStats {
+    std::uint64_t requests{0};
+    std::uint64_t connections_reused{0};
+    std::uint64_t connections_opened{0};
+    std::uint64_t handles_created{0};
+};
+
+// Keeps TCP/TLS connections to the exchange alive between requests.
+// All easy handles share one CURLSH (DNS cache, TLS sessions), and finished
+// handles are recycled instead of being cleaned up so their connections stay open.
+class HttpConnectionPool {
+public:
+    explicit HttpConnectionPool(size_t max_idle_handles = 8);
+    ~HttpConnectionPool();
+
+    HttpConnectionPool(const HttpConnectionPool&) = delete;
+    HttpConnectionPool& operator=(const HttpConnectionPool&) = delete;
+
+    HttpResponse perform(const HttpRequest& req);
+    // Opens (or refreshes) a connection to the host so the first order does not pay the handshake.
+    bool warm_up(const std::string& url);
+
+    CURL* acquire();
+    void release(CURL* curl);
+    // Applies method, url, headers and shared-cache options to a leased handle.
+    // The returned header list must outlive the transfer and be freed by the caller.
+    curl_slist* prepare(CURL* curl, const HttpRequest& req, HttpResponse* out);
+    void record_transfer(CURL* curl, HttpResponse& out);
+
+    HttpPoolStats stats() const;
+
+    static void global_init();
+
+private:
+    static void lock_share(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlock_share(CURL* handle, curl_lock_data data, void* userptr);
+
+    CURLSH* share_{nullptr};
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+    std::mutex idle_mutex_;
+    std::vector<CURL*> idle_;
+    size_t max_idle_;
+
+    std::atomic<std::uint64_t> requests_{0};
+    std::atomic<std::uint64_t> reused_{0};
+    std::atomic<std::uint64_t> opened_{0};
+    std::atomic<std::uint64_t> created_{0};
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "candle_series.hpp"
+#include "types.hpp"
+
+// Streaming indicators. Every update is O(1) (amortised for the rolling
+// extremes) and allocation-free once constructed. The batch functions at the
+// bottom are the reference formulas the streaming forms reproduce.
+
+double true_range(const Candle& bar, double prev_close);
+
+// Mean of the last `period` values. The running sum is rebuilt from the
+// window once per period so it cannot drift.
+class RollingMean {
+public:
+    explicit RollingMean(size_t period);
+    void push(double v);
+    void reset();
+    bool ready() const { return count_ >= buf_.size(); }
+    double sum() const { return sum_; }
+    double value() const;
+
+private:
+    std::vector<double> buf_;
+    size_t next_{0};
+    size_t count_{0};
+    double sum_{0.0};
+};
+
+// Rolling max/min over the last `period` values with a monotonic deque kept
+// in a fixed ring.
+template <typename Better>
+class MonotonicWindow {
+public:
+    explicit MonotonicWindow(size_t period) : period_(period), ring_(period) {}
+
+    void push(double v) {
+        const long long seq = next_seq_++;
+        while (size_ > 0 && ring_[head_].first <= seq - static_cast<long long>(period_)) pop_front();
+        while (size_ > 0 && !Better()(back().second, v)) --size_;
+        ring_[(head_ + size_) % period_] = {seq, v};
+        ++size_;
+    }
+    void reset() {
+        head_ = 0;
+        size_ = 0;
+        next_seq_ = 0;
+    }
+    bool ready() const { return next_seq_ >= static_cast<long long>(period_); }
+    double value() const { return size_ > 0 ? ring_[head_].second : 0.0; }
+
+private:
+    const std::pair<long long, double>& back() const { return ring_[(head_ + size_ - 1) % period_]; }
+    void pop_front() {
+        head_ = (head_ + 1) % period_;
+        --size_;
+    }
+
+    size_t period_;
+    std::vector<std::pair<long long, double>> ring_; // (sequence, value)
+    size_t head_{0};
+    size_t size_{0};
+    long long next_seq_{0};
+};
+
+using RollingMax = MonotonicWindow<std::greater<double>>;
+using RollingMin = MonotonicWindow<std::less<double>>;
+
+// EMA with alpha = 2 / (period + 1), seeded with the first value.
+class Ema {
+public:
+    explicit Ema(size_t period);
+    void push(double v);
+    void reset();
+    bool ready() const { return count_ >= period_; }
+    double value() const { return value_; }
+
+private:
+    size_t period_;
+    double alpha_;
+    size_t count_{0};
+    double value_{0.0};
+};
+
+// ATR as the simple mean of the last `period` true ranges (what the
+// scalper has always used).
+class RollingAtr {
+public:
+    explicit RollingAtr(size_t period) : tr_(period) {}
+    void on_bar(const Candle& bar);
+    void reset();
+    bool ready() const { return tr_.ready(); }
+    double value() const { return tr_.value(); }
+
+private:
+    RollingMean tr_;
+    double prev_close_{0.0};
+    bool has_prev_{false};
+};
+
+// Wilder's ATR: seeded with the mean of the first `period` true ranges, then
+// atr = (atr * (period - 1) + tr) / period.
+class WilderAtr {
+public:
+    explicit WilderAtr(size_t period) : period_(period) {}
+    void on_bar(const Candle& bar);
+    void reset();
+    bool ready() const { return count_ >= period_; }
+    double value() const { return value_; }
+
+private:
+    size_t period_;
+    size_t count_{0};
+    double seed_sum_{0.0};
+    double value_{0.0};
+    double prev_close_{0.0};
+    bool has_prev_{false};
+};
+
+// Volume-weighted average price since the last reset (e.g. session start).
+class Vwap {
+public:
+    void push(double price, double volume);
+    void reset();
+    double value() const { return volume_ > 0.0 ? notional_ / volume_ : 0.0; }
+    double volume() const { return volume_; }
+
+private:
+    double notional_{0.0};
+    double volume_{0.0};
+};
+
+// Root-mean-square of the last `period` log returns.
+class RealizedVol {
+public:
+    explicit RealizedVol(size_t period) : sq_(period) {}
+    void push(double close);
+    void reset();
+    bool ready() const { return sq_.ready(); }
+    double value() const;
+
+private:
+    RollingMean sq_;
+    double prev_{0.0};
+};
+
+// Batch reference formulas over the tail of a series.
+double batch_sma_atr(CandleSpan c, size_t n); // 0 if fewer than n + 1 bars
+double batch_wilder_atr(CandleSpan c, size_t n);
+double batch_highest_high(CandleSpan c, size_t begin, size_t end);
+double batch_ema(const std::vector<double>& v, size_t n);
+double batch_vwap(const std::vector<std::pair<double, double>>& price_volume);
+double batch_realized_vol(CandleSpan c, size_t n);
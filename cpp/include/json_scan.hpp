@@ -0,0 +1,73 @@
+#pragma once
+#include <string_view>
+
+// Minimal forward-only JSON scanning over a borrowed buffer. Nothing is
+// allocated: keys and values are returned as views into the input.
+// Only what the Upbit payloads need is supported (no unicode unescaping).
+
+// Returns the position just past the value starting at pos, or npos if malformed.
+size_t json_skip_value(std::string_view s, size_t pos);
+
+// Calls fn(key, raw_value) for each top-level member of the object at s.
+// raw_value keeps surrounding quotes for strings. Stops early if fn returns false.
+template <typename Fn>
+bool json_for_each_member(std::string_view s, Fn&& fn);
+
+// Calls fn(raw_element) for each element of the array at s.
+template <typename Fn>
+bool json_for_each_element(std::string_view s, Fn&& fn);
+
+std::string_view json_unquote(std::string_view raw);
+// Accepts both bare numbers and quoted numbers ("123.4").
+bool json_to_double(std::string_view raw, double& out);
+bool json_to_int64(std::string_view raw, long long& out);
+
+inline size_t json_skip_ws(std::string_view s, size_t pos) {
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\n' || s[pos] == '\r' || s[pos] == '\t')) ++pos;
+    return pos;
+}
+
+template <typename Fn>
+bool json_for_each_member(std::string_view s, Fn&& fn) {
+    size_t pos = json_skip_ws(s, 0);
+    if (pos >= s.size() || s[pos] != '{') return false;
+    pos = json_skip_ws(s, pos + 1);
+    if (pos < s.size() && s[pos] == '}') return true;
+    while (pos < s.size()) {
+        if (s[pos] != '"') return false;
+        const size_t key_end = json_skip_value(s, pos);
+        if (key_end == std::string_view::npos) return false;
+        const std::string_view key = s.substr(pos + 1, key_end - pos - 2);
+        pos = json_skip_ws(s, key_end);
+        if (pos >= s.size() || s[pos] != ':') return false;
+        pos = json_skip_ws(s, pos + 1);
+        const size_t value_end = json_skip_value(s, pos);
+        if (value_end == std::string_view::npos) return false;
+        if (!fn(key, s.substr(pos, value_end - pos))) return true;
+        pos = json_skip_ws(s, value_end);
+        if (pos >= s.size()) return false;
+        if (s[pos] == '}') return true;
+        if (s[pos] != ',') return false;
+        pos = json_skip_ws(s, pos + 1);
+    }
+    return false;
+}
+
+template <typename Fn>
+bool json_for_each_element(std::string_view s, Fn&& fn) {
+    size_t pos = json_skip_ws(s, 0);
+    if (pos >= s.size() || s[pos] != '[') return false;
+    pos = json_skip_ws(s, pos + 1);
+    if (pos < s.size() && s[pos] == ']') return true;
+    while (pos < s.size()) {
+        const size_t value_end = json_skip_value(s, pos);
+        if (value_end == std::string_view::npos) return false;
+        if (!fn(s.substr(pos, value_end - pos))) return true;
+        pos = json_skip_ws(s, value_end);
+        if (pos >= s.size()) return false;
+        if (s[pos] == ']') return true;
+        if (s[pos] != ',') return false;
+        pos = json_skip_ws(s, pos + 1);
+    }
+    return false;
+}
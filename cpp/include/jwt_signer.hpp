@@ -0,0 +1,55 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct evp_mac_ctx_st;
+struct evp_md_ctx_st;
+struct evp_md_st;
+
+struct QueryParam {
+    std::string_view key;
+    std::string_view value;
+};
+
+// Upbit request signer. The HMAC-SHA256 context is keyed once with the
+// secret, the SHA-512 query-hash context is reused, the constant JWT header
+// is pre-encoded, and every token is assembled in fixed stack buffers.
+// What still allocates per token is inside OpenSSL's provider layer
+// (context re-init), plus the std::string result if that overload is used.
+class JwtSigner {
+public:
+    static constexpr size_t kMaxParams = 16;
+    static constexpr size_t kMaxQuery = 1024;
+    static constexpr size_t kMaxToken = 1024;
+
+    JwtSigner() = default;
+    ~JwtSigner();
+
+    JwtSigner(const JwtSigner&) = delete;
+    JwtSigner& operator=(const JwtSigner&) = delete;
+
+    void set_credentials(std::string_view access_key, std::string_view secret_key);
+    bool ready() const { return mac_ctx_ != nullptr && !access_key_.empty(); }
+
+    // Writes "Bearer <jwt>" into out and returns its length, or 0 on failure
+    // (no credentials, too many params, or output does not fit).
+    size_t sign(const QueryParam* params, size_t count, char* out, size_t cap) const;
+    std::string sign(const std::vector<std::pair<std::string, std::string>>& params) const;
+
+private:
+    void reset();
+
+    std::string access_key_;
+    evp_mac_ctx_st* mac_ctx_{nullptr}; // HMAC-SHA256, keyed with the secret
+    evp_md_st* sha512_{nullptr};
+    evp_md_ctx_st* sha512_ctx_{nullptr};
+    mutable std::mutex mutex_;
+};
+
+// Percent-encodes everything except RFC 3986 unreserved characters, like curl_easy_escape.
+// Returns false if the result does not fit in cap.
+bool url_encode_into(std::string_view value, char* out, size_t cap, size_t& written);
+std::string url_encode(std::string_view value);
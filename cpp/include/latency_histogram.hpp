@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct LatencySummary {
+    std::uint64_t count{0};
+    double p50_us{0.0};
+    double p90_us{0.0};
+    double p99_us{0.0};
+    double p999_us{0.0};
+    double max_us{0.0};
+};
+
+// Log-linear (HDR-style) histogram of nanosecond latencies: 64 linear
+// sub-buckets per power of two, so every percentile is within 1/64 of the
+// true value, from 1 ns up to ~68 s (longer samples count as ~68 s).
+// record() is a handful of instructions with no allocation or RMW; one
+// thread writes at a time, summary() may run on any thread.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 6;
+    static constexpr int kMaxBits = 36;
+    static constexpr size_t kBuckets = static_cast<size_t>(kMaxBits - kSubBits + 1) << kSubBits;
+
+    static size_t bucket_of(std::uint64_t ns);
+    // Midpoint and upper edge of bucket `i`, in ns.
+    static double bucket_mid(size_t i);
+    static double bucket_high(size_t i);
+    // Percentiles of a count vector of kBuckets entries (e.g. merged or the
+    // difference of two add_to() results).
+    static LatencySummary summarize(const std::vector<std::uint64_t>& counts);
+
+    void record(long long ns) {
+        const std::uint64_t v = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+        auto& c = counts_[bucket_of(v)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    // Adds this histogram's counts into `counts` (resized to kBuckets).
+    void add_to(std::vector<std::uint64_t>& counts) const;
+    LatencySummary summary() const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> counts_{};
+};
+
+// The tick-to-trade chain, stage by stage.
+enum class LatencyStage {
+    FrameDecode,  // public frame received -> decoded and queued (network thread)
+    QueueWait,    // queued -> picked up by the strategy thread
+    MarketUpdate, // candle and book update for one event
+    Decision,     // strategy evaluation of one market
+    OrderPrepare, // OrderManager: normalise and track, up to the venue call
+    OrderSend,    // REST client: build, sign, and (blocking calls) wait for a rate-limit token
+    RestAck,      // request handed to HTTP -> response
+    SendToFill,   // order sent -> its first fill on the private socket
+    TickToTrade,  // newest frame the decision saw -> order sent
+};
+constexpr size_t kLatencyStageCount = 9;
+
+const char* latency_stage_name(LatencyStage stage);
+
+// Process-wide stage histograms. Each thread records into its own set,
+// allocated on its first sample for a stage, so recording threads never
+// share a cache line; readers merge them. When a thread exits its counts
+// are folded into a retired total and its set is freed, so pool threads
+// that come and go still count without piling up sets.
+class LatencyRecorder {
+public:
+    static long long now_ns();
+    static void record(LatencyStage stage, long long ns);
+    // Adds every thread's counts for `stage` into `counts`.
+    static void add_to(LatencyStage stage, std::vector<std::uint64_t>& counts);
+    static LatencySummary summary(LatencyStage stage);
+};
+
+// Times its own scope into a stage.
+class LatencySpan {
+public:
+    explicit LatencySpan(LatencyStage stage) : stage_(stage), start_ns_(LatencyRecorder::now_ns()) {}
+    ~LatencySpan() { LatencyRecorder::record(stage_, LatencyRecorder::now_ns() - start_ns_); }
+
+    LatencySpan(const LatencySpan&) = delete;
+    LatencySpan& operator=(const LatencySpan&) = delete;
+
+private:
+    LatencyStage stage_;
+    long long start_ns_;
+};
+
+// Periodic dump: one line per stage with samples, percentiles over the
+// interval since the previous dump() and the sample count overall.
+class LatencyReport {
+public:
+    std::string dump();
+
+private:
+    std::array<std::vector<std::uint64_t>, kLatencyStageCount> last_;
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "candle_series.hpp"
+#include "types.hpp"
+
+class UpbitRestClient;
+
+// On-disk trade: a TradeTick without the code (files are per market).
+struct TradeRecord {
+    long long ts_ms{};
+    long long sequential_id{};
+    double price{};
+    double volume{};
+    std::uint32_t is_bid{0};
+    std::uint32_t reserved{0};
+};
+
+TradeRecord to_trade_record(const TradeTick& t);
+
+// Append-only file of fixed-size records ordered by ts_ms, read through a
+// shared mapping: a 32-byte header, then the records back to back in host
+// byte order.
+//
+// Records are only ever added past the end (or the newest one rewritten in
+// place) with one pwrite, so a crash can at worst leave a torn or zero-filled
+// tail. open() cuts a partial trailing record and drops trailing records that
+// fail validation; everything before them is intact. sync() makes appends
+// durable. One writer per file, enforced with flock.
+template <typename T>
+class AppendLog {
+public:
+    static constexpr size_t kIndexStride = 256; // records per sparse index entry
+
+    AppendLog() = default;
+    ~AppendLog();
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    // Creates the file if needed.
+    bool open(const std::string& path, std::string* error = nullptr);
+    // A snapshot of an existing file for replay: no lock (the writer may
+    // still be appending), a torn tail is skipped rather than cut, and
+    // append/replace_back fail.
+    bool open_read_only(const std::string& path, std::string* error = nullptr);
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // Valid until the next append.
+    const T* data() const { return map_ ? reinterpret_cast<const T*>(map_ + kHeaderBytes) : nullptr; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T& back() const { return data()[size_ - 1]; }
+    // First record with ts_ms >= ts (size() if none): the sparse index picks
+    // one stride, a binary search finishes inside it.
+    size_t lower_bound(long long ts_ms) const;
+
+    // All-or-nothing: false (and nothing written) if any record is invalid
+    // or earlier than the one before it. A failed write closes the log.
+    bool append(const T* records, size_t n);
+    bool append(const T& record) { return append(&record, 1); }
+    // Rewrites the newest record, e.g. a bar that was still updating.
+    bool replace_back(const T& record);
+    bool sync();
+
+    // Trailing records open() discarded as torn.
+    size_t recovered() const { return recovered_; }
+
+    static constexpr size_t kHeaderBytes = 32;
+
+private:
+    bool open_file(const std::string& path, std::string* error, bool writable);
+    bool map_at_least(size_t bytes);
+    void unmap();
+
+    int fd_{-1};
+    bool writable_{false};
+    const unsigned char* map_{nullptr};
+    size_t map_bytes_{0};
+    size_t size_{0};
+    size_t recovered_{0};
+    std::vector<long long> index_; // ts of records 0, kIndexStride, 2 * kIndexStride, ...
+};
+
+using CandleLog = AppendLog<Candle>;
+using TradeLog = AppendLog<TradeRecord>;
+extern template class AppendLog<Candle>;
+extern template class AppendLog<TradeRecord>;
+
+// Candles with from_ms <= ts_ms < to_ms, straight from the mapping.
+CandleSpan candle_range(const CandleLog& log, long long from_ms, long long to_ms);
+
+// One directory per market under `root`:
+//   <root>/<market>/<unit>m.candles   closed minute candles
+//   <root>/<market>/trades.ticks      raw trades
+// Logs are opened on first use and every method is thread-safe. A log that
+// cannot be opened (e.g. held by another process) just makes the archive a
+// pass-through for that market.
+class MarketArchive {
+public:
+    explicit MarketArchive(std::string root);
+    ~MarketArchive();
+
+    const std::string& root() const { return root_; }
+    std::string candle_path(const std::string& market, int unit) const;
+    std::string trade_path(const std::string& market) const;
+
+    // How many of the newest bars to request so that, with what is archived,
+    // the last `lookback` bars are complete: the closed bars missing since
+    // the newest archived one, plus the forming bar.
+    int gap_count(const std::string& market, int unit, int lookback, long long now_ms);
+    // Archives the closed bars of a REST page (oldest first) and returns the
+    // last `lookback` bars: archived history followed by the page's newer bars.
+    std::vector<Candle> merge(const std::string& market, int unit, const std::vector<Candle>& page,
+                              size_t lookback, long long now_ms);
+    std::vector<Candle> load(const std::string& market, int unit, long long from_ms, long long to_ms);
+
+    // Trades older than the newest archived one are skipped.
+    size_t append_trades(const std::string& market, const TradeRecord* trades, size_t n);
+    void sync();
+    // Why the most recent log failed to open, if one did.
+    std::string last_error();
+
+    static long long now_ms();
+
+private:
+    CandleLog* candle_log(const std::string& market, int unit);
+    TradeLog* trade_log(const std::string& market);
+    std::string market_dir(const std::string& market) const;
+
+    std::mutex mutex_;
+    std::string root_;
+    std::map<std::string, std::unique_ptr<CandleLog>> candles_; // "<market>/<unit>"
+    std::map<std::string, std::unique_ptr<TradeLog>> trades_;
+    std::string last_error_;
+};
+
+// get_candles_minutes_batch through the archive: asks each market only for
+// its gap, archives the closed bars and returns the last `lookback` bars per
+// market. With no archive this is a plain batch fetch of `lookback` bars.
+std::vector<std::pair<std::string, std::vector<Candle>>> fetch_candles_cached(
+    UpbitRestClient& rest, MarketArchive* archive, const std::vector<std::string>& markets, int unit, int lookback);
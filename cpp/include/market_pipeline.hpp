@@ -0,0 +1,167 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "latency_histogram.hpp"
+#include "market_archive.hpp"
+#include "market_selector.hpp"
+#include "multi_market_engine.hpp"
+#include "order_book.hpp"
+#include "spsc_queue.hpp"
+#include "types.hpp"
+#include "ws_decoder.hpp"
+
+// One decoded public frame as it travels from the network thread to the
+// strategy thread. Plain data so it can sit in a ring slot.
+struct MarketEvent {
+    WsMessageType type{WsMessageType::Unknown};
+    long long recv_ns{};   // frame handed to on_frame
+    long long queued_ns{}; // decoded and pushed
+    TradeTick trade;
+    OrderbookSnapshot book;
+};
+
+struct PipelineStats {
+    std::uint64_t frames{0};
+    std::uint64_t bytes{0};
+    std::uint64_t dropped{0}; // queue full
+    size_t queue_depth{0};
+    size_t queue_high_water{0};
+    LatencySummary decode;     // arrival -> queued (network thread)
+    LatencySummary queue_wait; // queued -> picked up (strategy thread)
+    LatencySummary apply;      // strategy-thread work per event
+    LatencySummary end_to_end; // arrival -> applied
+};
+
+// What the UI is allowed to see, republished at most every kPublishIntervalMs.
+struct MarketSnapshot {
+    std::string market;
+    MarketState::Candles5m candles_5m;
+    OrderBook book;
+    long long last_recv_ns{0}; // arrival of the newest frame applied (MarketPipeline::now_ns)
+    std::uint64_t version{0};
+};
+
+// Network thread -> SPSC ring -> strategy thread. The network thread decodes
+// frames into MarketEvents; the strategy thread owns the charted market's
+// state and a MarketRanker over every market it sees trades for, forwards
+// every event to an optional sink (e.g. the shard engine) and publishes
+// throttled snapshots and rankings for the UI.
+class MarketPipeline {
+public:
+    static constexpr size_t kQueueCapacity = 1024;
+    static constexpr long long kPublishIntervalMs = 50;
+    static constexpr long long kArchiveFlushMs = 250;
+    // a 1m close re-ranks at most this often
+    static constexpr long long kRankIntervalMs = 1'000;
+    static constexpr size_t kRankedMarkets = 10;
+    using EventSink = std::function<void(const MarketEvent&)>;
+
+    MarketPipeline();
+    ~MarketPipeline();
+
+    MarketPipeline(const MarketPipeline&) = delete;
+    MarketPipeline& operator=(const MarketPipeline&) = delete;
+
+    static long long now_ns();
+
+    // Network thread only. Returns false if the frame was dropped (queue full).
+    bool on_frame(std::string_view frame, WsFormat format);
+
+    // Any thread; picked up by the strategy thread before its next event.
+    void set_market(std::string market, CandleSpan candles_5m);
+    // Closed 5m bars fetched for a gap in the stream, folded into the
+    // market's history in place (see MarketState::merge_candles). Ignored if
+    // `market` is no longer the one followed.
+    void merge_candles(std::string market, std::vector<Candle> candles_5m);
+    void set_event_sink(EventSink sink);
+    // Every trade is also appended to the archive, in batches off the hot
+    // path. The archive must outlive the pipeline (or be reset to nullptr).
+    void set_archive(MarketArchive* archive);
+    // Limits archiving to these markets and the followed one; empty (the
+    // default) archives every market traded.
+    void set_archived_markets(std::vector<std::string> markets);
+    // Ranker input: each market's 1m bars replace its window (oldest first,
+    // the last still forming) and tickers set 24h turnover.
+    void seed_ranking(std::vector<std::pair<std::string, std::vector<Candle>>> bars_1m);
+    void set_turnover(std::vector<Ticker24h> tickers);
+
+    // Fills `out` and returns true if a snapshot newer than `version` exists.
+    bool read_snapshot(std::uint64_t& version, MarketSnapshot& out) const;
+    // Fills `out` with the best kRankedMarkets, best first, and returns true
+    // if a ranking newer than `version` exists.
+    bool read_ranking(std::uint64_t& version, std::vector<RankedMarket>& out) const;
+    PipelineStats stats() const;
+
+    void stop();
+
+private:
+    void run();
+    void apply_control();
+    void apply(const MarketEvent& ev);
+    void publish();
+    void rank();
+    void flush_archive();
+    bool archives(std::string_view market) const;
+
+    using Queue = SpscQueue<MarketEvent, kQueueCapacity>;
+    std::unique_ptr<Queue> queue_; // ~1 MB of slots, keep it off the caller's stack
+    MarketEvent scratch_{};        // network thread's decode target
+
+    std::atomic<bool> stop_{false};
+    std::thread strategy_;
+
+    // control mailbox: rare, so a mutex is fine here
+    std::mutex control_mutex_;
+    std::atomic<bool> control_pending_{false};
+    bool market_pending_{false};
+    std::string next_market_;
+    MarketState::Candles5m next_candles_;
+    std::vector<std::pair<std::string, std::vector<Candle>>> pending_merges_;
+    bool sink_pending_{false};
+    EventSink next_sink_;
+    bool archive_pending_{false};
+    MarketArchive* next_archive_{nullptr};
+    bool archived_markets_pending_{false};
+    std::vector<std::string> next_archived_markets_;
+    std::vector<std::pair<std::string, std::vector<Candle>>> pending_seeds_;
+    std::vector<Ticker24h> pending_turnover_;
+
+    // strategy-thread state
+    MarketState state_;
+    EventSink sink_;
+    bool dirty_{false};
+    long long last_publish_ns_{0};
+    long long last_recv_ns_{0};
+    MarketArchive* archive_{nullptr};
+    std::vector<std::string> archived_markets_;
+    std::unordered_map<std::string, std::vector<TradeRecord>> unarchived_; // by market
+    size_t unarchived_count_{0};
+    long long last_archive_ns_{0};
+    MarketRanker ranker_;
+    bool rank_due_{false};
+    long long last_rank_ns_{0};
+
+    mutable std::mutex snapshot_mutex_;
+    MarketSnapshot snapshot_;
+    std::vector<RankedMarket> ranking_;
+    std::uint64_t ranking_version_{0};
+
+    std::atomic<std::uint64_t> frames_{0};
+    std::atomic<std::uint64_t> bytes_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<size_t> high_water_{0};
+    LatencyHistogram decode_;
+    LatencyHistogram queue_wait_;
+    LatencyHistogram apply_;
+    LatencyHistogram end_to_end_;
+};
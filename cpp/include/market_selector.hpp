@@ -1,11 +1,85 @@
 #pragma once
+#include <cstddef>
+#include <deque>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
+#include "candle_series.hpp"
+#include "indicators.hpp"
 #include "types.hpp"
 
 class MarketSelector {
 public:
     std::string select_top_market(const std::vector<Ticker24h>& tickers,
                                   const std::vector<std::pair<std::string, std::vector<Candle>>>& candles_1m);
+    // Best `n` markets by the same score, best first.
+    std::vector<std::string> select_top_markets(const std::vector<Ticker24h>& tickers,
+                                                const std::vector<std::pair<std::string, std::vector<Candle>>>& candles_1m,
+                                                size_t n);
 };
 
+// What a ranking score sees of one market.
+struct MarketStats {
+    double realized_vol{0.0}; // RMS of the 1m log returns in the window
+    double turnover_24h{0.0}; // KRW
+    size_t returns{0};        // 1m returns in the window
+    double last_price{0.0};
+};
+
+using MarketScoreFn = std::function<double(const MarketStats&)>;
+
+// MarketSelector's score: log(24h turnover) x 1m realised volatility.
+double volatility_turnover_score(const MarketStats& s);
+
+struct RankedMarket {
+    std::string market;
+    double score{0.0};
+};
+
+// Keeps rolling 1m realised volatility for every market it is fed and ranks
+// them on demand. Each minute close costs O(1) and a ranking is one scoring
+// pass plus a partial sort of the top n, so re-ranking a few hundred markets
+// every bar takes microseconds. Not thread-safe; the owner serialises calls.
+class MarketRanker {
+public:
+    static constexpr size_t kDefaultWindow = 60;
+
+    explicit MarketRanker(size_t window = kDefaultWindow, MarketScoreFn score = volatility_turnover_score);
+
+    void set_score(MarketScoreFn score) { score_ = std::move(score); }
+    void set_turnover(std::string_view market, double krw_24h);
+    // Replaces the market's window with 1m bars, oldest first; the last one
+    // is taken as still forming.
+    void seed(std::string_view market, CandleSpan bars_1m);
+    // A trade in a later minute closes the previous one at its last price
+    // and returns true. Minutes without trades add no return, as with REST
+    // candles.
+    bool on_trade(std::string_view market, long long ts_ms, double price);
+
+    // Best `n` markets with at least one return, best first.
+    std::vector<RankedMarket> top(size_t n) const;
+    const MarketStats* stats(std::string_view market) const;
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        explicit Entry(std::string code, size_t window) : code(std::move(code)), sq_returns(window) {}
+        std::string code;
+        MarketStats stats;
+        RollingMean sq_returns;
+        double prev_close{0.0}; // close of the last closed minute
+        long long minute{0};    // bucket start of the forming minute; 0 before any price
+    };
+
+    Entry& entry(std::string_view market);
+    void close_minute(Entry& e);
+
+    size_t window_;
+    MarketScoreFn score_;
+    std::deque<Entry> entries_; // stable addresses: index_ keys view their codes
+    std::unordered_map<std::string_view, size_t> index_;
+    mutable std::vector<std::pair<double, size_t>> scratch_;
+};
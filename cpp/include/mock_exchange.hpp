@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "market_archive.hpp"
+
+struct MockExchangeConfig {
+    std::string host{"127.0.0.1"};
+    int port{0}; // 0 picks a free port
+    // Added before every REST reply.
+    long long latency_us{0};
+    long long jitter_us{0}; // uniform extra, on top of latency_us
+    // Requests per second per Remaining-Req group; past it the server
+    // answers 429 until the next second. 0 lifts the limit and drops the
+    // group's Remaining-Req header.
+    int market_per_sec{10};
+    int candles_per_sec{10};
+    int order_per_sec{8};
+    int default_per_sec{30};
+    double reject_ratio{0.0}; // extra 429s at random, 0..1
+    // Tape milliseconds per wall millisecond; 0 replays as fast as the
+    // sockets drain.
+    double feed_speed{1.0};
+    // The first part of each tape is history: served as candles, never
+    // streamed.
+    long long history_ms{6LL * 60 * 60 * 1000};
+    int book_levels{15};
+    unsigned seed{1};
+};
+
+struct MockExchangeStats {
+    std::uint64_t requests{0};
+    std::uint64_t rate_limited{0};
+    std::uint64_t orders{0};
+    std::uint64_t cancels{0};
+    std::uint64_t fills{0};
+    std::uint64_t ws_sessions{0};
+    std::uint64_t frames_sent{0};
+    std::uint64_t bytes_sent{0};
+};
+
+// Local stand-in for Upbit's quotation and exchange APIs, for offline
+// latency and load testing:
+//   GET    /v1/market/all, /v1/ticker, /v1/candles/minutes/{unit}, /v1/order
+//   POST   /v1/orders
+//   DELETE /v1/order
+//   WS     /websocket/v1  trade, orderbook and myOrder streams (DEFAULT or SIMPLE)
+// Each market replays its tape in a loop; candles and tickers are built from
+// what has been replayed, and orders are matched against it with
+// SimulatedExchange. Order endpoints and myOrder want an Authorization
+// header but the token is not verified. Plain HTTP/WS, no TLS.
+class MockUpbitServer {
+public:
+    explicit MockUpbitServer(MockExchangeConfig config = {});
+    ~MockUpbitServer();
+
+    MockUpbitServer(const MockUpbitServer&) = delete;
+    MockUpbitServer& operator=(const MockUpbitServer&) = delete;
+
+    // Before start(). Tapes share one time axis; a market with no tape gets
+    // a synthetic one.
+    void add_market(const std::string& market, std::vector<TradeRecord> tape = {});
+
+    bool start(std::string* error = nullptr);
+    void stop();
+
+    int port() const;
+    std::string rest_url() const; // http://host:port
+    std::string ws_url() const;   // ws://host:port/websocket/v1
+    MockExchangeStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "candle_series.hpp"
+#include "order_book.hpp"
+#include "strategy_5m_scalper.hpp"
+#include "timeframe_bars.hpp"
+#include "types.hpp"
+#include "ws_decoder.hpp"
+
+struct MarketPosition {
+    double qty{};
+    double avg_price{};
+};
+
+struct MarketOrder {
+    std::string uuid;
+    bool is_buy{};
+    double price{};
+    double volume{};
+    long long submitted_ms{};
+};
+
+// Everything the engine tracks for one symbol. A MarketState is only ever
+// touched from its shard's worker thread.
+struct MarketState {
+    static constexpr size_t kMaxCandles = TimeframeBars::kCapacity;
+    using Candles5m = TimeframeBars::Series;
+
+    std::string code;
+    TimeframeBars bars; // 1m to 60m; the strategy trades the 5m ones
+    OrderBook book;
+    MarketPosition position;
+    std::vector<MarketOrder> pending_orders;
+    ScalperStream signal;
+    TradeDecision last_decision; // refreshed on every trade from `signal`
+    long long last_trade_ms{0};
+
+    const Candles5m& candles_5m() const { return bars[Timeframe::M5]; }
+    // Replaces the 5m history (last element = forming bar), and the 15m and
+    // 60m bars with its resample, and rebuilds the signal.
+    void seed(CandleSpan candles);
+    // Folds closed 5m bars fetched for a gap in the stream into the history
+    // (see TimeframeBars::merge) and rebuilds the signal.
+    void merge_candles(CandleSpan candles);
+    // Rolls the trade into the forming bar of every timeframe.
+    void on_trade(const TradeTick& trade);
+    void on_fill(bool is_buy, double price, double volume);
+};
+
+// Markets are partitioned over a fixed set of worker threads (shards). The
+// caller's thread decodes frames and routes them by code; each shard applies
+// its own markets' events in order, so market state needs no locking.
+class MultiMarketEngine {
+public:
+    // Called on the shard's worker thread.
+    using DecisionFn = std::function<void(const MarketState&, const TradeDecision&)>;
+    using StateFn = std::function<void(MarketState&)>;
+
+    // workers <= 0 uses one per hardware thread; never more than one per market.
+    explicit MultiMarketEngine(std::vector<std::string> markets, int workers = 0);
+    ~MultiMarketEngine();
+
+    MultiMarketEngine(const MultiMarketEngine&) = delete;
+    MultiMarketEngine& operator=(const MultiMarketEngine&) = delete;
+
+    const std::vector<std::string>& markets() const { return codes_; }
+    size_t shard_count() const { return shards_.size(); }
+
+    // One subscription covering trade + orderbook for every market, plus
+    // trades alone for `trade_only` (e.g. to rank markets not traded here).
+    std::string subscription_message(std::string_view ticket, WsFormat format = WsFormat::Default,
+                                     const std::vector<std::string>& trade_only = {}) const;
+
+    // Decodes a public frame and queues it on the owning shard. Returns false
+    // for frames that are not trade/orderbook or belong to no tracked market.
+    // Frames must be dispatched from one thread (the socket's).
+    bool dispatch(std::string_view frame, WsFormat format = WsFormat::Default);
+    bool dispatch(const TradeTick& trade);
+    bool dispatch(const OrderbookSnapshot& book);
+
+    // Runs fn against the market's state on its shard; false if the code is unknown.
+    bool post(std::string_view code, StateFn fn);
+    void seed_candles(std::string_view code, std::vector<Candle> candles);
+    void merge_candles(std::string_view code, std::vector<Candle> candles);
+
+    // Evaluates the strategy for every market, shards in parallel, and blocks
+    // until all are done. order_krw sizes the entry checked against the book.
+    void evaluate_all(double order_krw, const DecisionFn& on_decision);
+
+private:
+    using Event = std::variant<TradeTick, OrderbookSnapshot, std::function<void()>>;
+
+    struct Shard {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Event> events;
+        std::vector<MarketState*> markets;
+        Strategy5mScalper strategy;
+        bool stop{false};
+        std::thread worker;
+    };
+
+    struct Route {
+        std::string_view code; // points into MarketState::code
+        MarketState* state;
+        Shard* shard;
+    };
+
+    const Route* route(std::string_view code) const;
+    void enqueue(Shard& shard, Event ev);
+    void run(Shard& shard);
+
+    std::vector<std::string> codes_;
+    std::vector<std::unique_ptr<MarketState>> states_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<Route> routes_; // sorted by code
+    TradeTick trade_scratch_{};
+    OrderbookSnapshot book_scratch_{};
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include "types.hpp"
+
+enum class BookSide { Bid, Ask };
+
+struct PriceLevel {
+    double price{};
+    double size{};
+};
+
+// L2 book for one market. Each side is a fixed array of levels sorted
+// best-first (bids descending, asks ascending), so snapshots are applied in
+// place and every query is a short linear walk over contiguous memory.
+class OrderBook {
+public:
+    static constexpr int kMaxLevels = OrderbookSnapshot::kMaxLevels;
+
+    // Replaces both sides with the snapshot's levels; empty rows are dropped.
+    void apply(const OrderbookSnapshot& snap);
+    // Sets one price level (size 0 removes it), keeping the side sorted.
+    // Returns false if the level is new and the side is full and it would rank last.
+    bool update_level(BookSide side, double price, double size);
+    void clear();
+
+    bool empty() const { return bid_depth_ == 0 || ask_depth_ == 0; }
+    int depth(BookSide side) const { return side == BookSide::Bid ? bid_depth_ : ask_depth_; }
+    const PriceLevel& level(BookSide side, int i) const { return side == BookSide::Bid ? bids_[i] : asks_[i]; }
+    long long ts_ms() const { return ts_ms_; }
+
+    double best_bid() const { return bid_depth_ > 0 ? bids_[0].price : 0.0; }
+    double best_ask() const { return ask_depth_ > 0 ? asks_[0].price : 0.0; }
+    double mid() const;
+    double spread() const;
+
+    // Size resting on `side` at prices no worse than `price` for a taker
+    // (asks <= price, bids >= price).
+    double depth_at_price(BookSide side, double price) const;
+    // Average price for taking `size` from `side`. If the visible book is
+    // shallower, averages what is there; `filled` (optional) gets the size covered.
+    double vwap_to_size(BookSide side, double size, double* filled = nullptr) const;
+    // (bid - ask) / (bid + ask) size over the top `levels` of each side, in [-1, 1].
+    double imbalance(int levels = kMaxLevels) const;
+    // Top-of-book price weighted toward the thinner side.
+    double microprice() const;
+
+private:
+    std::array<PriceLevel, kMaxLevels> bids_{};
+    std::array<PriceLevel, kMaxLevels> asks_{};
+    int bid_depth_{0};
+    int ask_depth_{0};
+    long long ts_ms_{0};
+};
@@ -0,0 +1,135 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "latency_histogram.hpp"
+#include "rate_limiter.hpp"
+#include "types.hpp"
+#include "upbit_rest.hpp"
+
+struct OrderGatewayConfig {
+    // Commands waiting to go out; beyond this post()/cancel()/... refuse.
+    size_t queue_capacity{64};
+    // Requests on the wire at once, per rate-limit group (indexed by
+    // RateGroup). Posts and cancels are Order, status queries Default.
+    std::array<int, 4> max_in_flight{{1, 1, 4, 2}};
+};
+
+enum class GatewayOp { Post, Cancel, Replace, Query };
+
+const char* gateway_op_name(GatewayOp op);
+
+struct GatewayReport {
+    GatewayOp op{GatewayOp::Post};
+    std::string identifier; // the post's (for Replace: the replacement's)
+    std::string uuid;       // the order cancelled or queried
+    // Post/Query: the exchange's answer. Replace: the replacement's post,
+    // empty unless replacement_sent.
+    OrderResult result;
+    OrderResult cancel; // Cancel/Replace
+    bool replacement_sent{false};
+    double replacement_volume{0.0};
+    long long queue_us{0}; // accepted -> sent
+    long long ack_us{0};   // sent -> answered (both legs of a Replace)
+};
+
+struct GatewayStats {
+    std::uint64_t submitted{0};
+    std::uint64_t rejected_full{0};
+    std::uint64_t completed{0};
+    std::uint64_t replaced{0};
+    std::uint64_t replace_aborted{0}; // cancel refused or nothing left to re-post
+    size_t queued{0};
+    std::array<int, 4> in_flight{};
+    LatencySummary queue_wait;
+    LatencySummary ack; // per request, posts and cancels alike
+};
+
+// Pipelined order submission. Commands queue in a bounded FIFO and a gateway
+// thread sends them as soon as their rate-limit group has room, without
+// waiting for earlier answers; per group they leave in submission order.
+//
+// cancel_replace() is cancel-then-post: the replacement goes out only once
+// the cancel is accepted, and with volume <= 0 it takes the cancelled order's
+// remaining volume from the cancel reply, so a fill racing the cancel is
+// never re-posted.
+//
+// Callbacks run on the gateway thread; the caller stamps identifiers (see
+// OrderTracker::submit) before handing orders over.
+class OrderGateway {
+public:
+    using Callback = std::function<void(const GatewayReport&)>;
+
+    explicit OrderGateway(UpbitRestClient& rest, OrderGatewayConfig config = {});
+    ~OrderGateway();
+
+    OrderGateway(const OrderGateway&) = delete;
+    OrderGateway& operator=(const OrderGateway&) = delete;
+
+    // False (and no callback) when the queue is full or the gateway stopped.
+    bool post(OrderRequest req, Callback cb);
+    bool cancel(std::string uuid, Callback cb);
+    bool cancel_replace(std::string uuid, OrderRequest replacement, Callback cb);
+    bool query(std::string uuid, std::string identifier, Callback cb);
+
+    // Waits for requests already sent; queued commands are reported with
+    // error "gateway stopped".
+    void stop();
+    GatewayStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Command {
+        GatewayOp op{GatewayOp::Post};
+        OrderRequest req;
+        std::string uuid;
+        Callback cb;
+        Clock::time_point queued_at;
+        Clock::time_point sent_at;
+        GatewayReport report;
+    };
+    struct Completion {
+        std::shared_ptr<Command> cmd;
+        OrderResult result;
+    };
+
+    bool enqueue(Command cmd);
+    void run();
+    bool sendable() const;
+    bool idle() const;
+    void send(const std::shared_ptr<Command>& cmd);
+    UpbitRestClient::OrderCallback on_result(const std::shared_ptr<Command>& cmd);
+    void complete(Completion done);
+    void finish(Command& cmd);
+    static size_t group_of(GatewayOp op);
+
+    UpbitRestClient& rest_;
+    OrderGatewayConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Command> queue_;
+    std::deque<Completion> done_;
+    std::array<int, 4> in_flight_{};
+    bool stop_{false};
+
+    std::atomic<std::uint64_t> submitted_{0};
+    std::atomic<std::uint64_t> rejected_full_{0};
+    std::atomic<std::uint64_t> completed_{0};
+    std::atomic<std::uint64_t> replaced_{0};
+    std::atomic<std::uint64_t> replace_aborted_{0};
+    LatencyHistogram queue_wait_;
+    LatencyHistogram ack_;
+
+    std::thread worker_;
+};
@@ -1,18 +1,31 @@
 #pragma once
+#include <vector>
+#include "order_tracker.hpp"
+#include "order_venue.hpp"
 #include "types.hpp"
 #include "upbit_rest.hpp"
 
 class OrderManager {
 public:
-    explicit OrderManager(UpbitRestClient& rest,
+    explicit OrderManager(OrderVenue& venue,
                           double fee_rate = UpbitRestClient::taker_fee_rate(),
                           double min_notional = 5000.0);
 
     OrderResult place_order(const OrderRequest& req);
     OrderResult cancel_order(const CancelRequest& req);
 
+    // Per-order log lines on std::clog; on by default.
+    void set_logging(bool on) { logging_ = on; }
+    // Registers every order (stamping its identifier) and every post and
+    // cancel result with `tracker`; off by default. Fill reports from the
+    // private socket go to the tracker directly.
+    void set_tracker(OrderTracker* tracker) { tracker_ = tracker; }
+
 private:
-    UpbitRestClient& rest_;
+    OrderVenue& venue_;
     double fee_rate_;
     double min_notional_;
+    bool logging_{true};
+    OrderTracker* tracker_{nullptr};
+    std::vector<OrderUpdate> updates_;
 };
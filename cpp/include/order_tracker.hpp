@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "types.hpp"
+
+enum class OrderState { PendingNew, Open, PartiallyFilled, Done, Cancelled, Rejected };
+
+const char* order_state_name(OrderState s);
+inline bool is_terminal(OrderState s) {
+    return s == OrderState::Done || s == OrderState::Cancelled || s == OrderState::Rejected;
+}
+
+// One order report from either side: a myOrder WebSocket frame or an order
+// body from the REST API (post, cancel or status).
+struct OrderEvent {
+    std::string uuid;
+    std::string identifier;
+    std::string market;
+    std::string state; // wait, watch, trade, done, cancel
+    bool is_buy{false};
+    double executed_volume{-1.0};  // cumulative; < 0 if the report had none
+    double remaining_volume{-1.0}; // < 0 if the report had none
+    double avg_price{0.0};
+    double trade_price{0.0}; // this report's own fill, if any
+    double trade_volume{0.0};
+    long long trade_ts{0};
+};
+
+// Reads either format (DEFAULT keys). False if `json` is not an order object.
+bool parse_order_event(std::string_view json, OrderEvent& out);
+
+struct TrackedOrder {
+    std::string identifier;
+    std::string uuid; // empty until the exchange has acknowledged the order
+    std::string market;
+    bool is_buy{false};
+    std::string ord_type;
+    double price{0.0};
+    double volume{0.0};
+    OrderState state{OrderState::PendingNew};
+    double filled_volume{0.0};
+    double filled_notional{0.0};
+    int fills{0};
+    long long submitted_ms{0};
+    long long acked_ms{0};
+    long long updated_ms{0};
+    std::string reject_reason;
+
+    double avg_fill_price() const { return filled_volume > 0.0 ? filled_notional / filled_volume : 0.0; }
+};
+
+// What one REST result or WebSocket event changed.
+struct OrderUpdate {
+    const TrackedOrder* order{nullptr}; // nullptr: an order this tracker never placed
+    std::string uuid;
+    bool is_buy{false};
+    OrderState previous{OrderState::PendingNew};
+    bool state_changed{false};
+    // New fill carried by the report; cumulative volumes make replays and
+    // duplicate reports add nothing.
+    double fill_price{0.0};
+    double fill_volume{0.0};
+    long long fill_ts{0};
+};
+
+// Book-keeping for our orders, keyed by both the client identifier we send
+// with each order and the exchange uuid, so fills reported on the private
+// socket before the REST response are not lost and orders can be sent
+// without waiting for each other's responses.
+//
+// Event order does not matter: a report naming our identifier links the
+// uuid itself; a report with neither a known uuid nor identifier waits
+// until the outstanding acks are in, then is passed on as foreign.
+// Not thread-safe: one owner thread feeds it.
+class OrderTracker {
+public:
+    // Identifiers are "<prefix>-<session start ms>-<n>", unique across runs.
+    explicit OrderTracker(std::string prefix = "us");
+
+    // Registers the order about to be sent and stamps req.identifier (a
+    // caller-supplied one is kept).
+    const TrackedOrder& submit(OrderRequest& req, long long now_ms);
+    // The post's result. A transport failure (no HTTP status) leaves the
+    // order pending: it may well exist, and its events still resolve it.
+    void on_post_result(const std::string& identifier, const OrderResult& res, long long now_ms,
+                        std::vector<OrderUpdate>& updates);
+    // The order never left (e.g. a full gateway queue): closes it as rejected.
+    void on_not_sent(const std::string& identifier, const std::string& reason, long long now_ms,
+                     std::vector<OrderUpdate>& updates);
+    void on_cancel_result(const std::string& uuid, const OrderResult& res, long long now_ms,
+                          std::vector<OrderUpdate>& updates);
+    void on_event(const OrderEvent& event, long long now_ms, std::vector<OrderUpdate>& updates);
+
+    const TrackedOrder* find_by_identifier(const std::string& identifier) const;
+    const TrackedOrder* find_by_uuid(const std::string& uuid) const;
+    size_t size() const { return orders_.size(); }
+    size_t pending_acks() const { return pending_acks_; }
+    // Open and partially filled orders.
+    std::vector<const TrackedOrder*> live_orders() const;
+
+    // Drops closed orders last updated before `before_ms`; pointers handed
+    // out for them are invalid afterwards.
+    size_t forget_closed(long long before_ms);
+
+private:
+    void apply(TrackedOrder& o, const OrderEvent& e, long long now_ms, std::vector<OrderUpdate>& updates);
+    void set_state(TrackedOrder& o, OrderState s);
+    void link(TrackedOrder& o, const std::string& uuid);
+    void release_orphans(const std::string& uuid, long long now_ms, std::vector<OrderUpdate>& updates);
+
+    std::string prefix_;
+    unsigned long long next_{1};
+    std::unordered_map<std::string, TrackedOrder> orders_;    // by identifier
+    std::unordered_map<std::string, std::string> by_uuid_;    // uuid -> identifier
+    std::unordered_map<std::string, std::vector<OrderEvent>> orphans_; // by uuid
+    size_t pending_acks_{0};
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include "types.hpp"
+
+// Where OrderManager sends orders: the exchange's REST API, or the
+// simulated matcher the backtest replays against.
+class OrderVenue {
+public:
+    virtual ~OrderVenue() = default;
+    virtual OrderResult post_order(const OrderRequest& req) = 0;
+    virtual OrderResult cancel_order(const CancelRequest& req) = 0;
+};
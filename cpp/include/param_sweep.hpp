@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "backtest.hpp"
+
+// One market's tape, shared read-only by every run of a sweep (normally a
+// view into a ReplayData mapping).
+struct SweepTape {
+    std::string market;
+    CandleSpan warmup;
+    const TradeRecord* trades{nullptr};
+    size_t size{0};
+};
+
+// Values to try per parameter. sweep_grid() takes the cartesian product;
+// sweep_random() draws each parameter uniformly between the smallest and
+// largest value listed (whole bars for the bar counts).
+struct SweepSpace {
+    std::vector<size_t> breakout_bars{5};
+    std::vector<size_t> atr_period{14};
+    std::vector<double> risk_per_trade{0.01};
+    std::vector<double> take_profit_atr{1.5};
+    std::vector<double> stop_loss_atr{1.0};
+};
+
+std::vector<BacktestConfig> sweep_grid(const SweepSpace& space, const BacktestConfig& base);
+std::vector<BacktestConfig> sweep_random(const SweepSpace& space, const BacktestConfig& base, size_t count, unsigned seed);
+
+// Called from worker threads after each run.
+using SweepProgressFn = std::function<void(size_t done, size_t total)>;
+
+// Backtests every config against every tape on `threads` workers (<= 0: one
+// per hardware thread). Workers start on their own contiguous block of
+// runs, a tape at a time, and steal from the far end of a busy worker's
+// block once theirs is done. Report i * tapes.size() + j is config i on
+// tape j.
+std::vector<BacktestReport> run_sweep(const std::vector<BacktestConfig>& configs, const std::vector<SweepTape>& tapes,
+                                      int threads = 0, const SweepProgressFn& on_progress = {});
+
+// One row per run: the config index, market, swept parameters and report.
+bool write_sweep_csv(const std::string& path, const std::vector<BacktestConfig>& configs,
+                     const std::vector<BacktestReport>& reports, std::string* error = nullptr);
+// The same table by column: <dir>/<column>.f64 or .u64 (raw host-order
+// arrays, e.g. numpy.fromfile), market.u32 indexing the names in
+// market.dict, and schema.txt listing the row count and every column.
+bool write_sweep_columns(const std::string& dir, const std::vector<BacktestConfig>& configs,
+                         const std::vector<BacktestReport>& reports, std::string* error = nullptr);
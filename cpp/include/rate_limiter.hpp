@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+// Upbit rate-limit groups as reported in the Remaining-Req response header.
+enum class RateGroup { Market, Candles, Order, Default };
+
+// Order/cancel traffic runs in the High lane; quotation polling in Low.
+// A Low request never takes a token while a High request is waiting on the same group,
+// whether blocked in acquire() or told to retry by try_acquire().
+enum class RateLane { High, Low };
+
+struct RemainingReq {
+    RateGroup group{RateGroup::Default};
+    int per_sec{-1};
+    int per_min{-1};
+};
+
+struct RateGroupStats {
+    std::uint64_t granted{0};
+    std::uint64_t delayed{0};
+    std::uint64_t rate_limited{0};
+    double tokens{0.0};
+};
+
+class RateLimiter {
+public:
+    RateLimiter();
+
+    // "group=default; min=1800; sec=29"
+    static bool parse_remaining_req(std::string_view header, RemainingReq& out);
+    static RateGroup group_from_name(std::string_view name);
+
+    void configure(RateGroup group, double requests_per_sec);
+
+    // Blocks the calling thread until a token for `group` is available.
+    void acquire(RateGroup group, RateLane lane);
+    // Takes a token and returns 0, or returns the milliseconds to wait before retrying.
+    // A High caller sent away holds off Low takers until it is served or its
+    // wait has lapsed, so queued order traffic keeps its priority.
+    long try_acquire(RateGroup group, RateLane lane);
+
+    // Syncs the bucket with the server's view of the current window.
+    void on_response(std::string_view remaining_req_header);
+    // A 429 empties the bucket and holds the group back for the rest of the window.
+    void on_rate_limited(RateGroup group);
+
+    RateGroupStats stats(RateGroup group) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t kGroupCount = 4;
+
+    struct Bucket {
+        double capacity{10.0};
+        double refill_per_sec{10.0};
+        double tokens{10.0};
+        Clock::time_point last_refill{};
+        Clock::time_point blocked_until{};
+        int high_waiting{0};
+        Clock::time_point high_claim_until{}; // a High try_acquire is due back by then
+        RateGroupStats stats;
+    };
+
+    Bucket& bucket(RateGroup group) { return buckets_[static_cast<size_t>(group)]; }
+    void refill(Bucket& b, Clock::time_point now);
+    // Returns zero when a token was taken, otherwise how long until one may be.
+    Clock::duration take_locked(Bucket& b, RateLane lane, Clock::time_point now);
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<Bucket, kGroupCount> buckets_;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+// Vector kernels over contiguous double columns (see CandleColumns). Each has
+// AVX2, SSE2 and scalar versions; the best one the CPU supports is picked on
+// first use. Vector results can differ from a scalar loop in the last bits
+// (summation order, polynomial log). Prices must be positive and finite.
+
+enum class SimdIsa { Scalar, Sse2, Avx2 };
+
+// Best this build and CPU support.
+SimdIsa simd_best_isa();
+SimdIsa simd_active_isa();
+// Switches the kernels in use (benchmarks, equivalence checks). Requests
+// above simd_best_isa() are clamped; returns the ISA now active.
+SimdIsa simd_set_isa(SimdIsa isa);
+const char* simd_isa_name(SimdIsa isa);
+
+// out[i] = log(close[i + 1] / close[i]); writes n - 1 values.
+void simd_log_returns(const double* close, size_t n, double* out);
+// Sum of squared log returns of n closes (n - 1 returns).
+double simd_sum_sq_log_returns(const double* close, size_t n);
+
+// out[i] = true range of bar i + 1 against close[i]; writes n - 1 values.
+void simd_true_ranges(const double* high, const double* low, const double* close, size_t n, double* out);
+double simd_sum_true_ranges(const double* high, const double* low, const double* close, size_t n);
+
+double simd_sum_sq(const double* v, size_t n);
+double simd_max(const double* v, size_t n); // -inf for n == 0
+double simd_min(const double* v, size_t n); // +inf for n == 0
+
+// out[i] = max/min of v[i, i + window); writes n - window + 1 values.
+// Cost grows with window, so this is meant for short lookbacks.
+void simd_rolling_max(const double* v, size_t n, size_t window, double* out);
+void simd_rolling_min(const double* v, size_t n, size_t window, double* out);
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Each side caches the other's index so the shared cache line is
+// only read when the queue looks full (producer) or empty (consumer).
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "queue slots hold plain data");
+
+public:
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Producer side. Returns false (and drops nothing) when full.
+    bool try_push(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity) return false;
+        }
+        slots_[tail & kMask] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: peek at the oldest element without copying it out,
+    // then pop() once done with it. Returns nullptr when empty.
+    const T* front() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return nullptr;
+        }
+        return &slots_[head & kMask];
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_pop(T& out) {
+        const T* v = front();
+        if (!v) return false;
+        out = *v;
+        pop();
+        return true;
+    }
+
+    // Approximate when called off the producer/consumer threads.
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t head = head_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+    static constexpr size_t kLine = 64;
+
+    alignas(kLine) std::atomic<size_t> head_{0}; // written by the consumer
+    alignas(kLine) size_t tail_cache_{0};        // consumer's view of tail_
+    alignas(kLine) std::atomic<size_t> tail_{0}; // written by the producer
+    alignas(kLine) size_t head_cache_{0};        // producer's view of head_
+    alignas(kLine) T slots_[Capacity];
+};
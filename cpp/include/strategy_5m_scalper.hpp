@@ -1,16 +1,60 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "candle_series.hpp"
+#include "indicators.hpp"
 #include "types.hpp"
 
+class OrderBook;
+
 struct TradeDecision {
     bool enter_long{false};
     bool exit_position{false};
     double limit_price{};
+    double expected_price{}; // VWAP of the entry against the book, 0 without one
+};
+
+// Enter long when the forming bar closes above the highest high of the last
+// `breakout_bars` closed bars while ATR(`atr_period`) is positive.
+struct ScalperParams {
+    size_t atr_period{14}; // at least 2
+    size_t breakout_bars{5};
+    size_t min_bars{8}; // raised to breakout_bars + 1 if smaller
 };
 
 class Strategy5mScalper {
 public:
-    TradeDecision evaluate(const std::vector<Candle>& candles_5m);
+    explicit Strategy5mScalper(ScalperParams params = {});
+    const ScalperParams& params() const { return params_; }
+
+    TradeDecision evaluate(CandleSpan candles_5m);
+    // Same signal, but an entry of `size` must be fillable from the visible
+    // asks; the limit is placed at the deepest ask level it needs.
+    TradeDecision evaluate(CandleSpan candles_5m, const OrderBook& book, double size);
+
+private:
+    ScalperParams params_;
 };
 
+
+// Tick-by-tick form of Strategy5mScalper::evaluate. Closed bars go through
+// on_bar_close(), the forming bar through on_tick(); each is O(1) and the
+// decision matches evaluate() over the same bars.
+class ScalperStream {
+public:
+    explicit ScalperStream(ScalperParams params = {});
+    const ScalperParams& params() const { return params_; }
+
+    void reset();
+    // Rebuilds from a candle series whose last element is the forming bar.
+    void seed(CandleSpan candles_5m);
+    void on_bar_close(const Candle& bar);
+    TradeDecision on_tick(const Candle& forming) const;
+
+private:
+    ScalperParams params_;
+    RollingMean closed_tr_;  // true ranges of the closed bars inside the ATR window
+    RollingMax closed_high_; // breakout reference
+    double prev_close_{0.0};
+    size_t closed_{0};
+};
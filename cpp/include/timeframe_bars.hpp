@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "candle_series.hpp"
+#include "types.hpp"
+
+enum class Timeframe { M1, M3, M5, M15, M60 };
+constexpr size_t kTimeframeCount = 5;
+
+int timeframe_minutes(Timeframe tf);
+inline long long timeframe_ms(Timeframe tf) { return timeframe_minutes(tf) * 60'000LL; }
+const char* timeframe_name(Timeframe tf);
+// Start of the bucket holding ts_ms. Buckets sit on UTC minute multiples from
+// the epoch, as Upbit's own minute candles do (KST is a whole-hour offset).
+inline long long bar_open_ms(long long ts_ms, long long period_ms) {
+    return ts_ms - ((ts_ms % period_ms) + period_ms) % period_ms;
+}
+inline long long bar_open_ms(long long ts_ms, Timeframe tf) { return bar_open_ms(ts_ms, timeframe_ms(tf)); }
+
+// Merges aligned bars (oldest first, any shorter frame that divides `tf`)
+// into `tf` bars; the last one is partial if its bucket is.
+std::vector<Candle> resample(CandleSpan bars, Timeframe tf);
+
+// Aligned bars at every timeframe for one market, all fed by the same trades.
+// A trade in the forming bar's bucket updates it; one in a later bucket
+// closes it and opens the next at the bucket start, with the trade as its
+// open. Buckets without trades get no bar, and trades older than the forming
+// bar are ignored, so boundaries depend only on trade timestamps.
+class TimeframeBars {
+public:
+    static constexpr size_t kCapacity = 120;
+    using Series = CandleSeries<kCapacity>;
+
+    const Series& operator[](Timeframe tf) const { return series_[static_cast<size_t>(tf)]; }
+
+    // Replaces every series: `tf` with `bars` (last element = forming bar),
+    // the longer frames it divides with their resample, the rest emptied.
+    // Timestamps are moved to their bucket start (REST candles carry their
+    // last trade's).
+    void seed(Timeframe tf, CandleSpan bars);
+    // Folds closed bars fetched for a gap into `tf`: each replaces the bar of
+    // its bucket or is inserted in order. The touched buckets of the longer
+    // frames `tf` divides are rebuilt from it; shorter frames keep the gap.
+    void merge(Timeframe tf, CandleSpan bars);
+    void clear();
+    // Returns the frames whose forming bar closed, as bits 1 << Timeframe.
+    unsigned on_trade(long long ts_ms, double price, double volume);
+
+    static constexpr unsigned bit(Timeframe tf) { return 1u << static_cast<unsigned>(tf); }
+
+private:
+    std::array<Series, kTimeframeCount> series_{};
+};
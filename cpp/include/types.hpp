@@ -22,6 +22,9 @@ struct OrderRequest {
     std::string ord_type; // limit/price/market
     double price{};
     double volume{};
+    // Client order id ("identifier"); unique per account, so a retried post
+    // cannot place the order twice. Optional.
+    std::string identifier;
 };
 
 struct OrderResult {
@@ -35,3 +38,30 @@ struct OrderResult {
 struct CancelRequest {
     std::string uuid;
 };
+
+// Market-data events decoded straight from WebSocket frames; plain data, no heap.
+struct TradeTick {
+    char code[16]{};
+    long long ts_ms{};
+    long long sequential_id{};
+    double price{};
+    double volume{};
+    bool is_bid{false}; // buyer-initiated (ask_bid == "BID")
+};
+
+struct BookLevel {
+    double ask_price{};
+    double ask_size{};
+    double bid_price{};
+    double bid_size{};
+};
+
+struct OrderbookSnapshot {
+    static constexpr int kMaxLevels = 30;
+    char code[16]{};
+    long long ts_ms{};
+    double total_ask_size{};
+    double total_bid_size{};
+    int depth{0};
+    BookLevel levels[kMaxLevels]{};
+};
@@ -1,29 +1,84 @@
 #pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
+#include "jwt_signer.hpp"
+#include "order_venue.hpp"
+#include "rate_limiter.hpp"
 #include "types.hpp"
 
-class UpbitRestClient {
+class AsyncHttpClient;
+class HttpConnectionPool;
+struct HttpPoolStats;
+struct HttpRequest;
+struct HttpResponse;
+
+class UpbitRestClient : public OrderVenue {
 public:
-    explicit UpbitRestClient(const std::string& base_url = "https://api.upbit.com");
+    explicit UpbitRestClient(const std::string& base_url = default_base_url());
+    ~UpbitRestClient();
+
+    // Opens the keep-alive connection ahead of the first order.
+    bool warm_up();
+    HttpPoolStats connection_stats() const;
+    // Shared with callers that issue their own requests (e.g. the Qt bridge).
+    RateLimiter& rate_limiter() { return limiter_; }
 
     std::vector<std::string> get_markets_krw();
     std::vector<Ticker24h> get_tickers(const std::vector<std::string>& markets);
     std::vector<Candle> get_candles_minutes(const std::string& market, int unit, int count);
+    // Bars are oldest first and stamped with their bucket start. With to_ms
+    // set, only bars that open before it (Upbit's `to`), e.g. a gap's range.
+    std::future<std::vector<Candle>> get_candles_minutes_async(const std::string& market, int unit, int count,
+                                                               long long to_ms = 0);
+    // Fetches every market concurrently; results keep the order of `markets`.
+    std::vector<std::pair<std::string, std::vector<Candle>>> get_candles_minutes_batch(
+        const std::vector<std::string>& markets, int unit, int count);
+
+    OrderResult post_order(const OrderRequest& req) override;
+    OrderResult cancel_order(const CancelRequest& req) override;
 
-    OrderResult post_order(const OrderRequest& req);
-    OrderResult cancel_order(const CancelRequest& req);
+    // Non-blocking order calls through the shared async client; the callback
+    // runs on its worker thread (or inline when the request cannot be built).
+    using OrderCallback = std::function<void(OrderResult)>;
+    void post_order_async(const OrderRequest& req, OrderCallback cb);
+    void cancel_order_async(const CancelRequest& req, OrderCallback cb);
+    // GET /v1/order by uuid, or by client identifier when uuid is empty.
+    void get_order_async(const std::string& uuid, const std::string& identifier, OrderCallback cb);
 
     void set_credentials(std::string access_key, std::string secret_key);
 
     std::string build_authorization_token(const std::vector<std::pair<std::string, std::string>>& params = {}) const;
 
+    // UPBIT_REST_URL / UPBIT_WS_URL if set (e.g. a local mock_upbit), else
+    // the live exchange.
+    static std::string default_base_url();
+    static std::string default_ws_url();
+
+    // KRW-market price unit at `price`.
+    static double tick_size(double price);
     static double normalize_price(double price);
     static double normalize_volume(double price, double volume, bool is_buy, double min_notional = 5000.0);
     static double taker_fee_rate();
 
 private:
+    // Waits for a rate-limit token, then transfer().
+    HttpResponse perform(const HttpRequest& req);
+    HttpResponse transfer(const HttpRequest& req);
+    AsyncHttpClient& async_client();
+    OrderResult to_order_result(const HttpResponse& res) const;
+    bool build_post_order(const OrderRequest& req, HttpRequest& http) const;
+    bool build_order_query(const char* method, const std::string& uuid, const std::string& identifier,
+                           HttpRequest& http) const;
+
     std::string base_url_;
-    std::string access_key_;
-    std::string secret_key_;
+    JwtSigner signer_;
+    RateLimiter limiter_;
+    std::unique_ptr<HttpConnectionPool> pool_;
+    std::once_flag async_once_;
+    std::unique_ptr<AsyncHttpClient> async_;
 };
@@ -0,0 +1,19 @@
+#pragma once
+#include <string_view>
+#include "types.hpp"
+
+enum class WsMessageType { Invalid, Unknown, Trade, Orderbook };
+
+// DEFAULT uses the documented field names; SIMPLE is Upbit's abbreviated
+// key set ("ty", "cd", "tp", ...) requested with {"format":"SIMPLE"}.
+enum class WsFormat { Default, Simple };
+
+// Schema-specific decoder for Upbit public WebSocket frames. One forward
+// pass over the frame fills the POD structs directly; no DOM, no strings.
+class WsFrameDecoder {
+public:
+    // Fills `trade` or `book` depending on the frame's type field.
+    // Unknown covers well-formed frames we do not consume (status, ticker...).
+    static WsMessageType decode(std::string_view frame, TradeTick& trade, OrderbookSnapshot& book,
+                                WsFormat format = WsFormat::Default);
+};
@@ -0,0 +1,165 @@
+#include "async_http.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+constexpr long kIdlePollMs = 1'000;
+constexpr int kMaxRateLimitRetries = 3;
+}
+
+AsyncHttpClient::AsyncHttpClient(HttpConnectionPool& pool, RateLimiter& limiter, int max_in_flight)
+    : pool_(pool), limiter_(limiter), max_in_flight_(std::max(1, max_in_flight)) {
+    HttpConnectionPool::global_init();
+    multi_ = curl_multi_init();
+    if (multi_) {
+        curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(max_in_flight_));
+    }
+    worker_ = std::thread([this]() { run(); });
+}
+
+AsyncHttpClient::~AsyncHttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    if (multi_) curl_multi_wakeup(multi_);
+    if (worker_.joinable()) worker_.join();
+    if (multi_) curl_multi_cleanup(multi_);
+}
+
+std::future<HttpResponse> AsyncHttpClient::submit(HttpRequest req) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    auto future = promise->get_future();
+    submit(std::move(req), [promise](HttpResponse res) { promise->set_value(std::move(res)); });
+    return future;
+}
+
+void AsyncHttpClient::submit(HttpRequest req, Callback cb) {
+    bool rejected = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || !multi_) rejected = true;
+        else if (req.lane == RateLane::High) high_.push_back(Job{std::move(req), std::move(cb)});
+        else low_.push_back(Job{std::move(req), std::move(cb)});
+    }
+    if (rejected) {
+        HttpResponse res{};
+        res.error_message = "async http client unavailable";
+        if (cb) cb(std::move(res));
+        return;
+    }
+    curl_multi_wakeup(multi_);
+}
+
+void AsyncHttpClient::requeue(Job job) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (job.req.lane == RateLane::High) high_.push_front(std::move(job));
+    else low_.push_front(std::move(job));
+}
+
+long AsyncHttpClient::start_ready() {
+    long next_wait = kIdlePollMs;
+    std::array<bool, 4> blocked{};
+    std::vector<Job> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto* queue : {&high_, &low_}) {
+            for (auto it = queue->begin(); it != queue->end();) {
+                if (static_cast<int>(active_.size() + ready.size()) >= max_in_flight_) break;
+                const size_t g = static_cast<size_t>(it->req.group);
+                if (blocked[g]) { ++it; continue; }
+                const long wait = limiter_.try_acquire(it->req.group, it->req.lane);
+                if (wait > 0) {
+                    blocked[g] = true;
+                    next_wait = std::min(next_wait, wait);
+                    ++it;
+                    continue;
+                }
+                ready.push_back(std::move(*it));
+                it = queue->erase(it);
+            }
+        }
+    }
+
+    for (auto& job : ready) {
+        auto transfer = std::make_unique<Transfer>();
+        transfer->job = std::move(job);
+        transfer->curl = pool_.acquire();
+        if (!transfer->curl) {
+            transfer->response.error_message = "curl_easy_init failed";
+            if (transfer->job.cb) transfer->job.cb(std::move(transfer->response));
+            continue;
+        }
+        transfer->headers = pool_.prepare(transfer->curl, transfer->job.req, &transfer->response);
+        curl_multi_add_handle(multi_, transfer->curl);
+        CURL* key = transfer->curl;
+        active_.emplace(key, std::move(transfer));
+    }
+    return next_wait;
+}
+
+void AsyncHttpClient::finish(CURL* curl, CURLcode rc) {
+    auto it = active_.find(curl);
+    if (it == active_.end()) return;
+    std::unique_ptr<Transfer> transfer = std::move(it->second);
+    active_.erase(it);
+
+    curl_multi_remove_handle(multi_, curl);
+    pool_.record_transfer(curl, transfer->response);
+    if (rc != CURLE_OK) transfer->response.error_message = curl_easy_strerror(rc);
+    curl_slist_free_all(transfer->headers);
+    pool_.release(curl);
+
+    HttpResponse& res = transfer->response;
+    if (!res.remaining_req.empty()) limiter_.on_response(res.remaining_req);
+    if (res.status == 429) {
+        limiter_.on_rate_limited(transfer->job.req.group);
+        if (rc == CURLE_OK && ++transfer->job.attempts <= kMaxRateLimitRetries) {
+            requeue(std::move(transfer->job));
+            return;
+        }
+    }
+    if (transfer->job.cb) transfer->job.cb(std::move(res));
+}
+
+void AsyncHttpClient::run() {
+    if (!multi_) return;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) break;
+        }
+        const long wait = start_ready();
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        int left = 0;
+        bool finished_any = false;
+        while (CURLMsg* msg = curl_multi_info_read(multi_, &left)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            finish(msg->easy_handle, msg->data.result);
+            finished_any = true;
+        }
+        // a slot just freed up; start the next queued request before sleeping
+        if (finished_any) continue;
+
+        int numfds = 0;
+        curl_multi_poll(multi_, nullptr, 0, static_cast<int>(wait), &numfds);
+    }
+
+    // fail whatever is still pending so no future is left dangling
+    while (!active_.empty()) finish(active_.begin()->first, CURLE_ABORTED_BY_CALLBACK);
+    std::deque<Job> remaining;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        remaining.swap(high_);
+        remaining.insert(remaining.end(), std::make_move_iterator(low_.begin()), std::make_move_iterator(low_.end()));
+        low_.clear();
+    }
+    for (auto& job : remaining) {
+        HttpResponse res{};
+        res.error_message = "async http client stopped";
+        if (job.cb) job.cb(std::move(res));
+    }
+}
@@ -0,0 +1,423 @@
+#include "backtest.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include "indicators.hpp"
+#include "multi_market_engine.hpp"
+#include "order_manager.hpp"
+#include "risk_manager.hpp"
+
+namespace {
+
+constexpr char kUuidPrefix[] = "sim-";
+constexpr double kMinNotionalKrw = 5000.0;
+constexpr double kDust = 1e-8;            // volume quantum
+constexpr long long kDayMs = 24LL * 60 * 60 * 1000;
+constexpr long long kFiveMinutesMs = 5LL * 60 * 1000;
+
+OrderResult rejected(int status, const char* why) {
+    OrderResult r;
+    r.http_status = status;
+    r.error_message = why;
+    return r;
+}
+
+OrderRequest order(const std::string& market, const char* side, const char* ord_type, double price, double volume) {
+    OrderRequest req;
+    req.market = market;
+    req.side = side;
+    req.ord_type = ord_type;
+    req.price = price;
+    req.volume = volume;
+    return req;
+}
+
+bool same_params(const ScalperParams& a, const ScalperParams& b) {
+    return a.atr_period == b.atr_period && a.breakout_bars == b.breakout_bars && a.min_bars == b.min_bars;
+}
+
+std::uint64_t parse_uuid(const std::string& uuid) {
+    const size_t n = sizeof(kUuidPrefix) - 1;
+    if (uuid.compare(0, n, kUuidPrefix) != 0) return 0;
+    return std::strtoull(uuid.c_str() + n, nullptr, 10);
+}
+
+double percentile(std::vector<double>& v, double q) {
+    if (v.empty()) return 0.0;
+    const size_t k = std::min(v.size() - 1, static_cast<size_t>(q * static_cast<double>(v.size())));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+    return v[k];
+}
+
+// An order the backtester is waiting on, and the price it was decided at.
+struct Tracked {
+    std::uint64_t id{0};
+    std::string uuid;
+    double ref_price{};
+    long long submitted_ms{};
+    bool filled{false};
+    bool take_profit{false};
+};
+
+} // namespace
+
+SimulatedExchange::SimulatedExchange(FillModel model) : model_(model) {}
+
+void SimulatedExchange::reset() {
+    orders_.clear();
+    next_id_ = 1;
+    now_ms_ = 0;
+    last_price_ = 0.0;
+    submitted_krw_ = 0.0;
+}
+
+OrderResult SimulatedExchange::post_order(const OrderRequest& req) {
+    const bool is_buy = req.side == "buy" || req.side == "bid";
+    Working o{};
+    o.is_buy = is_buy;
+    o.price = req.price;
+    o.live_ms = now_ms_ + model_.latency_ms;
+    double notional = 0.0;
+    if (req.ord_type == "limit") {
+        if (req.price <= 0.0 || req.volume <= 0.0) return rejected(400, "invalid_price_or_volume");
+        o.kind = Kind::Limit;
+        o.remaining = req.volume;
+        notional = req.price * req.volume;
+    } else if (req.ord_type == "price" && is_buy) {
+        if (req.price <= 0.0) return rejected(400, "invalid_price");
+        o.kind = Kind::MarketBuy;
+        o.remaining = req.price;
+        notional = req.price;
+    } else if (req.ord_type == "market" && !is_buy) {
+        if (req.volume <= 0.0) return rejected(400, "invalid_volume");
+        o.kind = Kind::MarketSell;
+        o.remaining = req.volume;
+        notional = (req.price > 0.0 ? req.price : last_price_) * req.volume;
+    } else {
+        return rejected(400, "invalid_ord_type");
+    }
+    o.id = next_id_++;
+    orders_.push_back(o);
+    submitted_krw_ += notional;
+
+    OrderResult r;
+    r.accepted = true;
+    r.http_status = 201;
+    r.uuid = kUuidPrefix + std::to_string(o.id);
+    return r;
+}
+
+OrderResult SimulatedExchange::cancel_order(const CancelRequest& req) {
+    const std::uint64_t id = parse_uuid(req.uuid);
+    const auto it = std::find_if(orders_.begin(), orders_.end(), [id](const Working& o) { return o.id == id; });
+    if (id == 0 || it == orders_.end()) return rejected(404, "order_not_found");
+    orders_.erase(it);
+    OrderResult r;
+    r.accepted = true;
+    r.http_status = 200;
+    r.uuid = req.uuid;
+    return r;
+}
+
+bool SimulatedExchange::is_open(std::uint64_t order_id) const {
+    return std::any_of(orders_.begin(), orders_.end(), [order_id](const Working& o) { return o.id == order_id; });
+}
+
+void SimulatedExchange::fill(Working& o, const TradeRecord& t, double price, double volume, std::vector<SimFill>& fills) {
+    SimFill f;
+    f.order_id = o.id;
+    f.is_buy = o.is_buy;
+    f.price = price;
+    f.volume = volume;
+    f.fee = price * volume * model_.fee_rate;
+    f.ts_ms = t.ts_ms;
+    o.remaining = o.kind == Kind::MarketBuy ? 0.0 : o.remaining - volume;
+    f.remaining = std::max(0.0, o.remaining);
+    fills.push_back(f);
+}
+
+void SimulatedExchange::on_trade(const TradeRecord& t, std::vector<SimFill>& fills) {
+    now_ms_ = t.ts_ms;
+    last_price_ = t.price;
+    // erase in place so the survivors keep time priority
+    size_t kept = 0;
+    for (size_t i = 0; i < orders_.size(); ++i) {
+        Working& o = orders_[i];
+        if (t.ts_ms >= o.live_ms) {
+            switch (o.kind) {
+            case Kind::MarketBuy:
+                fill(o, t, t.price, o.remaining / t.price, fills);
+                break;
+            case Kind::MarketSell:
+                fill(o, t, t.price, o.remaining, fills);
+                break;
+            case Kind::Limit: {
+                const bool crosses = o.is_buy ? t.price <= o.price : t.price >= o.price;
+                const bool through = o.is_buy ? t.price < o.price : t.price > o.price;
+                if (!o.arrived) {
+                    // marketable on arrival: takes at the print
+                    if (crosses) fill(o, t, t.price, o.remaining, fills);
+                } else if (through) {
+                    fill(o, t, o.price, o.remaining, fills);
+                } else if (crosses && model_.fill_on_touch) {
+                    fill(o, t, o.price, std::min(o.remaining, t.volume), fills);
+                }
+                o.arrived = true;
+                break;
+            }
+            }
+        }
+        if (o.remaining > kDust * 1e-3) orders_[kept++] = o;
+    }
+    orders_.resize(kept);
+}
+
+Backtester::Backtester(BacktestConfig config)
+    : config_(config), state_(std::make_unique<MarketState>()), signal_params_(config.scalper) {
+    state_->signal = ScalperStream(signal_params_);
+}
+
+Backtester::~Backtester() = default;
+
+BacktestReport Backtester::run(const std::string& market, CandleSpan warmup_5m, const TradeRecord* trades, size_t n) {
+    BacktestReport r;
+    r.market = market;
+    r.prints = n;
+    r.final_equity = config_.initial_krw;
+    if (n == 0) return r;
+    r.first_ts_ms = trades[0].ts_ms;
+    r.last_ts_ms = trades[n - 1].ts_ms;
+
+    SimulatedExchange& exchange = exchange_;
+    exchange.reset();
+    exchange.set_model(config_.fill);
+    // holds nothing between orders with logging and tracking off, so free to build
+    OrderManager orders(exchange, config_.fill.fee_rate, kMinNotionalKrw);
+    orders.set_logging(false);
+    RiskManager risk;
+
+    MarketState& state = *state_;
+    state.code = market;
+    state.book.clear();
+    state.position = MarketPosition{};
+    state.pending_orders.clear();
+    state.last_decision = TradeDecision{};
+    state.last_trade_ms = 0;
+    if (!same_params(signal_params_, config_.scalper)) {
+        signal_params_ = config_.scalper;
+        state.signal = ScalperStream(signal_params_);
+    }
+    // seed() rebuilds the bars and the signal
+    if (!warmup_5m.empty()) {
+        state.seed(warmup_5m);
+    } else {
+        const double p = trades[0].price;
+        const Candle first{bar_open_ms(trades[0].ts_ms - kFiveMinutesMs, Timeframe::M5), p, p, p, p, 0.0};
+        state.seed(CandleSpan(&first, 1));
+    }
+
+    double cash = config_.initial_krw;
+    double peak = cash;
+    double day_start_equity = cash;
+    long long day = trades[0].ts_ms / kDayMs;
+    bool halted = false;
+
+    Tracked entry, exit;
+    double stop_px = 0.0, atr_at_entry = 0.0;
+    long long entry_ts = 0;
+    double trip_gross = 0.0, trip_net = 0.0;
+
+    std::vector<SimFill>& fills = fills_;
+    std::vector<double>& slippage = slippage_;
+    slippage.clear();
+    TradeTick tick{};
+
+    auto submit = [&](Tracked& slot, const OrderRequest& req, double ref_price, long long now) {
+        const OrderResult res = orders.place_order(req);
+        if (!res.accepted) return;
+        slot = Tracked{};
+        slot.id = exchange.last_order_id();
+        slot.uuid = res.uuid;
+        slot.ref_price = ref_price;
+        slot.submitted_ms = now;
+        ++r.orders;
+    };
+    auto cancel = [&](Tracked& slot) {
+        if (orders.cancel_order(CancelRequest{slot.uuid}).accepted) ++r.orders_cancelled;
+        slot.id = 0;
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        const TradeRecord& t = trades[i];
+
+        fills.clear();
+        exchange.on_trade(t, fills);
+        for (const SimFill& f : fills) {
+            Tracked& slot = f.order_id == entry.id ? entry : exit;
+            if (!slot.filled) ++r.orders_filled;
+            slot.filled = true;
+            const double side = f.is_buy ? 1.0 : -1.0;
+            slippage.push_back(side * (f.price - slot.ref_price) / slot.ref_price * 1e4);
+            r.fees += f.fee;
+            if (f.is_buy) {
+                if (state.position.qty <= kDust) {
+                    entry_ts = f.ts_ms;
+                    trip_gross = trip_net = 0.0;
+                }
+                cash -= f.price * f.volume + f.fee;
+                trip_gross -= f.price * f.volume;
+                trip_net -= f.price * f.volume + f.fee;
+                r.volume_filled += f.price * f.volume;
+                state.on_fill(true, f.price, f.volume);
+                stop_px = state.position.avg_price - config_.stop_loss_atr * atr_at_entry;
+            } else {
+                // the exchange sells what it is told; never book more than we hold
+                const double volume = std::min(f.volume, state.position.qty);
+                const double fee = f.fee * (f.volume > 0.0 ? volume / f.volume : 0.0);
+                cash += f.price * volume - fee;
+                trip_gross += f.price * volume;
+                trip_net += f.price * volume - fee;
+                r.volume_filled += f.price * f.volume;
+                state.on_fill(false, f.price, volume);
+                if (state.position.qty <= kDust) {
+                    ++r.round_trips;
+                    if (trip_net > 0.0) ++r.wins;
+                    r.gross_pnl += trip_gross;
+                }
+            }
+        }
+
+        tick.ts_ms = t.ts_ms;
+        tick.sequential_id = t.sequential_id;
+        tick.price = t.price;
+        tick.volume = t.volume;
+        tick.is_bid = t.is_bid != 0;
+        state.on_trade(tick);
+
+        const double equity = cash + state.position.qty * t.price;
+        peak = std::max(peak, equity);
+        if (peak > 0.0) r.max_drawdown = std::max(r.max_drawdown, (peak - equity) / peak);
+        if (t.ts_ms / kDayMs != day) {
+            day = t.ts_ms / kDayMs;
+            day_start_equity = equity;
+            halted = false;
+        }
+        if (!halted && day_start_equity > 0.0) {
+            halted = risk.daily_stop_triggered((equity - day_start_equity) / day_start_equity, config_.daily_stop_ratio);
+        }
+
+        if (entry.id && !exchange.is_open(entry.id)) entry.id = 0;
+        if (exit.id && !exchange.is_open(exit.id)) exit.id = 0;
+
+        if (entry.id) {
+            if (t.ts_ms - entry.submitted_ms >= config_.entry_ttl_ms) cancel(entry);
+            continue;
+        }
+
+        const double qty = state.position.qty;
+        if (qty > kDust) {
+            if (exit.id && !exit.take_profit) continue; // market sell on its way
+            const bool stop = t.price <= stop_px;
+            const bool timeout = t.ts_ms - entry_ts >= config_.max_hold_ms;
+            if (stop || timeout) {
+                if (exit.id) cancel(exit);
+                submit(exit, order(market, "sell", "market", t.price, qty), t.price, t.ts_ms);
+            } else if (!exit.id) {
+                const double target = state.position.avg_price + config_.take_profit_atr * atr_at_entry;
+                submit(exit, order(market, "sell", "limit", target, qty), UpbitRestClient::normalize_price(target), t.ts_ms);
+                exit.take_profit = true;
+            }
+            continue;
+        }
+
+        if (exit.id) cancel(exit); // leftover of an oversized sell
+        const TradeDecision& d = state.last_decision;
+        if (halted || !d.enter_long || d.limit_price <= 0.0) continue;
+        const double atr = batch_sma_atr(state.candles_5m(), state.signal.params().atr_period);
+        const double size = risk.calc_position_size(equity, atr, config_.risk_per_trade);
+        const double krw = std::min({size * d.limit_price, config_.max_order_krw, cash / (1.0 + config_.fill.fee_rate)});
+        if (krw < kMinNotionalKrw) continue;
+        atr_at_entry = atr;
+        submit(entry, order(market, "buy", "limit", d.limit_price, krw / d.limit_price), d.limit_price, t.ts_ms);
+    }
+
+    const double last = trades[n - 1].price;
+    r.final_equity = cash + state.position.qty * last;
+    r.net_pnl = r.final_equity - config_.initial_krw;
+    r.volume_ordered = exchange.submitted_krw();
+    if (!slippage.empty()) {
+        double sum = 0.0;
+        for (double s : slippage) sum += s;
+        r.slippage_mean_bps = sum / static_cast<double>(slippage.size());
+        r.slippage_p50_bps = percentile(slippage, 0.50);
+        r.slippage_p95_bps = percentile(slippage, 0.95);
+    }
+    return r;
+}
+
+std::vector<std::string> replay_markets(const std::string& root) {
+    std::vector<std::string> out;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        if (std::filesystem::exists(entry.path() / "trades.ticks", ec)) out.push_back(entry.path().filename().string());
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+bool open_replay(const MarketArchive& archive, const std::string& market, long long from_ms, long long to_ms,
+                 ReplayData& out, std::string* error) {
+    if (!out.trades.open_read_only(archive.trade_path(market), error)) return false;
+    out.begin = from_ms > 0 ? out.trades.lower_bound(from_ms) : 0;
+    out.end = to_ms > 0 ? out.trades.lower_bound(to_ms) : out.trades.size();
+    if (out.begin >= out.end) {
+        if (error) *error = market + ": no archived trades in range";
+        return false;
+    }
+    // warm-up bars are optional: without them the strategy starts cold
+    out.warmup = CandleSpan();
+    if (out.candles_5m.open_read_only(archive.candle_path(market, 5))) {
+        const long long first = out.trades[out.begin].ts_ms;
+        out.warmup = candle_range(out.candles_5m, first - static_cast<long long>(MarketState::kMaxCandles) * kFiveMinutesMs, first);
+    }
+    return true;
+}
+
+std::vector<TradeRecord> synthetic_tape(long long start_ms, int days, double start_price, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::exponential_distribution<double> gap_ms(1.0 / 2000.0);
+    std::normal_distribution<double> step(0.0, 4e-4);
+    std::lognormal_distribution<double> size(-3.0, 1.5);
+    std::uniform_int_distribution<int> regime_len(500, 5000);
+    std::uniform_int_distribution<int> regime(-1, 1);
+
+    std::vector<TradeRecord> out;
+    out.reserve(static_cast<size_t>(days) * (kDayMs / 2000 + 1));
+    const long long end_ms = start_ms + static_cast<long long>(days) * kDayMs;
+    double px = start_price;
+    double drift = 0.0;
+    int left = 0;
+    long long ts = start_ms;
+    long long seq = 1;
+    while (true) {
+        ts += 1 + static_cast<long long>(gap_ms(rng));
+        if (ts >= end_ms) break;
+        if (left-- <= 0) {
+            left = regime_len(rng);
+            drift = 1e-5 * regime(rng);
+        }
+        const double prev = px;
+        px *= std::exp(drift + step(rng));
+        TradeRecord t;
+        t.ts_ms = ts;
+        t.sequential_id = seq++;
+        t.price = UpbitRestClient::normalize_price(px);
+        if (t.price <= 0.0) t.price = px;
+        t.volume = size(rng);
+        t.is_bid = px >= prev ? 1 : 0;
+        out.push_back(t);
+    }
+    return out;
+}
@@ -0,0 +1,157 @@
+// Replays archived trades (or a synthetic tape) through the scalper with a
+// simulated matcher, one market per worker thread.
+//
+//   backtest [--archive DIR] [--from-ms T] [--to-ms T] [--synthetic DAYS]
+//            [--latency-ms N] [--touch] [--max-order-krw X] [--threads N] [MARKET...]
+//
+// With an archive (--archive or UPBIT_ARCHIVE_DIR) and no markets, every
+// archived market is replayed.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "backtest.hpp"
+
+namespace {
+
+struct Options {
+    std::string archive_dir;
+    long long from_ms{0};
+    long long to_ms{0};
+    int synthetic_days{0};
+    int threads{0};
+    BacktestConfig config;
+    std::vector<std::string> markets;
+};
+
+bool parse(int argc, char** argv, Options& opt) {
+    if (const char* dir = std::getenv("UPBIT_ARCHIVE_DIR")) opt.archive_dir = dir;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto value = [&]() -> const char* {
+            ++i;
+            return next;
+        };
+        if (std::strcmp(arg, "--touch") == 0) {
+            opt.config.fill.fill_on_touch = true;
+        } else if (arg[0] == '-' && arg[1] == '-' && !next) {
+            std::cerr << "backtest: " << arg << " needs a value\n";
+            return false;
+        } else if (std::strcmp(arg, "--archive") == 0) {
+            opt.archive_dir = value();
+        } else if (std::strcmp(arg, "--from-ms") == 0) {
+            opt.from_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--to-ms") == 0) {
+            opt.to_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--synthetic") == 0) {
+            opt.synthetic_days = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--latency-ms") == 0) {
+            opt.config.fill.latency_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--max-order-krw") == 0) {
+            opt.config.max_order_krw = std::strtod(value(), nullptr);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            opt.threads = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (arg[0] == '-') {
+            std::cerr << "backtest: unknown option " << arg << '\n';
+            return false;
+        } else {
+            opt.markets.emplace_back(arg);
+        }
+    }
+    return true;
+}
+
+void print(const BacktestReport& r) {
+    const double days = static_cast<double>(r.last_ts_ms - r.first_ts_ms) / 86'400'000.0;
+    const double win = r.round_trips ? 100.0 * static_cast<double>(r.wins) / static_cast<double>(r.round_trips) : 0.0;
+    std::printf("%-12s prints=%zu days=%.1f orders=%zu filled=%.1f%% vol_filled=%.1f%% cancelled=%zu trips=%zu win=%.1f%%"
+                " gross=%.0f fees=%.0f net=%.0f dd=%.2f%% slip_bps mean=%.2f p50=%.2f p95=%.2f\n",
+                r.market.c_str(), r.prints, days, r.orders, 100.0 * r.fill_rate(), 100.0 * r.volume_fill_rate(),
+                r.orders_cancelled, r.round_trips, win, r.gross_pnl, r.fees, r.net_pnl, 100.0 * r.max_drawdown,
+                r.slippage_mean_bps, r.slippage_p50_bps, r.slippage_p95_bps);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse(argc, argv, opt)) return 2;
+
+    std::unique_ptr<MarketArchive> archive;
+    if (opt.synthetic_days <= 0) {
+        if (opt.archive_dir.empty()) {
+            std::cerr << "backtest: no archive (set --archive or UPBIT_ARCHIVE_DIR) and no --synthetic\n";
+            return 2;
+        }
+        archive = std::make_unique<MarketArchive>(opt.archive_dir);
+        if (opt.markets.empty()) opt.markets = replay_markets(opt.archive_dir);
+    } else if (opt.markets.empty()) {
+        opt.markets = {"SYN-A", "SYN-B", "SYN-C", "SYN-D"};
+    }
+    if (opt.markets.empty()) {
+        std::cerr << "backtest: no markets\n";
+        return 2;
+    }
+
+    std::vector<BacktestReport> reports(opt.markets.size());
+    std::vector<std::string> errors(opt.markets.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        Backtester bt(opt.config);
+        for (size_t i = next++; i < opt.markets.size(); i = next++) {
+            const std::string& market = opt.markets[i];
+            if (archive) {
+                ReplayData data;
+                if (!open_replay(*archive, market, opt.from_ms, opt.to_ms, data, &errors[i])) continue;
+                reports[i] = bt.run(market, data.warmup, data.trades.data() + data.begin, data.end - data.begin);
+            } else {
+                const auto tape = synthetic_tape(opt.from_ms > 0 ? opt.from_ms : 1'700'000'000'000LL, opt.synthetic_days,
+                                                 10'000.0 * static_cast<double>(i + 1), static_cast<unsigned>(i + 1));
+                reports[i] = bt.run(market, CandleSpan(), tape.data(), tape.size());
+            }
+        }
+    };
+
+    const auto started = std::chrono::steady_clock::now();
+    int n = opt.threads > 0 ? opt.threads : static_cast<int>(std::thread::hardware_concurrency());
+    n = std::max(1, std::min(n, static_cast<int>(opt.markets.size())));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < n; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    size_t prints = 0, orders = 0, filled = 0, trips = 0, wins = 0;
+    double net = 0.0, fees = 0.0;
+    int rc = 0;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        if (!errors[i].empty()) {
+            std::cerr << "backtest: " << errors[i] << '\n';
+            rc = 1;
+            continue;
+        }
+        const BacktestReport& r = reports[i];
+        print(r);
+        prints += r.prints;
+        orders += r.orders;
+        filled += r.orders_filled;
+        trips += r.round_trips;
+        wins += r.wins;
+        net += r.net_pnl;
+        fees += r.fees;
+    }
+    std::printf("total orders=%zu filled=%.1f%% trips=%zu win=%.1f%% fees=%.0f net=%.0f\n", orders,
+                orders ? 100.0 * static_cast<double>(filled) / static_cast<double>(orders) : 0.0, trips,
+                trips ? 100.0 * static_cast<double>(wins) / static_cast<double>(trips) : 0.0, fees, net);
+    std::printf("replayed %zu prints in %.2fs (%.1fM prints/s, %d threads)\n", prints, secs,
+                secs > 0.0 ? static_cast<double>(prints) / secs / 1e6 : 0.0, n);
+    return rc;
+}
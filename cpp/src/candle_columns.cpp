@@ -0,0 +1,69 @@
+#include "candle_columns.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "simd_kernels.hpp"
+
+void CandleColumns::reserve(size_t n) {
+    ts_ms.reserve(n);
+    open.reserve(n);
+    high.reserve(n);
+    low.reserve(n);
+    close.reserve(n);
+    volume.reserve(n);
+}
+
+void CandleColumns::clear() {
+    ts_ms.clear();
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    volume.clear();
+}
+
+void CandleColumns::push_back(const Candle& c) {
+    ts_ms.push_back(c.ts_ms);
+    open.push_back(c.open);
+    high.push_back(c.high);
+    low.push_back(c.low);
+    close.push_back(c.close);
+    volume.push_back(c.volume);
+}
+
+void CandleColumns::assign(CandleSpan c) {
+    clear();
+    reserve(c.size());
+    for (const Candle& bar : c) push_back(bar);
+}
+
+Candle CandleColumns::row(size_t i) const {
+    Candle c{};
+    c.ts_ms = ts_ms[i];
+    c.open = open[i];
+    c.high = high[i];
+    c.low = low[i];
+    c.close = close[i];
+    c.volume = volume[i];
+    return c;
+}
+
+double columns_sma_atr(const CandleColumns& c, size_t n) {
+    if (n == 0 || c.size() < n + 1) return 0.0;
+    const size_t from = c.size() - n - 1;
+    return simd_sum_true_ranges(c.high.data() + from, c.low.data() + from, c.close.data() + from, n + 1) /
+           static_cast<double>(n);
+}
+
+double columns_highest_high(const CandleColumns& c, size_t begin, size_t end) {
+    end = std::min(end, c.size());
+    if (begin >= end) return -std::numeric_limits<double>::infinity();
+    return simd_max(c.high.data() + begin, end - begin);
+}
+
+double columns_realized_vol(const CandleColumns& c, size_t n) {
+    if (c.size() < 2) return 0.0;
+    const size_t returns = std::min(n, c.size() - 1);
+    const size_t from = c.size() - returns - 1;
+    return std::sqrt(simd_sum_sq_log_returns(c.close.data() + from, returns + 1) / static_cast<double>(returns));
+}
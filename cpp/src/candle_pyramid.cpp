@@ -0,0 +1,164 @@
+#include "candle_pyramid.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kMaxLevels = 16;
+
+} // namespace
+
+CandlePyramid::CandlePyramid() : levels_(1), first_bucket_(1, 0) {}
+
+void CandlePyramid::merge_into(Candle& into, const Candle& c) {
+    into.high = std::max(into.high, c.high);
+    into.low = std::min(into.low, c.low);
+    into.close = c.close;
+    into.volume += c.volume;
+}
+
+Candle CandlePyramid::bucket_from_below(size_t level, size_t bucket) const {
+    const std::deque<Candle>& below = levels_[level - 1];
+    const size_t lo = std::max(bucket << kFanoutBits, first_bucket_[level - 1]) - first_bucket_[level - 1];
+    const size_t hi = std::min((bucket + 1) << kFanoutBits, first_bucket_[level - 1] + below.size())
+            - first_bucket_[level - 1];
+    Candle out = below[lo];
+    for (size_t i = lo + 1; i < hi; ++i) merge_into(out, below[i]);
+    return out;
+}
+
+// Adds levels until the top one is a single bucket.
+void CandlePyramid::grow() {
+    while (levels_.back().size() > 1 && levels_.size() < kMaxLevels) {
+        const std::deque<Candle>& below = levels_.back();
+        const size_t below_first = first_bucket_.back();
+        std::deque<Candle> level;
+        const size_t first = below_first >> kFanoutBits;
+        for (size_t i = 0; i < below.size(); ++i) {
+            if (((below_first + i) >> kFanoutBits) == first + level.size()) level.push_back(below[i]);
+            else merge_into(level.back(), below[i]);
+        }
+        levels_.push_back(std::move(level));
+        first_bucket_.push_back(first);
+    }
+}
+
+void CandlePyramid::assign(CandleSpan bars) {
+    clear();
+    levels_[0].assign(bars.begin(), bars.end());
+    grow();
+}
+
+void CandlePyramid::push_back(const Candle& c) {
+    levels_[0].push_back(c);
+    const size_t pos = base_ + levels_[0].size() - 1;
+    for (size_t l = 1; l < levels_.size(); ++l) {
+        std::deque<Candle>& level = levels_[l];
+        if ((pos >> (kFanoutBits * l)) == first_bucket_[l] + level.size()) level.push_back(c);
+        else merge_into(level.back(), c);
+    }
+    grow();
+}
+
+void CandlePyramid::set_back(const Candle& c) {
+    if (empty()) {
+        push_back(c);
+        return;
+    }
+    levels_[0].back() = c;
+    // a rewrite may lower a high or raise a low, so rebuild rather than merge
+    for (size_t l = 1; l < levels_.size(); ++l) {
+        levels_[l].back() = bucket_from_below(l, first_bucket_[l] + levels_[l].size() - 1);
+    }
+}
+
+void CandlePyramid::pop_front(size_t n) {
+    n = std::min(n, size());
+    if (n == size()) {
+        clear();
+        return;
+    }
+    levels_[0].erase(levels_[0].begin(), levels_[0].begin() + static_cast<std::ptrdiff_t>(n));
+    base_ += n;
+    first_bucket_[0] = base_;
+    for (size_t l = 1; l < levels_.size(); ++l) {
+        const size_t first = base_ >> (kFanoutBits * l);
+        std::deque<Candle>& level = levels_[l];
+        level.erase(level.begin(), level.begin() + static_cast<std::ptrdiff_t>(first - first_bucket_[l]));
+        first_bucket_[l] = first;
+        // the front bucket lost its oldest bars
+        level.front() = bucket_from_below(l, first);
+    }
+}
+
+void CandlePyramid::pop_back(size_t n) {
+    n = std::min(n, size());
+    if (n == size()) {
+        clear();
+        return;
+    }
+    levels_[0].resize(size() - n);
+    const size_t last = base_ + size() - 1;
+    for (size_t l = 1; l < levels_.size(); ++l) {
+        const size_t bucket = last >> (kFanoutBits * l);
+        levels_[l].resize(bucket - first_bucket_[l] + 1);
+        // the back bucket lost its newest bars
+        levels_[l].back() = bucket_from_below(l, bucket);
+    }
+}
+
+void CandlePyramid::clear() {
+    levels_.assign(1, {});
+    first_bucket_.assign(1, 0);
+    base_ = 0;
+}
+
+size_t CandlePyramid::lower_bound(long long ts_ms) const {
+    const auto it = std::lower_bound(levels_[0].begin(), levels_[0].end(), ts_ms,
+                                     [](const Candle& c, long long ts) { return c.ts_ms < ts; });
+    return static_cast<size_t>(it - levels_[0].begin());
+}
+
+Candle CandlePyramid::merged(size_t first, size_t last) const {
+    Candle out;
+    const size_t end = base_ + std::min(last, size());
+    size_t pos = base_ + first;
+    bool any = false;
+    while (pos < end) {
+        // the coarsest stored bucket that starts here and fits
+        for (size_t l = levels_.size() - 1;; --l) {
+            const size_t bucket = pos >> (kFanoutBits * l);
+            const size_t start = std::max(bucket << (kFanoutBits * l), base_);
+            const size_t stop = std::min((bucket + 1) << (kFanoutBits * l), base_ + size());
+            if (l == 0 || (start == pos && stop <= end)) {
+                const Candle& c = levels_[l][bucket - first_bucket_[l]];
+                if (any) merge_into(out, c);
+                else out = c;
+                any = true;
+                pos = stop;
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+void CandlePyramid::collect(size_t level, size_t first, size_t last, std::vector<CandleBucket>& out) const {
+    out.clear();
+    level = std::min(level, levels_.size() - 1);
+    const size_t bits = kFanoutBits * level;
+    const size_t end = base_ + std::min(last, size());
+    size_t pos = base_ + first;
+    while (pos < end) {
+        const size_t bucket = pos >> bits;
+        const size_t start = std::max(bucket << bits, base_);
+        const size_t stop = std::min((bucket + 1) << bits, base_ + size());
+        const size_t next = std::min(stop, end);
+        CandleBucket b;
+        b.first = pos - base_;
+        b.count = next - pos;
+        b.bar = start == pos && stop <= end ? levels_[level][bucket - first_bucket_[level]]
+                                            : merged(pos - base_, next - base_);
+        out.push_back(b);
+        pos = next;
+    }
+}
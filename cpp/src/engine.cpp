@@ -1,7 +1,11 @@
 #include "engine.hpp"
+#include "latency_histogram.hpp"
+#include "market_archive.hpp"
+#include "multi_market_engine.hpp"
 #include <vector>
 #include <utility>
 #include <cstdlib>
+#include <mutex>
 
 Engine::Engine()
     : rest_(),
@@ -9,30 +13,77 @@ Engine::Engine()
       strategy_(),
       risk_(),
       order_mgr_(rest_) {
+    order_mgr_.set_tracker(&orders_);
     if (const char* access = std::getenv("UPBIT_ACCESS_KEY")) {
         if (const char* secret = std::getenv("UPBIT_SECRET_KEY")) {
             rest_.set_credentials(access, secret);
         }
     }
+    if (const char* dir = std::getenv("UPBIT_ARCHIVE_DIR"); dir && *dir) {
+        archive_ = std::make_unique<MarketArchive>(dir);
+    }
+    rest_.warm_up();
 }
 
+Engine::~Engine() = default;
+
 int Engine::run_once() {
     auto markets = rest_.get_markets_krw();
     auto tickers = rest_.get_tickers(markets);
 
-    std::vector<std::pair<std::string, std::vector<Candle>>> m1;
-    for (const auto& m : markets) {
-        m1.push_back({m, rest_.get_candles_minutes(m, 1, 60)});
-    }
+    auto m1 = fetch_candles_cached(rest_, archive_.get(), markets, 1, 60);
     auto market = selector_.select_top_market(tickers, m1);
     if (market.empty()) return 1;
 
-    auto c5 = rest_.get_candles_minutes(market, 5, 50);
-    auto decision = strategy_.evaluate(c5);
+    auto c5 = fetch_candles_cached(rest_, archive_.get(), {market}, 5, 50);
+    TradeDecision decision;
+    {
+        LatencySpan span(LatencyStage::Decision);
+        decision = strategy_.evaluate(c5.front().second);
+    }
     if (decision.enter_long) {
-        OrderRequest req{market, "buy", "limit", decision.limit_price, 0.001};
+        OrderRequest req;
+        req.market = market;
+        req.side = "buy";
+        req.ord_type = "limit";
+        req.price = decision.limit_price;
+        req.volume = 0.001;
         auto res = order_mgr_.place_order(req);
         return res.accepted ? 0 : 2;
     }
     return 0;
 }
+
+int Engine::run_once_multi(size_t top_n, double order_krw) {
+    auto markets = rest_.get_markets_krw();
+    auto tickers = rest_.get_tickers(markets);
+
+    auto m1 = fetch_candles_cached(rest_, archive_.get(), markets, 1, 60);
+    auto top = selector_.select_top_markets(tickers, m1, top_n);
+    if (top.empty()) return 1;
+
+    MultiMarketEngine shards(top);
+    for (auto& [market, c5] : fetch_candles_cached(rest_, archive_.get(), top, 5, 50)) {
+        shards.seed_candles(market, std::move(c5));
+    }
+
+    std::mutex entries_mutex;
+    std::vector<OrderRequest> entries;
+    shards.evaluate_all(order_krw, [&](const MarketState& state, const TradeDecision& decision) {
+        if (!decision.enter_long || decision.limit_price <= 0.0) return;
+        OrderRequest req;
+        req.market = state.code;
+        req.side = "buy";
+        req.ord_type = "limit";
+        req.price = decision.limit_price;
+        req.volume = order_krw / decision.limit_price;
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        entries.push_back(std::move(req));
+    });
+
+    int rc = 0;
+    for (const auto& req : entries) {
+        if (!order_mgr_.place_order(req).accepted) rc = 2;
+    }
+    return rc;
+}
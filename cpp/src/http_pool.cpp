@@ -0,0 +1,178 @@
+#include "http_pool.hpp"
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+constexpr long kConnectTimeoutMs = 3'000;
+constexpr long kRequestTimeoutMs = 10'000;
+
+size_t write_callback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    if (!userdata) return 0;
+    auto* out = static_cast<std::string*>(userdata);
+    out->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+size_t header_callback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    const size_t len = size * nitems;
+    static constexpr char kName[] = "remaining-req:";
+    constexpr size_t kNameLen = sizeof(kName) - 1;
+    if (!userdata || len <= kNameLen) return len;
+    for (size_t i = 0; i < kNameLen; ++i) {
+        if (std::tolower(static_cast<unsigned char>(buffer[i])) != kName[i]) return len;
+    }
+    auto* out = static_cast<HttpResponse*>(userdata);
+    size_t begin = kNameLen;
+    size_t end = len;
+    while (begin < end && buffer[begin] == ' ') ++begin;
+    while (end > begin && (buffer[end - 1] == '\r' || buffer[end - 1] == '\n')) --end;
+    out->remaining_req.assign(buffer + begin, end - begin);
+    return len;
+}
+
+} // namespace
+
+void HttpConnectionPool::global_init() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        std::atexit([]() { curl_global_cleanup(); });
+    });
+}
+
+HttpConnectionPool::HttpConnectionPool(size_t max_idle_handles) : max_idle_(max_idle_handles) {
+    global_init();
+    share_ = curl_share_init();
+    if (share_) {
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HttpConnectionPool::lock_share);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HttpConnectionPool::unlock_share);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        // the connection cache is not shared: libcurl does not support sharing live
+        // connections between concurrent threads, so each pooled handle keeps its own
+    }
+}
+
+HttpConnectionPool::~HttpConnectionPool() {
+    for (CURL* curl : idle_) curl_easy_cleanup(curl);
+    idle_.clear();
+    if (share_) curl_share_cleanup(share_);
+}
+
+void HttpConnectionPool::lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    auto* self = static_cast<HttpConnectionPool*>(userptr);
+    self->share_locks_[static_cast<size_t>(data)].lock();
+}
+
+void HttpConnectionPool::unlock_share(CURL*, curl_lock_data data, void* userptr) {
+    auto* self = static_cast<HttpConnectionPool*>(userptr);
+    self->share_locks_[static_cast<size_t>(data)].unlock();
+}
+
+CURL* HttpConnectionPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        if (!idle_.empty()) {
+            CURL* curl = idle_.back();
+            idle_.pop_back();
+            return curl;
+        }
+    }
+    CURL* curl = curl_easy_init();
+    if (curl) created_.fetch_add(1, std::memory_order_relaxed);
+    return curl;
+}
+
+void HttpConnectionPool::release(CURL* curl) {
+    if (!curl) return;
+    // reset keeps the handle's own caches alive; options are re-applied in prepare()
+    curl_easy_reset(curl);
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    if (idle_.size() < max_idle_) {
+        idle_.push_back(curl);
+        return;
+    }
+    curl_easy_cleanup(curl);
+}
+
+curl_slist* HttpConnectionPool::prepare(CURL* curl, const HttpRequest& req, HttpResponse* out) {
+    if (share_) curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    curl_easy_setopt(curl, CURLOPT_URL, req.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, kConnectTimeoutMs);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, kRequestTimeoutMs);
+
+    if (req.method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req.body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(req.body.size()));
+    } else if (req.method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (req.method != "GET") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, req.method.c_str());
+    }
+
+    struct curl_slist* headers = nullptr;
+    for (const auto& h : req.headers) headers = curl_slist_append(headers, h.c_str());
+    if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out->body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, out);
+    return headers;
+}
+
+void HttpConnectionPool::record_transfer(CURL* curl, HttpResponse& out) {
+    long http_code = 0;
+    long new_connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connects);
+    out.status = static_cast<int>(http_code);
+    out.connection_reused = http_code > 0 && new_connects == 0;
+
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    if (out.connection_reused) reused_.fetch_add(1, std::memory_order_relaxed);
+    else opened_.fetch_add(static_cast<std::uint64_t>(new_connects), std::memory_order_relaxed);
+}
+
+HttpResponse HttpConnectionPool::perform(const HttpRequest& req) {
+    HttpResponse out{};
+    CURL* curl = acquire();
+    if (!curl) {
+        out.error_message = "curl_easy_init failed";
+        return out;
+    }
+
+    struct curl_slist* headers = prepare(curl, req, &out);
+    CURLcode rc = curl_easy_perform(curl);
+    record_transfer(curl, out);
+    if (rc != CURLE_OK) out.error_message = curl_easy_strerror(rc);
+
+    curl_slist_free_all(headers);
+    release(curl);
+    return out;
+}
+
+bool HttpConnectionPool::warm_up(const std::string& url) {
+    HttpRequest req;
+    req.method = "HEAD";
+    req.url = url;
+    const HttpResponse res = perform(req);
+    return res.error_message.empty() && res.status > 0;
+}
+
+HttpPoolStats HttpConnectionPool::stats() const {
+    HttpPoolStats s;
+    s.requests = requests_.load(std::memory_order_relaxed);
+    s.connections_reused = reused_.load(std::memory_order_relaxed);
+    s.connections_opened = opened_.load(std::memory_order_relaxed);
+    s.handles_created = created_.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,167 @@
+#include "indicators.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+double true_range(const Candle& bar, double prev_close) {
+    return std::max({bar.high - bar.low, std::abs(bar.high - prev_close), std::abs(bar.low - prev_close)});
+}
+
+RollingMean::RollingMean(size_t period) : buf_(std::max<size_t>(1, period), 0.0) {}
+
+void RollingMean::push(double v) {
+    const double old = buf_[next_];
+    buf_[next_] = v;
+    next_ = (next_ + 1) % buf_.size();
+    ++count_;
+    if (count_ <= buf_.size()) {
+        sum_ += v;
+    } else if (next_ == 0) {
+        // once per lap: resum the window instead of trusting add/subtract
+        sum_ = 0.0;
+        for (double x : buf_) sum_ += x;
+    } else {
+        sum_ += v - old;
+    }
+}
+
+void RollingMean::reset() {
+    std::fill(buf_.begin(), buf_.end(), 0.0);
+    next_ = 0;
+    count_ = 0;
+    sum_ = 0.0;
+}
+
+double RollingMean::value() const {
+    const size_t n = std::min(count_, buf_.size());
+    return n > 0 ? sum_ / static_cast<double>(n) : 0.0;
+}
+
+Ema::Ema(size_t period) : period_(std::max<size_t>(1, period)), alpha_(2.0 / (static_cast<double>(period_) + 1.0)) {}
+
+void Ema::push(double v) {
+    value_ = count_ == 0 ? v : value_ + alpha_ * (v - value_);
+    ++count_;
+}
+
+void Ema::reset() {
+    count_ = 0;
+    value_ = 0.0;
+}
+
+void RollingAtr::on_bar(const Candle& bar) {
+    if (has_prev_) tr_.push(true_range(bar, prev_close_));
+    prev_close_ = bar.close;
+    has_prev_ = true;
+}
+
+void RollingAtr::reset() {
+    tr_.reset();
+    has_prev_ = false;
+}
+
+void WilderAtr::on_bar(const Candle& bar) {
+    if (has_prev_) {
+        const double tr = true_range(bar, prev_close_);
+        ++count_;
+        if (count_ < period_) {
+            seed_sum_ += tr;
+            value_ = seed_sum_ / static_cast<double>(count_);
+        } else if (count_ == period_) {
+            value_ = (seed_sum_ + tr) / static_cast<double>(period_); // seed: plain mean
+        } else {
+            value_ = (value_ * static_cast<double>(period_ - 1) + tr) / static_cast<double>(period_);
+        }
+    }
+    prev_close_ = bar.close;
+    has_prev_ = true;
+}
+
+void WilderAtr::reset() {
+    count_ = 0;
+    seed_sum_ = 0.0;
+    value_ = 0.0;
+    has_prev_ = false;
+}
+
+void Vwap::push(double price, double volume) {
+    if (volume <= 0.0) return;
+    notional_ += price * volume;
+    volume_ += volume;
+}
+
+void Vwap::reset() {
+    notional_ = 0.0;
+    volume_ = 0.0;
+}
+
+void RealizedVol::push(double close) {
+    if (prev_ > 0.0 && close > 0.0) {
+        const double r = std::log(close / prev_);
+        sq_.push(r * r);
+    }
+    prev_ = close;
+}
+
+void RealizedVol::reset() {
+    sq_.reset();
+    prev_ = 0.0;
+}
+
+double RealizedVol::value() const {
+    return std::sqrt(sq_.value());
+}
+
+double batch_sma_atr(CandleSpan c, size_t n) {
+    if (n == 0 || c.size() < n + 1) return 0.0;
+    double s = 0.0;
+    for (size_t i = c.size() - n; i < c.size(); ++i) s += true_range(c[i], c[i - 1].close);
+    return s / static_cast<double>(n);
+}
+
+double batch_wilder_atr(CandleSpan c, size_t n) {
+    if (n == 0 || c.size() < n + 1) return 0.0;
+    double atr = 0.0;
+    for (size_t i = 1; i <= n; ++i) atr += true_range(c[i], c[i - 1].close);
+    atr /= static_cast<double>(n);
+    for (size_t i = n + 1; i < c.size(); ++i) {
+        atr = (atr * static_cast<double>(n - 1) + true_range(c[i], c[i - 1].close)) / static_cast<double>(n);
+    }
+    return atr;
+}
+
+double batch_highest_high(CandleSpan c, size_t begin, size_t end) {
+    double hh = -std::numeric_limits<double>::infinity();
+    for (size_t i = begin; i < end && i < c.size(); ++i) hh = std::max(hh, c[i].high);
+    return hh;
+}
+
+double batch_ema(const std::vector<double>& v, size_t n) {
+    if (v.empty()) return 0.0;
+    const double alpha = 2.0 / (static_cast<double>(std::max<size_t>(1, n)) + 1.0);
+    double e = v[0];
+    for (size_t i = 1; i < v.size(); ++i) e += alpha * (v[i] - e);
+    return e;
+}
+
+double batch_vwap(const std::vector<std::pair<double, double>>& price_volume) {
+    double notional = 0.0;
+    double volume = 0.0;
+    for (const auto& [price, vol] : price_volume) {
+        if (vol <= 0.0) continue;
+        notional += price * vol;
+        volume += vol;
+    }
+    return volume > 0.0 ? notional / volume : 0.0;
+}
+
+double batch_realized_vol(CandleSpan c, size_t n) {
+    if (c.size() < 2) return 0.0;
+    const size_t returns = std::min(n, c.size() - 1);
+    double s2 = 0.0;
+    for (size_t i = c.size() - returns; i < c.size(); ++i) {
+        const double r = std::log(c[i].close / c[i - 1].close);
+        s2 += r * r;
+    }
+    return std::sqrt(s2 / static_cast<double>(returns));
+}
@@ -0,0 +1,116 @@
+#include "json_scan.hpp"
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+// Position just past the closing quote of the string opening at pos.
+// memchr lets libc use its vectorised search over long string bodies.
+size_t skip_string(std::string_view s, size_t pos) {
+    size_t i = pos + 1;
+    while (i < s.size()) {
+        const void* hit = std::memchr(s.data() + i, '"', s.size() - i);
+        if (!hit) return std::string_view::npos;
+        const size_t q = static_cast<size_t>(static_cast<const char*>(hit) - s.data());
+        size_t backslashes = 0;
+        for (size_t b = q; b > pos + 1 && s[b - 1] == '\\'; --b) ++backslashes;
+        if ((backslashes & 1u) == 0) return q + 1;
+        i = q + 1;
+    }
+    return std::string_view::npos;
+}
+
+size_t skip_container(std::string_view s, size_t pos) {
+    int depth = 0;
+    size_t i = pos;
+    while (i < s.size()) {
+        const char c = s[i];
+        if (c == '"') {
+            i = skip_string(s, i);
+            if (i == std::string_view::npos) return i;
+            continue;
+        }
+        if (c == '{' || c == '[') ++depth;
+        else if (c == '}' || c == ']') {
+            if (--depth == 0) return i + 1;
+        }
+        ++i;
+    }
+    return std::string_view::npos;
+}
+
+// Exact fast path for plain decimals ("51234000.0", "0.01234567"): when the
+// digits fit in 2^53 and the scale is an exactly representable power of ten,
+// one IEEE division gives the correctly rounded result. libstdc++'s
+// from_chars(double) goes through strtod under a locale switch, which costs
+// more than the rest of a frame decode put together.
+bool parse_simple_decimal(std::string_view v, double& out) {
+    static constexpr double kPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    size_t i = 0;
+    const bool negative = !v.empty() && v[0] == '-';
+    if (negative) ++i;
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int frac_digits = 0;
+    bool seen_dot = false;
+    for (; i < v.size(); ++i) {
+        const char c = v[i];
+        if (c >= '0' && c <= '9') {
+            if (++digits > 15) return false;
+            mantissa = mantissa * 10 + static_cast<unsigned>(c - '0');
+            if (seen_dot) ++frac_digits;
+        } else if (c == '.' && !seen_dot) {
+            seen_dot = true;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0) return false;
+    double d = static_cast<double>(mantissa);
+    if (frac_digits > 0) d /= kPow10[frac_digits];
+    out = negative ? -d : d;
+    return true;
+}
+
+} // namespace
+
+size_t json_skip_value(std::string_view s, size_t pos) {
+    if (pos >= s.size()) return std::string_view::npos;
+    const char c = s[pos];
+    if (c == '"') return skip_string(s, pos);
+    if (c == '{' || c == '[') return skip_container(s, pos);
+    size_t i = pos;
+    while (i < s.size() && s[i] != ',' && s[i] != '}' && s[i] != ']' &&
+           s[i] != ' ' && s[i] != '\n' && s[i] != '\r' && s[i] != '\t') {
+        ++i;
+    }
+    return i > pos ? i : std::string_view::npos;
+}
+
+std::string_view json_unquote(std::string_view raw) {
+    if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"') return raw.substr(1, raw.size() - 2);
+    return raw;
+}
+
+bool json_to_double(std::string_view raw, double& out) {
+    const std::string_view v = json_unquote(raw);
+    if (v.empty()) return false;
+    if (parse_simple_decimal(v, out)) return true;
+    const auto res = std::from_chars(v.data(), v.data() + v.size(), out);
+    return res.ec == std::errc();
+}
+
+bool json_to_int64(std::string_view raw, long long& out) {
+    const std::string_view v = json_unquote(raw);
+    if (v.empty()) return false;
+    const auto res = std::from_chars(v.data(), v.data() + v.size(), out);
+    if (res.ec == std::errc() && res.ptr == v.data() + v.size()) return true;
+    // timestamps occasionally arrive as 1.7e12 style doubles
+    double d = 0.0;
+    if (!json_to_double(raw, d)) return false;
+    out = static_cast<long long>(d);
+    return true;
+}
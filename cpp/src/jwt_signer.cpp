@@ -0,0 +1,261 @@
+#include "jwt_signer.hpp"
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#include <openssl/rand.h>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr char kHex[] = "0123456789abcdef";
+constexpr char kHexUpper[] = "0123456789ABCDEF";
+constexpr char kBase64Url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+constexpr std::string_view kBearer = "Bearer ";
+constexpr std::string_view kJwtHeader = R"({"alg":"HS256","typ":"JWT"})";
+
+// Small bump writer over a caller-owned buffer; ok() turns false on overflow.
+struct Writer {
+    char* buf;
+    size_t cap;
+    size_t len{0};
+    bool overflow{false};
+
+    void put(char c) {
+        if (len < cap) buf[len++] = c;
+        else overflow = true;
+    }
+    void put(std::string_view s) {
+        if (len + s.size() <= cap) {
+            std::memcpy(buf + len, s.data(), s.size());
+            len += s.size();
+        } else {
+            overflow = true;
+        }
+    }
+    bool ok() const { return !overflow; }
+};
+
+size_t base64_url_len(size_t n) {
+    return (n / 3) * 4 + (n % 3 == 0 ? 0 : n % 3 + 1);
+}
+
+void base64_url_put(Writer& w, const unsigned char* in, size_t n) {
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3) {
+        const unsigned v = (unsigned(in[i]) << 16) | (unsigned(in[i + 1]) << 8) | in[i + 2];
+        w.put(kBase64Url[(v >> 18) & 63]);
+        w.put(kBase64Url[(v >> 12) & 63]);
+        w.put(kBase64Url[(v >> 6) & 63]);
+        w.put(kBase64Url[v & 63]);
+    }
+    if (n - i == 1) {
+        const unsigned v = unsigned(in[i]) << 16;
+        w.put(kBase64Url[(v >> 18) & 63]);
+        w.put(kBase64Url[(v >> 12) & 63]);
+    } else if (n - i == 2) {
+        const unsigned v = (unsigned(in[i]) << 16) | (unsigned(in[i + 1]) << 8);
+        w.put(kBase64Url[(v >> 18) & 63]);
+        w.put(kBase64Url[(v >> 12) & 63]);
+        w.put(kBase64Url[(v >> 6) & 63]);
+    }
+}
+
+std::string_view encoded_header() {
+    static const std::string header = [] {
+        std::string out(base64_url_len(kJwtHeader.size()), '\0');
+        Writer w{&out[0], out.size()};
+        base64_url_put(w, reinterpret_cast<const unsigned char*>(kJwtHeader.data()), kJwtHeader.size());
+        return out;
+    }();
+    return header;
+}
+
+bool is_unreserved(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+           c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+void url_encode_put(Writer& w, std::string_view value) {
+    for (unsigned char c : value) {
+        if (is_unreserved(c)) {
+            w.put(static_cast<char>(c));
+        } else {
+            w.put('%');
+            w.put(kHexUpper[c >> 4]);
+            w.put(kHexUpper[c & 15]);
+        }
+    }
+}
+
+// RFC 4122 version-4 UUID from the OpenSSL DRBG (per-thread, no reseeding per call).
+bool put_nonce(Writer& w) {
+    std::array<unsigned char, 16> bytes{};
+    if (RAND_bytes(bytes.data(), static_cast<int>(bytes.size())) != 1) return false;
+    bytes[6] = static_cast<unsigned char>((bytes[6] & 0x0f) | 0x40);
+    bytes[8] = static_cast<unsigned char>((bytes[8] & 0x3f) | 0x80);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) w.put('-');
+        w.put(kHex[bytes[i] >> 4]);
+        w.put(kHex[bytes[i] & 15]);
+    }
+    return true;
+}
+
+} // namespace
+
+bool url_encode_into(std::string_view value, char* out, size_t cap, size_t& written) {
+    Writer w{out, cap};
+    url_encode_put(w, value);
+    written = w.len;
+    return w.ok();
+}
+
+std::string url_encode(std::string_view value) {
+    std::string out(value.size() * 3, '\0');
+    size_t written = 0;
+    url_encode_into(value, &out[0], out.size(), written);
+    out.resize(written);
+    return out;
+}
+
+JwtSigner::~JwtSigner() {
+    reset();
+}
+
+void JwtSigner::reset() {
+    if (mac_ctx_) EVP_MAC_CTX_free(mac_ctx_);
+    if (sha512_ctx_) EVP_MD_CTX_free(sha512_ctx_);
+    if (sha512_) EVP_MD_free(sha512_);
+    mac_ctx_ = nullptr;
+    sha512_ctx_ = nullptr;
+    sha512_ = nullptr;
+    access_key_.clear();
+}
+
+void JwtSigner::set_credentials(std::string_view access_key, std::string_view secret_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reset();
+    if (access_key.empty() || secret_key.empty()) return;
+
+    sha512_ = EVP_MD_fetch(nullptr, "SHA512", nullptr);
+    sha512_ctx_ = EVP_MD_CTX_new();
+    if (!sha512_ || !sha512_ctx_) {
+        reset();
+        return;
+    }
+
+    EVP_MAC* mac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+    if (!mac) {
+        reset();
+        return;
+    }
+    EVP_MAC_CTX* ctx = EVP_MAC_CTX_new(mac);
+    EVP_MAC_free(mac); // the context keeps its own reference
+    if (!ctx) {
+        reset();
+        return;
+    }
+
+    char digest[] = "SHA256";
+    const OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+        OSSL_PARAM_construct_end(),
+    };
+    if (EVP_MAC_init(ctx, reinterpret_cast<const unsigned char*>(secret_key.data()), secret_key.size(), params) != 1) {
+        EVP_MAC_CTX_free(ctx);
+        reset();
+        return;
+    }
+    mac_ctx_ = ctx;
+    access_key_.assign(access_key.data(), access_key.size());
+}
+
+size_t JwtSigner::sign(const QueryParam* params, size_t count, char* out, size_t cap) const {
+    if (!ready() || count > kMaxParams) return 0;
+
+    // canonical query: params sorted by key
+    std::array<unsigned char, kMaxParams> order{};
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<unsigned char>(i);
+    for (size_t i = 1; i < count; ++i) {
+        const unsigned char cur = order[i];
+        size_t j = i;
+        while (j > 0 && params[cur].key < params[order[j - 1]].key) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = cur;
+    }
+
+    char query_buf[kMaxQuery];
+    Writer query{query_buf, sizeof(query_buf)};
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) query.put('&');
+        url_encode_put(query, params[order[i]].key);
+        query.put('=');
+        url_encode_put(query, params[order[i]].value);
+    }
+    if (!query.ok()) return 0;
+
+    char payload_buf[512];
+    Writer payload{payload_buf, sizeof(payload_buf)};
+    payload.put(R"({"access_key":")");
+    payload.put(access_key_);
+    payload.put(R"(","nonce":")");
+    if (!put_nonce(payload)) return 0;
+    payload.put('"');
+    if (query.len > 0) {
+        unsigned char hash[EVP_MAX_MD_SIZE];
+        unsigned int hash_len = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (EVP_DigestInit_ex2(sha512_ctx_, sha512_, nullptr) != 1 ||
+                EVP_DigestUpdate(sha512_ctx_, query_buf, query.len) != 1 ||
+                EVP_DigestFinal_ex(sha512_ctx_, hash, &hash_len) != 1) {
+                return 0;
+            }
+        }
+        payload.put(R"(,"query_hash":")");
+        for (unsigned int i = 0; i < hash_len; ++i) {
+            payload.put(kHex[hash[i] >> 4]);
+            payload.put(kHex[hash[i] & 15]);
+        }
+        payload.put(R"(","query_hash_alg":"SHA512")");
+    }
+    payload.put('}');
+    if (!payload.ok()) return 0;
+
+    Writer w{out, cap};
+    w.put(kBearer);
+    const size_t signing_begin = w.len;
+    w.put(encoded_header());
+    w.put('.');
+    base64_url_put(w, reinterpret_cast<const unsigned char*>(payload_buf), payload.len);
+    if (!w.ok()) return 0;
+
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    size_t mac_len = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // a NULL key re-initialises the context with the secret it was keyed with
+        if (EVP_MAC_init(mac_ctx_, nullptr, 0, nullptr) != 1 ||
+            EVP_MAC_update(mac_ctx_, reinterpret_cast<const unsigned char*>(out + signing_begin), w.len - signing_begin) != 1 ||
+            EVP_MAC_final(mac_ctx_, mac, &mac_len, sizeof(mac)) != 1) {
+            return 0;
+        }
+    }
+    w.put('.');
+    base64_url_put(w, mac, mac_len);
+    if (!w.ok() || w.len >= cap) return 0;
+    out[w.len] = '\0';
+    return w.len;
+}
+
+std::string JwtSigner::sign(const std::vector<std::pair<std::string, std::string>>& params) const {
+    if (params.size() > kMaxParams) return {};
+    std::array<QueryParam, kMaxParams> views{};
+    for (size_t i = 0; i < params.size(); ++i) views[i] = {params[i].first, params[i].second};
+    char buf[kMaxToken];
+    const size_t len = sign(views.data(), params.size(), buf, sizeof(buf));
+    return std::string(buf, len);
+}
@@ -0,0 +1,210 @@
+#include "latency_histogram.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+constexpr std::uint64_t kLinearLimit = 2ULL << LatencyHistogram::kSubBits; // exact below this
+constexpr std::uint64_t kMaxValue = (1ULL << LatencyHistogram::kMaxBits) - 1;
+
+double bucket_low(size_t i, double& width) {
+    if (i < kLinearLimit) {
+        width = 1.0;
+        return static_cast<double>(i);
+    }
+    const int shift = static_cast<int>(i >> LatencyHistogram::kSubBits) - 1;
+    const std::uint64_t sub = (i & ((1ULL << LatencyHistogram::kSubBits) - 1)) + (1ULL << LatencyHistogram::kSubBits);
+    width = static_cast<double>(1ULL << shift);
+    return static_cast<double>(sub << shift);
+}
+
+struct ThreadHistograms {
+    std::array<std::atomic<LatencyHistogram*>, kLatencyStageCount> stages{};
+    std::array<std::unique_ptr<LatencyHistogram>, kLatencyStageCount> owned;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadHistograms*> threads;
+    std::array<std::vector<std::uint64_t>, kLatencyStageCount> retired; // counts of exited threads
+};
+
+// Never destroyed: threads may still record while statics are torn down.
+Registry& registry() {
+    static Registry* r = new Registry;
+    return *r;
+}
+
+// Set once this thread's histograms are retired; later samples are dropped.
+thread_local bool tls_retired = false;
+
+// A thread's set, registered while the thread lives.
+class ThreadSlot {
+public:
+    ThreadSlot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(&set_);
+    }
+    ~ThreadSlot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t s = 0; s < kLatencyStageCount; ++s) {
+            if (const LatencyHistogram* h = set_.owned[s].get()) h->add_to(r.retired[s]);
+        }
+        r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), &set_), r.threads.end());
+        tls_retired = true;
+    }
+    ThreadSlot(const ThreadSlot&) = delete;
+    ThreadSlot& operator=(const ThreadSlot&) = delete;
+
+    ThreadHistograms& set() { return set_; }
+
+private:
+    ThreadHistograms set_;
+};
+
+ThreadHistograms& local_histograms() {
+    thread_local ThreadSlot mine;
+    return mine.set();
+}
+
+} // namespace
+
+size_t LatencyHistogram::bucket_of(std::uint64_t ns) {
+    if (ns < kLinearLimit) return static_cast<size_t>(ns);
+    ns = std::min(ns, kMaxValue);
+    const int shift = 63 - __builtin_clzll(ns) - kSubBits;
+    return (static_cast<size_t>(shift + 1) << kSubBits) + static_cast<size_t>((ns >> shift) - (1ULL << kSubBits));
+}
+
+double LatencyHistogram::bucket_mid(size_t i) {
+    double width;
+    const double low = bucket_low(i, width);
+    return low + (width - 1.0) / 2.0;
+}
+
+double LatencyHistogram::bucket_high(size_t i) {
+    double width;
+    const double low = bucket_low(i, width);
+    return low + width - 1.0;
+}
+
+LatencySummary LatencyHistogram::summarize(const std::vector<std::uint64_t>& counts) {
+    LatencySummary s;
+    size_t top = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0) continue;
+        s.count += counts[i];
+        top = i;
+    }
+    if (s.count == 0) return s;
+    s.max_us = bucket_high(top) / 1000.0;
+
+    const double qs[] = {0.50, 0.90, 0.99, 0.999};
+    double* outs[] = {&s.p50_us, &s.p90_us, &s.p99_us, &s.p999_us};
+    size_t q = 0;
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i <= top && q < 4; ++i) {
+        seen += counts[i];
+        while (q < 4 && seen >= std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(qs[q] * s.count)))) {
+            *outs[q++] = std::min(bucket_mid(i) / 1000.0, s.max_us);
+        }
+    }
+    return s;
+}
+
+void LatencyHistogram::add_to(std::vector<std::uint64_t>& counts) const {
+    counts.resize(kBuckets);
+    for (size_t i = 0; i < kBuckets; ++i) counts[i] += counts_[i].load(std::memory_order_relaxed);
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    std::vector<std::uint64_t> counts;
+    add_to(counts);
+    return summarize(counts);
+}
+
+const char* latency_stage_name(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::FrameDecode: return "frame-decode";
+    case LatencyStage::QueueWait: return "queue-wait";
+    case LatencyStage::MarketUpdate: return "market-update";
+    case LatencyStage::Decision: return "decision";
+    case LatencyStage::OrderPrepare: return "order-prepare";
+    case LatencyStage::OrderSend: return "order-send";
+    case LatencyStage::RestAck: return "rest-ack";
+    case LatencyStage::SendToFill: return "send-to-fill";
+    case LatencyStage::TickToTrade: return "tick-to-trade";
+    }
+    return "unknown";
+}
+
+long long LatencyRecorder::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyRecorder::record(LatencyStage stage, long long ns) {
+    if (tls_retired) return; // from another thread_local's destructor
+    ThreadHistograms& mine = local_histograms();
+    const size_t i = static_cast<size_t>(stage);
+    LatencyHistogram* h = mine.stages[i].load(std::memory_order_relaxed);
+    if (!h) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        mine.owned[i] = std::make_unique<LatencyHistogram>();
+        h = mine.owned[i].get();
+        mine.stages[i].store(h, std::memory_order_release);
+    }
+    h->record(ns);
+}
+
+void LatencyRecorder::add_to(LatencyStage stage, std::vector<std::uint64_t>& counts) {
+    counts.resize(LatencyHistogram::kBuckets);
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const std::vector<std::uint64_t>& retired = r.retired[static_cast<size_t>(stage)];
+    for (size_t i = 0; i < retired.size(); ++i) counts[i] += retired[i];
+    for (const ThreadHistograms* t : r.threads) {
+        if (const LatencyHistogram* h = t->stages[static_cast<size_t>(stage)].load(std::memory_order_acquire)) {
+            h->add_to(counts);
+        }
+    }
+}
+
+LatencySummary LatencyRecorder::summary(LatencyStage stage) {
+    std::vector<std::uint64_t> counts;
+    add_to(stage, counts);
+    return LatencyHistogram::summarize(counts);
+}
+
+std::string LatencyReport::dump() {
+    std::string out;
+    std::vector<std::uint64_t> now;
+    std::vector<std::uint64_t> interval(LatencyHistogram::kBuckets);
+    for (size_t s = 0; s < kLatencyStageCount; ++s) {
+        now.assign(LatencyHistogram::kBuckets, 0);
+        LatencyRecorder::add_to(static_cast<LatencyStage>(s), now);
+        std::vector<std::uint64_t>& last = last_[s];
+        last.resize(LatencyHistogram::kBuckets);
+        std::uint64_t total = 0;
+        for (size_t i = 0; i < now.size(); ++i) {
+            interval[i] = now[i] - last[i];
+            total += now[i];
+        }
+        last.swap(now);
+        const LatencySummary l = LatencyHistogram::summarize(interval);
+        if (l.count == 0) continue;
+        char line[192];
+        std::snprintf(line, sizeof(line), "%-14s n=%-8llu p50=%.1fus p99=%.1fus p999=%.1fus max=%.1fus (total %llu)\n",
+                      latency_stage_name(static_cast<LatencyStage>(s)), static_cast<unsigned long long>(l.count),
+                      l.p50_us, l.p99_us, l.p999_us, l.max_us, static_cast<unsigned long long>(total));
+        out += line;
+    }
+    return out;
+}
@@ -1,10 +1,21 @@
 #include "engine.hpp"
+#include "http_pool.hpp"
+#include "latency_histogram.hpp"
+#include <cstdlib>
 #include <iostream>
 
 int main() {
     Engine e;
-    int rc = e.run_once();
+    // UPBIT_TOP_N > 1 trades the best N markets concurrently instead of one
+    const char* top_n = std::getenv("UPBIT_TOP_N");
+    const long n = top_n ? std::strtol(top_n, nullptr, 10) : 1;
+    int rc = n > 1 ? e.run_once_multi(static_cast<size_t>(n), 10000.0) : e.run_once();
     std::cout << "engine rc=" << rc << "\n";
+    const HttpPoolStats stats = e.rest().connection_stats();
+    std::cout << "http requests=" << stats.requests
+              << " reused=" << stats.connections_reused
+              << " opened=" << stats.connections_opened << "\n";
+    std::cout << LatencyReport().dump();
     return rc;
 }
 
@@ -0,0 +1,448 @@
+#include "market_archive.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "upbit_rest.hpp"
+
+namespace {
+
+constexpr std::uint32_t kFormatVersion = 1;
+constexpr size_t kMinMapBytes = 1 << 20;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t record_size;
+    unsigned char reserved[16];
+};
+static_assert(sizeof(FileHeader) == CandleLog::kHeaderBytes, "header layout");
+static_assert(sizeof(Candle) == 48, "candle record layout");
+static_assert(sizeof(TradeRecord) == 40, "trade record layout");
+
+bool positive(double v) { return std::isfinite(v) && v > 0.0; }
+
+template <typename T>
+struct RecordTraits;
+
+template <>
+struct RecordTraits<Candle> {
+    static constexpr const char* kMagic = "UPBCNDL";
+    static bool valid(const Candle& c) {
+        return c.ts_ms > 0 && positive(c.open) && positive(c.high) && positive(c.low) && positive(c.close) &&
+               c.high >= c.low && std::isfinite(c.volume) && c.volume >= 0.0;
+    }
+    static bool ordered(const Candle& prev, const Candle& next) { return next.ts_ms > prev.ts_ms; }
+};
+
+template <>
+struct RecordTraits<TradeRecord> {
+    static constexpr const char* kMagic = "UPBTICK";
+    static bool valid(const TradeRecord& t) {
+        return t.ts_ms > 0 && positive(t.price) && std::isfinite(t.volume) && t.volume >= 0.0 && t.is_bid <= 1;
+    }
+    static bool ordered(const TradeRecord& prev, const TradeRecord& next) { return next.ts_ms >= prev.ts_ms; }
+};
+
+bool set_error(std::string* error, const std::string& what) {
+    if (error) *error = what + ": " + std::strerror(errno);
+    return false;
+}
+
+bool pwrite_all(int fd, const void* buf, size_t len, off_t off) {
+    const auto* p = static_cast<const unsigned char*>(buf);
+    while (len > 0) {
+        const ssize_t n = ::pwrite(fd, p, len, off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+        off += n;
+    }
+    return true;
+}
+
+bool pread_all(int fd, void* buf, size_t len, off_t off) {
+    auto* p = static_cast<unsigned char*>(buf);
+    while (len > 0) {
+        const ssize_t n = ::pread(fd, p, len, off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+        off += n;
+    }
+    return true;
+}
+
+std::string safe_name(const std::string& market) {
+    std::string out = market;
+    for (char& ch : out) {
+        const bool ok = (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '-' || ch == '_';
+        if (!ok) ch = '_';
+    }
+    return out;
+}
+
+} // namespace
+
+TradeRecord to_trade_record(const TradeTick& t) {
+    TradeRecord r;
+    r.ts_ms = t.ts_ms;
+    r.sequential_id = t.sequential_id;
+    r.price = t.price;
+    r.volume = t.volume;
+    r.is_bid = t.is_bid ? 1 : 0;
+    return r;
+}
+
+template <typename T>
+AppendLog<T>::~AppendLog() {
+    close();
+}
+
+template <typename T>
+bool AppendLog<T>::open(const std::string& path, std::string* error) {
+    return open_file(path, error, true);
+}
+
+template <typename T>
+bool AppendLog<T>::open_read_only(const std::string& path, std::string* error) {
+    return open_file(path, error, false);
+}
+
+template <typename T>
+bool AppendLog<T>::open_file(const std::string& path, std::string* error, bool writable) {
+    close();
+    recovered_ = 0;
+    fd_ = writable ? ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644) : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) return set_error(error, "open " + path);
+    writable_ = writable;
+    if (writable && ::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        set_error(error, "lock " + path);
+        close();
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+        set_error(error, "stat " + path);
+        close();
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+
+    FileHeader header{};
+    if (bytes < kHeaderBytes && !writable) {
+        if (error) *error = path + ": empty";
+        close();
+        return false;
+    }
+    if (bytes < kHeaderBytes) {
+        // new file, or a crash before the header made it out
+        std::memcpy(header.magic, RecordTraits<T>::kMagic, std::strlen(RecordTraits<T>::kMagic) + 1);
+        header.version = kFormatVersion;
+        header.record_size = sizeof(T);
+        if (::ftruncate(fd_, 0) != 0 || !pwrite_all(fd_, &header, sizeof(header), 0) || ::fdatasync(fd_) != 0) {
+            set_error(error, "init " + path);
+            close();
+            return false;
+        }
+        bytes = kHeaderBytes;
+    } else if (!pread_all(fd_, &header, sizeof(header), 0) ||
+               std::strncmp(header.magic, RecordTraits<T>::kMagic, sizeof(header.magic)) != 0 ||
+               header.version != kFormatVersion || header.record_size != sizeof(T)) {
+        if (error) *error = path + ": not a " + RecordTraits<T>::kMagic + " v" + std::to_string(kFormatVersion) + " file";
+        close();
+        return false;
+    }
+
+    size_ = (bytes - kHeaderBytes) / sizeof(T);
+    if (!map_at_least(kHeaderBytes + size_ * sizeof(T))) {
+        set_error(error, "mmap " + path);
+        close();
+        return false;
+    }
+    // a crash can leave a torn or zero-filled tail; drop it
+    const T* rec = data();
+    while (size_ > 0 && !(RecordTraits<T>::valid(rec[size_ - 1]) &&
+                          (size_ < 2 || RecordTraits<T>::ordered(rec[size_ - 2], rec[size_ - 1])))) {
+        --size_;
+        ++recovered_;
+    }
+    const size_t good_bytes = kHeaderBytes + size_ * sizeof(T);
+    if (writable && good_bytes != bytes && ::ftruncate(fd_, static_cast<off_t>(good_bytes)) != 0) {
+        set_error(error, "truncate " + path);
+        close();
+        return false;
+    }
+
+    index_.clear();
+    for (size_t i = 0; i < size_; i += kIndexStride) index_.push_back(rec[i].ts_ms);
+    return true;
+}
+
+template <typename T>
+void AppendLog<T>::close() {
+    unmap();
+    if (fd_ >= 0) ::close(fd_); // also drops the flock
+    fd_ = -1;
+    writable_ = false;
+    size_ = 0;
+    index_.clear();
+}
+
+template <typename T>
+bool AppendLog<T>::map_at_least(size_t bytes) {
+    if (map_ && bytes <= map_bytes_) return true;
+    // map past EOF so appends rarely need a new mapping; only the part
+    // backed by the file is ever read
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t want = std::max(kMinMapBytes, bytes * 2);
+    want = (want + page - 1) / page * page;
+    unmap();
+    void* p = ::mmap(nullptr, want, PROT_READ, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) return false;
+    map_ = static_cast<const unsigned char*>(p);
+    map_bytes_ = want;
+    return true;
+}
+
+template <typename T>
+void AppendLog<T>::unmap() {
+    if (map_) ::munmap(const_cast<unsigned char*>(map_), map_bytes_);
+    map_ = nullptr;
+    map_bytes_ = 0;
+}
+
+template <typename T>
+size_t AppendLog<T>::lower_bound(long long ts_ms) const {
+    if (size_ == 0) return 0;
+    const auto it = std::lower_bound(index_.begin(), index_.end(), ts_ms);
+    const size_t block = it == index_.begin() ? 0 : static_cast<size_t>(it - index_.begin()) - 1;
+    const T* first = data() + block * kIndexStride;
+    const T* last = data() + std::min(size_, (block + 1) * kIndexStride);
+    const T* hit = std::lower_bound(first, last, ts_ms, [](const T& r, long long ts) { return r.ts_ms < ts; });
+    return static_cast<size_t>(hit - data());
+}
+
+template <typename T>
+bool AppendLog<T>::append(const T* records, size_t n) {
+    if (fd_ < 0 || !writable_) return false;
+    if (n == 0) return true;
+    const T* prev = size_ > 0 ? &back() : nullptr;
+    for (size_t i = 0; i < n; ++i) {
+        if (!RecordTraits<T>::valid(records[i])) return false;
+        if (prev && !RecordTraits<T>::ordered(*prev, records[i])) return false;
+        prev = &records[i];
+    }
+    const size_t off = kHeaderBytes + size_ * sizeof(T);
+    if (!pwrite_all(fd_, records, n * sizeof(T), static_cast<off_t>(off))) {
+        close(); // reopening trims whatever part of the write landed
+        return false;
+    }
+    if (!map_at_least(off + n * sizeof(T))) {
+        close();
+        return false;
+    }
+    for (size_t i = size_; i < size_ + n; ++i) {
+        if (i % kIndexStride == 0) index_.push_back(records[i - size_].ts_ms);
+    }
+    size_ += n;
+    return true;
+}
+
+template <typename T>
+bool AppendLog<T>::replace_back(const T& record) {
+    if (fd_ < 0 || !writable_ || size_ == 0 || !RecordTraits<T>::valid(record)) return false;
+    if (size_ >= 2 && !RecordTraits<T>::ordered((*this)[size_ - 2], record)) return false;
+    const size_t off = kHeaderBytes + (size_ - 1) * sizeof(T);
+    if (!pwrite_all(fd_, &record, sizeof(T), static_cast<off_t>(off))) {
+        close();
+        return false;
+    }
+    if ((size_ - 1) % kIndexStride == 0) index_.back() = record.ts_ms;
+    return true;
+}
+
+template <typename T>
+bool AppendLog<T>::sync() {
+    return fd_ >= 0 && writable_ && ::fdatasync(fd_) == 0;
+}
+
+template class AppendLog<Candle>;
+template class AppendLog<TradeRecord>;
+
+CandleSpan candle_range(const CandleLog& log, long long from_ms, long long to_ms) {
+    const size_t begin = log.lower_bound(from_ms);
+    const size_t end = std::max(begin, log.lower_bound(to_ms));
+    return {log.data() + begin, end - begin};
+}
+
+MarketArchive::MarketArchive(std::string root) : root_(std::move(root)) {}
+
+MarketArchive::~MarketArchive() {
+    sync();
+}
+
+long long MarketArchive::now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string MarketArchive::market_dir(const std::string& market) const {
+    return root_ + "/" + safe_name(market);
+}
+
+std::string MarketArchive::candle_path(const std::string& market, int unit) const {
+    return market_dir(market) + "/" + std::to_string(unit) + "m.candles";
+}
+
+std::string MarketArchive::trade_path(const std::string& market) const {
+    return market_dir(market) + "/trades.ticks";
+}
+
+std::string MarketArchive::last_error() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+CandleLog* MarketArchive::candle_log(const std::string& market, int unit) {
+    auto& slot = candles_[market + "/" + std::to_string(unit)];
+    if (!slot) {
+        slot = std::make_unique<CandleLog>();
+        const std::string dir = market_dir(market);
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        slot->open(candle_path(market, unit), &last_error_);
+    }
+    return slot->is_open() ? slot.get() : nullptr;
+}
+
+TradeLog* MarketArchive::trade_log(const std::string& market) {
+    auto& slot = trades_[market];
+    if (!slot) {
+        slot = std::make_unique<TradeLog>();
+        const std::string dir = market_dir(market);
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        slot->open(trade_path(market), &last_error_);
+    }
+    return slot->is_open() ? slot.get() : nullptr;
+}
+
+int MarketArchive::gap_count(const std::string& market, int unit, int lookback, long long now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const CandleLog* log = candle_log(market, unit);
+    if (!log || log->empty() || unit <= 0) return lookback;
+    const long long period = static_cast<long long>(unit) * 60'000;
+    const long long gap = now_ms / period - log->back().ts_ms / period; // missing closed bars + the forming one
+    if (gap < 1) return 1;
+    if (gap >= lookback || log->size() + static_cast<size_t>(gap) < static_cast<size_t>(lookback)) return lookback;
+    return static_cast<int>(gap);
+}
+
+std::vector<Candle> MarketArchive::merge(const std::string& market, int unit, const std::vector<Candle>& page,
+                                         size_t lookback, long long now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CandleLog* log = unit > 0 ? candle_log(market, unit) : nullptr;
+    if (!log) {
+        return page.size() > lookback ? std::vector<Candle>(page.end() - static_cast<std::ptrdiff_t>(lookback), page.end()) : page;
+    }
+    const long long period = static_cast<long long>(unit) * 60'000;
+    const long long now_bar = now_ms / period;
+
+    // The newest page bar is treated as forming even if the clock says its
+    // interval is over: it is archived on the next fetch, once a newer bar
+    // proves it closed.
+    long long newest = log->empty() ? LLONG_MIN : log->back().ts_ms / period;
+    std::vector<Candle> closed;
+    for (size_t i = 0; i + 1 < page.size(); ++i) {
+        const long long bar = page[i].ts_ms / period;
+        if (bar >= now_bar) break;
+        if (bar <= newest) continue;
+        closed.push_back(page[i]);
+        newest = bar;
+    }
+    if (!log->append(closed.data(), closed.size())) {
+        for (const Candle& c : closed) log->append(c); // keep whatever is valid
+    }
+
+    const size_t from = log->size() > lookback ? log->size() - lookback : 0;
+    std::vector<Candle> out(log->data() + from, log->data() + log->size());
+    newest = out.empty() ? LLONG_MIN : out.back().ts_ms / period;
+    for (const Candle& c : page) {
+        if (c.ts_ms / period > newest) out.push_back(c);
+    }
+    if (out.size() > lookback) out.erase(out.begin(), out.end() - static_cast<std::ptrdiff_t>(lookback));
+    return out;
+}
+
+std::vector<Candle> MarketArchive::load(const std::string& market, int unit, long long from_ms, long long to_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const CandleLog* log = candle_log(market, unit);
+    if (!log) return {};
+    return candle_range(*log, from_ms, to_ms).to_vector();
+}
+
+size_t MarketArchive::append_trades(const std::string& market, const TradeRecord* trades, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TradeLog* log = trade_log(market);
+    if (!log) return 0;
+    const TradeRecord* last = log->empty() ? nullptr : &log->back();
+    long long ts = last ? last->ts_ms : LLONG_MIN;
+    long long last_id = last ? last->sequential_id : 0;
+    std::vector<TradeRecord> keep;
+    keep.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const TradeRecord& t = trades[i];
+        if (t.ts_ms < ts || (t.ts_ms == ts && t.sequential_id == last_id)) continue;
+        keep.push_back(t);
+        ts = t.ts_ms;
+        last_id = t.sequential_id;
+    }
+    return log->append(keep.data(), keep.size()) ? keep.size() : 0;
+}
+
+void MarketArchive::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [key, log] : candles_) {
+        if (log) log->sync();
+    }
+    for (auto& [key, log] : trades_) {
+        if (log) log->sync();
+    }
+}
+
+std::vector<std::pair<std::string, std::vector<Candle>>> fetch_candles_cached(
+    UpbitRestClient& rest, MarketArchive* archive, const std::vector<std::string>& markets, int unit, int lookback) {
+    if (!archive) return rest.get_candles_minutes_batch(markets, unit, lookback);
+
+    const long long now = MarketArchive::now_ms();
+    std::vector<std::future<std::vector<Candle>>> pending;
+    pending.reserve(markets.size());
+    for (const auto& m : markets) {
+        pending.push_back(rest.get_candles_minutes_async(m, unit, archive->gap_count(m, unit, lookback, now)));
+    }
+
+    std::vector<std::pair<std::string, std::vector<Candle>>> out;
+    out.reserve(markets.size());
+    for (size_t i = 0; i < markets.size(); ++i) {
+        std::vector<Candle> page = pending[i].get();
+        // a failed request stays empty rather than serving stale history
+        if (!page.empty()) page = archive->merge(markets[i], unit, page, static_cast<size_t>(lookback), now);
+        out.emplace_back(markets[i], std::move(page));
+    }
+    return out;
+}
@@ -0,0 +1,275 @@
+#include "market_pipeline.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// empty polls before the strategy thread starts napping between polls
+constexpr int kSpinPolls = 64;
+constexpr auto kIdleNap = std::chrono::microseconds(100);
+
+} // namespace
+
+MarketPipeline::MarketPipeline() : queue_(std::make_unique<Queue>()) {
+    strategy_ = std::thread([this]() { run(); });
+}
+
+MarketPipeline::~MarketPipeline() {
+    stop();
+}
+
+void MarketPipeline::stop() {
+    stop_.store(true, std::memory_order_release);
+    if (strategy_.joinable()) strategy_.join();
+}
+
+long long MarketPipeline::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool MarketPipeline::on_frame(std::string_view frame, WsFormat format) {
+    const long long recv = now_ns();
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(frame.size(), std::memory_order_relaxed);
+
+    scratch_.type = WsFrameDecoder::decode(frame, scratch_.trade, scratch_.book, format);
+    if (scratch_.type != WsMessageType::Trade && scratch_.type != WsMessageType::Orderbook) return true;
+    scratch_.recv_ns = recv;
+    scratch_.queued_ns = now_ns();
+    decode_.record(scratch_.queued_ns - recv);
+    LatencyRecorder::record(LatencyStage::FrameDecode, scratch_.queued_ns - recv);
+
+    if (!queue_->try_push(scratch_)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const size_t depth = queue_->size();
+    if (depth > high_water_.load(std::memory_order_relaxed)) high_water_.store(depth, std::memory_order_relaxed);
+    return true;
+}
+
+void MarketPipeline::set_market(std::string market, CandleSpan candles_5m) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    market_pending_ = true;
+    next_market_ = std::move(market);
+    next_candles_.assign(candles_5m);
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::merge_candles(std::string market, std::vector<Candle> candles_5m) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    pending_merges_.emplace_back(std::move(market), std::move(candles_5m));
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::set_event_sink(EventSink sink) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    sink_pending_ = true;
+    next_sink_ = std::move(sink);
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::set_archive(MarketArchive* archive) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    archive_pending_ = true;
+    next_archive_ = archive;
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::set_archived_markets(std::vector<std::string> markets) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    archived_markets_pending_ = true;
+    next_archived_markets_ = std::move(markets);
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::seed_ranking(std::vector<std::pair<std::string, std::vector<Candle>>> bars_1m) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    for (auto& seed : bars_1m) pending_seeds_.push_back(std::move(seed));
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::set_turnover(std::vector<Ticker24h> tickers) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    pending_turnover_ = std::move(tickers);
+    control_pending_.store(true, std::memory_order_release);
+}
+
+void MarketPipeline::apply_control() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    control_pending_.store(false, std::memory_order_relaxed);
+    if (market_pending_) {
+        if (next_market_ != state_.code) state_.book.clear();
+        state_.code = std::move(next_market_);
+        state_.seed(next_candles_);
+        market_pending_ = false;
+        dirty_ = true;
+    }
+    // after a market switch, so a fill for the new market lands on its seed
+    for (auto& [market, candles] : pending_merges_) {
+        if (market != state_.code) continue;
+        state_.merge_candles(candles);
+        dirty_ = true;
+    }
+    pending_merges_.clear();
+    if (sink_pending_) {
+        sink_ = std::move(next_sink_);
+        sink_pending_ = false;
+    }
+    if (archive_pending_) {
+        flush_archive();
+        archive_ = next_archive_;
+        archive_pending_ = false;
+    }
+    if (archived_markets_pending_) {
+        archived_markets_ = std::move(next_archived_markets_);
+        archived_markets_pending_ = false;
+    }
+    if (!pending_turnover_.empty() || !pending_seeds_.empty()) {
+        for (const Ticker24h& t : pending_turnover_) ranker_.set_turnover(t.market, t.acc_trade_price_24h);
+        for (const auto& [market, bars] : pending_seeds_) ranker_.seed(market, bars);
+        pending_turnover_.clear();
+        pending_seeds_.clear();
+        rank_due_ = true;
+    }
+}
+
+bool MarketPipeline::archives(std::string_view market) const {
+    return archived_markets_.empty() || market == state_.code ||
+           std::find(archived_markets_.begin(), archived_markets_.end(), market) != archived_markets_.end();
+}
+
+void MarketPipeline::apply(const MarketEvent& ev) {
+    if (sink_) sink_(ev);
+    if (ev.type == WsMessageType::Trade) {
+        if (ranker_.on_trade(ev.trade.code, ev.trade.ts_ms, ev.trade.price)) rank_due_ = true;
+        if (archive_ && archives(ev.trade.code)) {
+            unarchived_[ev.trade.code].push_back(to_trade_record(ev.trade));
+            ++unarchived_count_;
+        }
+        if (state_.code != ev.trade.code) return;
+        state_.on_trade(ev.trade);
+        last_recv_ns_ = ev.recv_ns;
+        dirty_ = true;
+    } else if (ev.type == WsMessageType::Orderbook) {
+        if (state_.code != ev.book.code || ev.book.depth <= 0) return;
+        state_.book.apply(ev.book);
+        last_recv_ns_ = ev.recv_ns;
+        dirty_ = true;
+    }
+}
+
+void MarketPipeline::publish() {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    snapshot_.market = state_.code;
+    snapshot_.candles_5m = state_.candles_5m();
+    snapshot_.book = state_.book;
+    snapshot_.last_recv_ns = last_recv_ns_;
+    ++snapshot_.version;
+    dirty_ = false;
+}
+
+void MarketPipeline::rank() {
+    std::vector<RankedMarket> top = ranker_.top(kRankedMarkets);
+    rank_due_ = false;
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    ranking_ = std::move(top);
+    ++ranking_version_;
+}
+
+void MarketPipeline::flush_archive() {
+    if (archive_ && unarchived_count_ > 0) {
+        for (auto& [market, trades] : unarchived_) {
+            if (trades.empty()) continue;
+            archive_->append_trades(market, trades.data(), trades.size());
+            trades.clear();
+        }
+    }
+    unarchived_count_ = 0;
+}
+
+bool MarketPipeline::read_snapshot(std::uint64_t& version, MarketSnapshot& out) const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    if (snapshot_.version <= version) return false;
+    out = snapshot_;
+    version = snapshot_.version;
+    return true;
+}
+
+bool MarketPipeline::read_ranking(std::uint64_t& version, std::vector<RankedMarket>& out) const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    if (ranking_version_ <= version) return false;
+    out = ranking_;
+    version = ranking_version_;
+    return true;
+}
+
+PipelineStats MarketPipeline::stats() const {
+    PipelineStats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.bytes = bytes_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.queue_depth = queue_->size();
+    s.queue_high_water = high_water_.load(std::memory_order_relaxed);
+    s.decode = decode_.summary();
+    s.queue_wait = queue_wait_.summary();
+    s.apply = apply_.summary();
+    s.end_to_end = end_to_end_.summary();
+    return s;
+}
+
+void MarketPipeline::run() {
+    constexpr long long kPublishIntervalNs = kPublishIntervalMs * 1'000'000;
+    constexpr long long kArchiveFlushNs = kArchiveFlushMs * 1'000'000;
+    constexpr long long kRankIntervalNs = kRankIntervalMs * 1'000'000;
+    int idle = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+        if (control_pending_.load(std::memory_order_acquire)) apply_control();
+
+        const MarketEvent* ev = queue_->front();
+        if (!ev) {
+            const long long now = now_ns();
+            if (dirty_ && now - last_publish_ns_ >= kPublishIntervalNs) {
+                publish();
+                last_publish_ns_ = now;
+            }
+            if (unarchived_count_ > 0 && now - last_archive_ns_ >= kArchiveFlushNs) {
+                flush_archive();
+                last_archive_ns_ = now;
+            }
+            if (rank_due_ && now - last_rank_ns_ >= kRankIntervalNs) {
+                rank();
+                last_rank_ns_ = now;
+            }
+            if (++idle > kSpinPolls) std::this_thread::sleep_for(kIdleNap);
+            else std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+
+        const long long picked = now_ns();
+        queue_wait_.record(picked - ev->queued_ns);
+        LatencyRecorder::record(LatencyStage::QueueWait, picked - ev->queued_ns);
+        apply(*ev);
+        const long long done = now_ns();
+        apply_.record(done - picked);
+        LatencyRecorder::record(LatencyStage::MarketUpdate, done - picked);
+        end_to_end_.record(done - ev->recv_ns);
+        queue_->pop();
+
+        if (dirty_ && done - last_publish_ns_ >= kPublishIntervalNs) {
+            publish();
+            last_publish_ns_ = done;
+        }
+        if (unarchived_count_ > 0 && done - last_archive_ns_ >= kArchiveFlushNs) {
+            flush_archive();
+            last_archive_ns_ = done;
+        }
+        if (rank_due_ && done - last_rank_ns_ >= kRankIntervalNs) {
+            rank();
+            last_rank_ns_ = done;
+        }
+    }
+    flush_archive();
+}
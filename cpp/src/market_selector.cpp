@@ -1,15 +1,31 @@
 #include "market_selector.hpp"
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include "simd_kernels.hpp"
+#include "timeframe_bars.hpp"
 
-static double realized_vol_1m(const std::vector<Candle>& c) {
+namespace {
+
+using MarketCandles = std::vector<std::pair<std::string, std::vector<Candle>>>;
+
+// One hashed lookup per ticker instead of a scan of the batch.
+std::unordered_map<std::string_view, const std::vector<Candle>*> index_candles(const MarketCandles& candles) {
+    std::unordered_map<std::string_view, const std::vector<Candle>*> out;
+    out.reserve(candles.size());
+    for (const auto& [market, bars] : candles) out.emplace(market, &bars);
+    return out;
+}
+
+} // namespace
+
+// Gathers the closes into a contiguous column so the log returns run
+// through the vector kernels.
+static double realized_vol_1m(CandleSpan c, std::vector<double>& closes) {
     if (c.size() < 2) return 0.0;
-    double s2 = 0.0; size_t n = 0;
-    for (size_t i = 1; i < c.size(); ++i) {
-        double r = std::log(c[i].close / c[i-1].close);
-        s2 += r*r; ++n;
-    }
-    return std::sqrt(s2 / std::max<size_t>(1, n));
+    closes.resize(c.size());
+    for (size_t i = 0; i < c.size(); ++i) closes[i] = c[i].close;
+    return std::sqrt(simd_sum_sq_log_returns(closes.data(), closes.size()) / static_cast<double>(c.size() - 1));
 }
 
 std::string MarketSelector::select_top_market(
@@ -18,13 +34,121 @@ std::string MarketSelector::select_top_market(
 
     double best = -std::numeric_limits<double>::infinity();
     std::string best_mkt;
+    std::vector<double> closes;
+    const auto by_market = index_candles(candles_1m);
     for (const auto& t : tickers) {
-        auto it = std::find_if(candles_1m.begin(), candles_1m.end(), [&](const auto& p){return p.first==t.market;});
-        if (it == candles_1m.end()) continue;
-        double rv = realized_vol_1m(it->second);
+        auto it = by_market.find(t.market);
+        if (it == by_market.end()) continue;
+        double rv = realized_vol_1m(*it->second, closes);
         double score = std::log(std::max(1e-9, t.acc_trade_price_24h)) * rv;
         if (score > best) { best = score; best_mkt = t.market; }
     }
     return best_mkt;
 }
 
+std::vector<std::string> MarketSelector::select_top_markets(
+    const std::vector<Ticker24h>& tickers,
+    const std::vector<std::pair<std::string, std::vector<Candle>>>& candles_1m,
+    size_t n) {
+
+    std::vector<std::pair<double, std::string>> scored;
+    std::vector<double> closes;
+    const auto by_market = index_candles(candles_1m);
+    for (const auto& t : tickers) {
+        auto it = by_market.find(t.market);
+        if (it == by_market.end()) continue;
+        double rv = realized_vol_1m(*it->second, closes);
+        scored.emplace_back(std::log(std::max(1e-9, t.acc_trade_price_24h)) * rv, t.market);
+    }
+    n = std::min(n, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end(),
+                      [](const auto& a, const auto& b){return a.first > b.first;});
+    std::vector<std::string> out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) out.push_back(std::move(scored[i].second));
+    return out;
+}
+
+
+double volatility_turnover_score(const MarketStats& s) {
+    return std::log(std::max(1e-9, s.turnover_24h)) * s.realized_vol;
+}
+
+MarketRanker::MarketRanker(size_t window, MarketScoreFn score)
+    : window_(std::max<size_t>(1, window)), score_(std::move(score)) {}
+
+MarketRanker::Entry& MarketRanker::entry(std::string_view market) {
+    auto it = index_.find(market);
+    if (it != index_.end()) return entries_[it->second];
+    entries_.emplace_back(std::string(market), window_);
+    index_.emplace(entries_.back().code, entries_.size() - 1);
+    return entries_.back();
+}
+
+void MarketRanker::close_minute(Entry& e) {
+    const double close = e.stats.last_price;
+    if (e.prev_close > 0.0 && close > 0.0) {
+        const double r = std::log(close / e.prev_close);
+        e.sq_returns.push(r * r);
+        e.stats.returns = std::min(e.stats.returns + 1, window_);
+        e.stats.realized_vol = std::sqrt(e.sq_returns.value());
+    }
+    e.prev_close = close;
+}
+
+void MarketRanker::set_turnover(std::string_view market, double krw_24h) {
+    entry(market).stats.turnover_24h = krw_24h;
+}
+
+void MarketRanker::seed(std::string_view market, CandleSpan bars_1m) {
+    Entry& e = entry(market);
+    e.sq_returns.reset();
+    e.stats.returns = 0;
+    e.stats.realized_vol = 0.0;
+    e.stats.last_price = 0.0;
+    e.prev_close = 0.0;
+    e.minute = 0;
+    if (bars_1m.empty()) return;
+    for (size_t i = 0; i + 1 < bars_1m.size(); ++i) {
+        e.stats.last_price = bars_1m[i].close;
+        close_minute(e);
+    }
+    e.stats.last_price = bars_1m.back().close;
+    e.minute = bar_open_ms(bars_1m.back().ts_ms, Timeframe::M1);
+}
+
+bool MarketRanker::on_trade(std::string_view market, long long ts_ms, double price) {
+    Entry& e = entry(market);
+    const long long minute = bar_open_ms(ts_ms, Timeframe::M1);
+    bool closed = false;
+    if (e.minute != 0) {
+        if (minute < e.minute) return false;
+        if (minute > e.minute) {
+            close_minute(e);
+            closed = true;
+        }
+    }
+    e.minute = minute;
+    e.stats.last_price = price;
+    return closed;
+}
+
+std::vector<RankedMarket> MarketRanker::top(size_t n) const {
+    scratch_.clear();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].stats.returns == 0) continue;
+        scratch_.emplace_back(score_(entries_[i].stats), i);
+    }
+    n = std::min(n, scratch_.size());
+    std::partial_sort(scratch_.begin(), scratch_.begin() + static_cast<std::ptrdiff_t>(n), scratch_.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::vector<RankedMarket> out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) out.push_back(RankedMarket{entries_[scratch_[i].second].code, scratch_[i].first});
+    return out;
+}
+
+const MarketStats* MarketRanker::stats(std::string_view market) const {
+    auto it = index_.find(market);
+    return it != index_.end() ? &entries_[it->second].stats : nullptr;
+}
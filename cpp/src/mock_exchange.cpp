@@ -0,0 +1,1292 @@
+#include "mock_exchange.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "backtest.hpp"
+#include "json_scan.hpp"
+#include "rate_limiter.hpp"
+#include "upbit_rest.hpp"
+
+namespace {
+
+constexpr long long kMinuteMs = 60'000;
+constexpr long long kDayMs = 24 * 60 * kMinuteMs;
+constexpr long long kKstOffsetMs = 9 * 60 * kMinuteMs;
+constexpr size_t kMaxMinutes = 200 * 240; // enough for 200 four-hour candles
+constexpr size_t kMaxHeaderBytes = 64 * 1024;
+constexpr int kMaxCandleCount = 200;
+constexpr double kMinTotalKrw = 5000.0;
+constexpr char kWsGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+long long wall_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool send_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        const ssize_t k = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += k;
+        n -= static_cast<size_t>(k);
+    }
+    return true;
+}
+
+bool recv_some(int fd, std::string& buf) {
+    char tmp[16 * 1024];
+    while (true) {
+        const ssize_t k = ::recv(fd, tmp, sizeof(tmp), 0);
+        if (k > 0) {
+            buf.append(tmp, static_cast<size_t>(k));
+            return true;
+        }
+        if (k < 0 && errno == EINTR) continue;
+        return false;
+    }
+}
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string url_decode(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '+') {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size() && hex_digit(s[i + 1]) >= 0 && hex_digit(s[i + 2]) >= 0) {
+            out += static_cast<char>(hex_digit(s[i + 1]) * 16 + hex_digit(s[i + 2]));
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+std::string query_param(std::string_view query, std::string_view key) {
+    while (!query.empty()) {
+        const size_t amp = query.find('&');
+        const std::string_view pair = query.substr(0, amp);
+        const size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == key) return eq == std::string_view::npos ? std::string() : url_decode(pair.substr(eq + 1));
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return {};
+}
+
+std::string time_string(long long ms, long long offset_ms) {
+    const std::time_t secs = static_cast<std::time_t>((ms + offset_ms) / 1000);
+    std::tm tm{};
+    gmtime_r(&secs, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    return buf;
+}
+
+// "2024-01-02T03:04:05" or "2024-01-02 03:04:05", UTC unless followed by
+// Z or +hh:mm / -hh:mm. -1 if unreadable.
+long long parse_time_ms(const std::string& s) {
+    int y = 0, mo = 0, d = 0, h = 0, mi = 0, se = 0, used = 0;
+    if (std::sscanf(s.c_str(), "%d-%d-%d%*1[T ]%d:%d:%d%n", &y, &mo, &d, &h, &mi, &se, &used) < 6) return -1;
+    std::tm tm{};
+    tm.tm_year = y - 1900;
+    tm.tm_mon = mo - 1;
+    tm.tm_mday = d;
+    tm.tm_hour = h;
+    tm.tm_min = mi;
+    tm.tm_sec = se;
+    long long ms = static_cast<long long>(timegm(&tm)) * 1000;
+    const char* rest = s.c_str() + used;
+    int oh = 0, om = 0;
+    if ((*rest == '+' || *rest == '-') && std::sscanf(rest + 1, "%d:%d", &oh, &om) == 2) {
+        const long long off = (oh * 60LL + om) * kMinuteMs;
+        ms += *rest == '+' ? -off : off;
+    }
+    return ms;
+}
+
+void append_number(std::string& out, double v) {
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof(buf), "%.10g", v);
+    out.append(buf, static_cast<size_t>(n));
+}
+
+// Flat JSON object writer for replies and frames; values never need escaping.
+class JsonObject {
+public:
+    explicit JsonObject(std::string& out) : out_(out) { out_ += '{'; }
+    ~JsonObject() { out_ += '}'; }
+
+    JsonObject& num(const char* key, double v) {
+        name(key);
+        append_number(out_, v);
+        return *this;
+    }
+    JsonObject& integer(const char* key, long long v) {
+        name(key);
+        out_ += std::to_string(v);
+        return *this;
+    }
+    // Numbers the exchange API sends as strings.
+    JsonObject& decimal(const char* key, double v) {
+        name(key);
+        out_ += '"';
+        append_number(out_, v);
+        out_ += '"';
+        return *this;
+    }
+    JsonObject& str(const char* key, std::string_view v) {
+        name(key);
+        out_ += '"';
+        out_ += v;
+        out_ += '"';
+        return *this;
+    }
+    JsonObject& null(const char* key) {
+        name(key);
+        out_ += "null";
+        return *this;
+    }
+
+private:
+    void name(const char* key) {
+        if (!first_) out_ += ',';
+        first_ = false;
+        out_ += '"';
+        out_ += key;
+        out_ += "\":";
+    }
+
+    std::string& out_;
+    bool first_{true};
+};
+
+std::string error_body(const char* name, const char* message) {
+    return std::string("{\"error\":{\"name\":\"") + name + "\",\"message\":\"" + message + "\"}}";
+}
+
+std::string websocket_accept(const std::string& key) {
+    const std::string in = key + kWsGuid;
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char*>(in.data()), in.size(), digest);
+    unsigned char out[4 * ((SHA_DIGEST_LENGTH + 2) / 3) + 1];
+    const int n = EVP_EncodeBlock(out, digest, SHA_DIGEST_LENGTH);
+    return std::string(reinterpret_cast<const char*>(out), static_cast<size_t>(n));
+}
+
+const char* reason(int status) {
+    switch (status) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 429: return "Too Many Requests";
+    default: return "Error";
+    }
+}
+
+struct HttpIn {
+    std::string method;
+    std::string path;
+    std::string query;
+    std::vector<std::pair<std::string, std::string>> headers; // names lower-cased
+    std::string body;
+
+    std::string header(std::string_view name) const {
+        for (const auto& [k, v] : headers) {
+            if (k == name) return v;
+        }
+        return {};
+    }
+};
+
+// Reads one request off the connection (bytes past it stay in `buf`).
+bool read_request(int fd, std::string& buf, HttpIn& req) {
+    size_t end;
+    while ((end = buf.find("\r\n\r\n")) == std::string::npos) {
+        if (buf.size() > kMaxHeaderBytes || !recv_some(fd, buf)) return false;
+    }
+    const std::string_view head(buf.data(), end);
+    size_t line_end = head.find("\r\n");
+    const std::string_view line = head.substr(0, line_end);
+    const size_t sp1 = line.find(' ');
+    const size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp1 == std::string_view::npos || sp2 == std::string_view::npos) return false;
+    req = HttpIn{};
+    req.method = std::string(line.substr(0, sp1));
+    const std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    const size_t q = target.find('?');
+    req.path = std::string(target.substr(0, q));
+    if (q != std::string_view::npos) req.query = std::string(target.substr(q + 1));
+
+    while (line_end != std::string_view::npos && line_end < head.size()) {
+        const size_t start = line_end + 2;
+        line_end = head.find("\r\n", start);
+        const std::string_view h = head.substr(start, line_end == std::string_view::npos ? std::string_view::npos : line_end - start);
+        const size_t colon = h.find(':');
+        if (colon == std::string_view::npos) continue;
+        std::string name(h.substr(0, colon));
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        std::string_view value = h.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        req.headers.emplace_back(std::move(name), std::string(value));
+    }
+    buf.erase(0, end + 4);
+
+    const size_t length = static_cast<size_t>(std::strtoull(req.header("content-length").c_str(), nullptr, 10));
+    if (length > 0 && buf.size() < length && req.header("expect") == "100-continue") {
+        static constexpr char kContinue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        if (!send_all(fd, kContinue, sizeof(kContinue) - 1)) return false;
+    }
+    while (buf.size() < length) {
+        if (!recv_some(fd, buf)) return false;
+    }
+    req.body = buf.substr(0, length);
+    buf.erase(0, length);
+    return true;
+}
+
+// Pops one frame off `buf`: 1 if complete, 0 if more bytes are needed, -1
+// if it is not a masked client frame.
+int take_ws_frame(std::string& buf, int& opcode, bool& fin, std::string& payload) {
+    if (buf.size() < 2) return 0;
+    const auto* b = reinterpret_cast<const unsigned char*>(buf.data());
+    fin = (b[0] & 0x80) != 0;
+    opcode = b[0] & 0x0f;
+    if ((b[1] & 0x80) == 0) return -1;
+    unsigned long long len = b[1] & 0x7f;
+    size_t pos = 2;
+    if (len == 126) {
+        if (buf.size() < 4) return 0;
+        len = (static_cast<unsigned long long>(b[2]) << 8) | b[3];
+        pos = 4;
+    } else if (len == 127) {
+        if (buf.size() < 10) return 0;
+        len = 0;
+        for (int i = 0; i < 8; ++i) len = (len << 8) | b[2 + i];
+        pos = 10;
+    }
+    if (len > (1ULL << 24)) return -1;
+    if (buf.size() < pos + 4 + len) return 0;
+    const unsigned char* mask = b + pos;
+    pos += 4;
+    payload.resize(static_cast<size_t>(len));
+    for (size_t i = 0; i < len; ++i) payload[i] = static_cast<char>(b[pos + i] ^ mask[i % 4]);
+    buf.erase(0, pos + static_cast<size_t>(len));
+    return 1;
+}
+
+struct BookSide {
+    std::array<double, OrderbookSnapshot::kMaxLevels> price{};
+    std::array<double, OrderbookSnapshot::kMaxLevels> size{};
+};
+
+} // namespace
+
+struct MockUpbitServer::Impl {
+    struct MinuteBar {
+        Candle bar;        // ts_ms = start of the minute
+        long long last_ms; // newest print in it
+        double notional;
+    };
+
+    struct Order {
+        std::string uuid;
+        std::string identifier;
+        size_t market;
+        std::uint64_t sim_id;
+        std::string sim_uuid;
+        bool is_buy;
+        std::string ord_type;
+        double price;  // limit price, or KRW for a market buy
+        double volume; // 0 for a market buy
+        double executed{0.0};
+        double funds{0.0};
+        double paid_fee{0.0};
+        int trades{0};
+        std::string state{"wait"};
+        long long created_ms;
+    };
+
+    struct Market {
+        std::string code;
+        std::vector<TradeRecord> tape;
+        size_t cursor{0};
+        long long offset{0}; // added to tape time, grows each time the tape loops
+        std::vector<MinuteBar> minutes;
+        long long last_wall{0};
+        double last_price{0.0};
+        SimulatedExchange exchange;
+        std::unordered_map<std::uint64_t, std::string> orders_by_sim_id;
+
+        long long next_ts() const { return tape[cursor].ts_ms + offset; }
+    };
+
+    struct Conn {
+        int fd; // -1 once closed, under write_mutex
+        std::mutex write_mutex;
+        std::mutex sub_mutex;
+        std::vector<char> trade, book, my_orders; // per market
+        bool simple{false};
+        bool authorized{false};
+        std::atomic<bool> ws{false};
+    };
+
+    // A connection's thread; `done` is set when it returns, so it can be joined early.
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    struct RateWindow {
+        long long sec{-1};
+        int sec_count{0};
+        long long min{-1};
+        int min_count{0};
+    };
+
+    struct Reply {
+        int status{200};
+        std::string body;
+        std::string remaining_req;
+    };
+
+    // One print's frames, formatted on first use.
+    struct PrintFrames {
+        size_t market;
+        TradeRecord trade;
+        BookSide asks, bids;
+        int levels;
+        std::string trade_default, trade_simple, book_default, book_simple;
+        std::vector<std::string> my_orders;
+    };
+
+    explicit Impl(MockExchangeConfig c) : config(std::move(c)), rng(config.seed) {}
+
+    MockExchangeConfig config;
+    std::vector<Market> markets;
+    std::map<std::string, size_t, std::less<>> market_index;
+    std::unordered_map<std::string, Order> orders;
+    std::unordered_map<std::string, std::string> uuid_by_identifier;
+    std::uint64_t next_order{1};
+    std::array<RateWindow, 4> windows{};
+    std::mt19937_64 rng;
+    std::vector<SimFill> fills;
+    std::mutex mutex; // everything above
+
+    long long wall_start{0};
+    long long cut{0}; // tape time the feed starts from
+
+    int listen_fd{-1};
+    int bound_port{0};
+    bool started{false};
+    std::atomic<bool> stopping{false};
+    std::thread acceptor;
+    std::thread feeder;
+    std::mutex feed_mutex;
+    std::condition_variable feed_cv;
+
+    std::mutex conns_mutex;
+    std::vector<std::shared_ptr<Conn>> conns;
+    std::vector<Worker> workers;
+
+    std::atomic<std::uint64_t> requests{0}, rate_limited{0}, orders_placed{0}, cancels{0}, filled{0},
+        ws_sessions{0}, frames_sent{0}, bytes_sent{0};
+
+    // --- market data ---
+
+    void record_print(Market& m, const TradeRecord& t, long long wall) {
+        wall = std::max(wall, m.last_wall);
+        m.last_wall = wall;
+        m.last_price = t.price;
+        const long long start = wall / kMinuteMs * kMinuteMs;
+        if (m.minutes.empty() || m.minutes.back().bar.ts_ms != start) {
+            if (m.minutes.size() >= 2 * kMaxMinutes) m.minutes.erase(m.minutes.begin(), m.minutes.begin() + kMaxMinutes);
+            m.minutes.push_back(MinuteBar{Candle{start, t.price, t.price, t.price, t.price, 0.0}, wall, 0.0});
+        }
+        MinuteBar& b = m.minutes.back();
+        b.bar.high = std::max(b.bar.high, t.price);
+        b.bar.low = std::min(b.bar.low, t.price);
+        b.bar.close = t.price;
+        b.bar.volume += t.volume;
+        b.notional += t.price * t.volume;
+        b.last_ms = wall;
+    }
+
+    // Moves the market to its next print, looping the tape so the stream never ends.
+    void advance(Market& m) {
+        if (++m.cursor < m.tape.size()) return;
+        m.cursor = 0;
+        m.offset += m.tape.back().ts_ms - m.tape.front().ts_ms + 1000;
+        m.offset = std::max(m.offset, cut - m.tape.front().ts_ms);
+    }
+
+    void synthesize_book(double price, bool buyer_initiated, int levels, BookSide& asks, BookSide& bids) {
+        const double tick = UpbitRestClient::tick_size(price);
+        double ask = buyer_initiated ? price : price + tick;
+        double bid = buyer_initiated ? price - tick : price;
+        std::uniform_real_distribution<double> krw(2e5, 5e6);
+        for (int i = 0; i < levels; ++i) {
+            asks.price[i] = ask;
+            bids.price[i] = std::max(bid, tick);
+            asks.size[i] = krw(rng) / ask;
+            bids.size[i] = krw(rng) / bids.price[i];
+            ask += UpbitRestClient::tick_size(ask);
+            bid -= UpbitRestClient::tick_size(bid);
+        }
+    }
+
+    std::string my_order_frame(const Order& o, const SimFill* fill, long long ts) {
+        const Market& m = markets[o.market];
+        std::string out;
+        JsonObject j(out);
+        j.str("type", "myOrder").str("code", m.code).str("uuid", o.uuid);
+        if (!o.identifier.empty()) j.str("identifier", o.identifier);
+        j.str("ask_bid", o.is_buy ? "BID" : "ASK")
+            .str("side", o.is_buy ? "bid" : "ask") // what EngineBridge reads
+            .str("order_type", o.ord_type).str("state", o.state)
+            .num("price", o.price)
+            .num("avg_price", o.executed > 0.0 ? o.funds / o.executed : 0.0)
+            .num("volume", o.volume)
+            .num("remaining_volume", o.ord_type == "price" ? 0.0 : std::max(0.0, o.volume - o.executed))
+            .num("executed_volume", o.executed)
+            .integer("trades_count", o.trades)
+            .num("paid_fee", o.paid_fee)
+            .num("executed_funds", o.funds);
+        if (fill) {
+            j.num("trade_price", fill->price).num("trade_volume", fill->volume).integer("trade_timestamp", ts)
+                .num("trade_fee", fill->fee);
+        }
+        j.integer("order_timestamp", o.created_ms).integer("timestamp", ts).str("stream_type", "REALTIME");
+        return out;
+    }
+
+    // Replays the market's next print: bars, fills against resting orders,
+    // then the frames for subscribers.
+    void emit(size_t mi, long long wall, PrintFrames& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Market& m = markets[mi];
+        TradeRecord t = m.tape[m.cursor];
+        advance(m);
+        record_print(m, t, wall);
+        t.ts_ms = m.last_wall;
+
+        out.market = mi;
+        out.trade = t;
+        out.levels = std::clamp(config.book_levels, 1, OrderbookSnapshot::kMaxLevels);
+        synthesize_book(t.price, t.is_bid != 0, out.levels, out.asks, out.bids);
+        out.trade_default.clear();
+        out.trade_simple.clear();
+        out.book_default.clear();
+        out.book_simple.clear();
+        out.my_orders.clear();
+
+        fills.clear();
+        m.exchange.on_trade(t, fills);
+        for (const SimFill& f : fills) {
+            const auto id = m.orders_by_sim_id.find(f.order_id);
+            if (id == m.orders_by_sim_id.end()) continue;
+            Order& o = orders[id->second];
+            o.executed += f.volume;
+            o.funds += f.price * f.volume;
+            o.paid_fee += f.fee;
+            ++o.trades;
+            ++filled;
+            if (f.remaining <= 0.0) {
+                o.state = "done";
+                m.orders_by_sim_id.erase(id);
+            } else {
+                o.state = "trade";
+            }
+            out.my_orders.push_back(my_order_frame(o, &f, t.ts_ms));
+        }
+    }
+
+    const std::string& trade_frame(PrintFrames& p, bool simple) {
+        std::string& out = simple ? p.trade_simple : p.trade_default;
+        if (!out.empty()) return out;
+        const TradeRecord& t = p.trade;
+        const std::string& code = markets[p.market].code;
+        JsonObject j(out);
+        if (simple) {
+            j.str("ty", "trade").str("cd", code).integer("tms", t.ts_ms).integer("ttms", t.ts_ms).num("tp", t.price)
+                .num("tv", t.volume).str("ab", t.is_bid ? "BID" : "ASK").integer("sid", t.sequential_id).str("st", "REALTIME");
+        } else {
+            j.str("type", "trade").str("code", code).integer("timestamp", t.ts_ms).integer("trade_timestamp", t.ts_ms)
+                .num("trade_price", t.price).num("trade_volume", t.volume).str("ask_bid", t.is_bid ? "BID" : "ASK")
+                .integer("sequential_id", t.sequential_id).str("stream_type", "REALTIME");
+        }
+        return out;
+    }
+
+    const std::string& book_frame(PrintFrames& p, bool simple) {
+        std::string& out = simple ? p.book_simple : p.book_default;
+        if (!out.empty()) return out;
+        double total_ask = 0.0, total_bid = 0.0;
+        for (int i = 0; i < p.levels; ++i) {
+            total_ask += p.asks.size[i];
+            total_bid += p.bids.size[i];
+        }
+        out += simple ? "{\"ty\":\"orderbook\",\"cd\":\"" : "{\"type\":\"orderbook\",\"code\":\"";
+        out += markets[p.market].code;
+        out += simple ? "\",\"tms\":" : "\",\"timestamp\":";
+        out += std::to_string(p.trade.ts_ms);
+        out += simple ? ",\"tas\":" : ",\"total_ask_size\":";
+        append_number(out, total_ask);
+        out += simple ? ",\"tbs\":" : ",\"total_bid_size\":";
+        append_number(out, total_bid);
+        out += simple ? ",\"obu\":[" : ",\"orderbook_units\":[";
+        for (int i = 0; i < p.levels; ++i) {
+            if (i > 0) out += ',';
+            JsonObject u(out);
+            u.num(simple ? "ap" : "ask_price", p.asks.price[i]).num(simple ? "bp" : "bid_price", p.bids.price[i])
+                .num(simple ? "as" : "ask_size", p.asks.size[i]).num(simple ? "bs" : "bid_size", p.bids.size[i]);
+        }
+        out += simple ? "],\"st\":\"REALTIME\"}" : "],\"stream_type\":\"REALTIME\"}";
+        return out;
+    }
+
+    bool send_ws(Conn& c, int opcode, std::string_view payload) {
+        unsigned char head[10];
+        size_t n = 0;
+        head[n++] = static_cast<unsigned char>(0x80 | opcode);
+        if (payload.size() < 126) {
+            head[n++] = static_cast<unsigned char>(payload.size());
+        } else if (payload.size() < 65536) {
+            head[n++] = 126;
+            head[n++] = static_cast<unsigned char>(payload.size() >> 8);
+            head[n++] = static_cast<unsigned char>(payload.size());
+        } else {
+            head[n++] = 127;
+            for (int i = 7; i >= 0; --i) head[n++] = static_cast<unsigned char>(static_cast<unsigned long long>(payload.size()) >> (8 * i));
+        }
+        iovec iov[2] = {{head, n}, {const_cast<char*>(payload.data()), payload.size()}};
+        size_t left = n + payload.size();
+        std::lock_guard<std::mutex> lock(c.write_mutex);
+        if (c.fd < 0) return false;
+        int first = 0;
+        while (left > 0) {
+            msghdr msg{};
+            msg.msg_iov = iov + first;
+            msg.msg_iovlen = static_cast<size_t>(2 - first);
+            const ssize_t k = ::sendmsg(c.fd, &msg, MSG_NOSIGNAL);
+            if (k < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            left -= static_cast<size_t>(k);
+            size_t done = static_cast<size_t>(k);
+            while (first < 2 && done >= iov[first].iov_len) done -= iov[first++].iov_len;
+            if (first < 2) {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + done;
+                iov[first].iov_len -= done;
+            }
+        }
+        ++frames_sent;
+        bytes_sent += n + payload.size();
+        return true;
+    }
+
+    // Sends go to a copy of the list: a slow client must not hold up
+    // accepts and teardown of the others.
+    std::vector<std::shared_ptr<Conn>> ws_conns() {
+        std::lock_guard<std::mutex> lock(conns_mutex);
+        std::vector<std::shared_ptr<Conn>> out;
+        out.reserve(conns.size());
+        for (const auto& c : conns) {
+            if (c->ws) out.push_back(c);
+        }
+        return out;
+    }
+
+    void broadcast(PrintFrames& p) {
+        for (const auto& c : ws_conns()) {
+            if (!c->ws) continue;
+            bool trade, book, mine, simple;
+            {
+                std::lock_guard<std::mutex> sub(c->sub_mutex);
+                trade = c->trade[p.market] != 0;
+                book = c->book[p.market] != 0;
+                mine = c->my_orders[p.market] != 0;
+                simple = c->simple;
+            }
+            if (trade) send_ws(*c, 2, trade_frame(p, simple));
+            if (book) send_ws(*c, 2, book_frame(p, simple));
+            if (mine) {
+                for (const auto& f : p.my_orders) send_ws(*c, 2, f);
+            }
+        }
+    }
+
+    void publish_my_order(size_t market, const std::string& frame) {
+        for (const auto& c : ws_conns()) {
+            bool mine;
+            {
+                std::lock_guard<std::mutex> sub(c->sub_mutex);
+                mine = c->my_orders[market] != 0;
+            }
+            if (mine) send_ws(*c, 2, frame);
+        }
+    }
+
+    void feed_loop() {
+        using Next = std::pair<long long, size_t>; // (tape time, market)
+        std::priority_queue<Next, std::vector<Next>, std::greater<Next>> heap;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < markets.size(); ++i) {
+                if (!markets[i].tape.empty()) heap.emplace(markets[i].next_ts(), i);
+            }
+        }
+        PrintFrames frames;
+        while (!stopping && !heap.empty()) {
+            const auto [ts, mi] = heap.top();
+            heap.pop();
+            long long wall;
+            if (config.feed_speed > 0.0) {
+                wall = wall_start + static_cast<long long>(static_cast<double>(ts - cut) / config.feed_speed);
+                std::unique_lock<std::mutex> lock(feed_mutex);
+                const auto due = std::chrono::system_clock::time_point(std::chrono::milliseconds(wall));
+                if (feed_cv.wait_until(lock, due, [this] { return stopping.load(); })) break;
+            } else {
+                wall = wall_ms();
+            }
+            emit(mi, wall, frames);
+            broadcast(frames);
+            std::lock_guard<std::mutex> lock(mutex);
+            heap.emplace(markets[mi].next_ts(), mi);
+        }
+    }
+
+    // --- REST ---
+
+    bool admit(RateGroup group, const char* name, int limit, Reply& reply) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool allowed = true;
+        if (limit > 0) {
+            RateWindow& w = windows[static_cast<size_t>(group)];
+            const long long now = wall_ms();
+            if (w.sec != now / 1000) {
+                w.sec = now / 1000;
+                w.sec_count = 0;
+            }
+            if (w.min != now / kMinuteMs) {
+                w.min = now / kMinuteMs;
+                w.min_count = 0;
+            }
+            const int sec_left = limit - ++w.sec_count;
+            const int min_left = limit * 60 - ++w.min_count;
+            reply.remaining_req = std::string("group=") + name + "; min=" + std::to_string(std::max(0, min_left)) +
+                                  "; sec=" + std::to_string(std::max(0, sec_left));
+            allowed = sec_left >= 0 && min_left >= 0;
+        }
+        if (allowed && config.reject_ratio > 0.0) {
+            allowed = std::uniform_real_distribution<double>(0.0, 1.0)(rng) >= config.reject_ratio;
+        }
+        if (!allowed) {
+            reply.status = 429;
+            reply.body = error_body("too_many_requests", "Too many API requests.");
+            ++rate_limited;
+        }
+        return allowed;
+    }
+
+    Reply handle(const HttpIn& req) {
+        Reply r;
+        ++requests;
+        const std::string& p = req.path;
+        if (req.method == "GET" && p == "/v1/market/all") {
+            if (admit(RateGroup::Market, "market", config.market_per_sec, r)) market_all(r);
+        } else if (req.method == "GET" && p == "/v1/ticker") {
+            if (admit(RateGroup::Market, "ticker", config.market_per_sec, r)) ticker(req, r);
+        } else if (req.method == "GET" && p.rfind("/v1/candles/minutes/", 0) == 0) {
+            if (admit(RateGroup::Candles, "candles", config.candles_per_sec, r)) candles(req, r);
+        } else if (req.method == "POST" && p == "/v1/orders") {
+            if (authorized(req, r) && admit(RateGroup::Order, "order", config.order_per_sec, r)) place(req, r);
+        } else if (req.method == "DELETE" && p == "/v1/order") {
+            if (authorized(req, r) && admit(RateGroup::Order, "order", config.order_per_sec, r)) cancel(req, r);
+        } else if (req.method == "GET" && p == "/v1/order") {
+            if (authorized(req, r) && admit(RateGroup::Default, "default", config.default_per_sec, r)) order_status(req, r);
+        } else {
+            r.status = 404;
+            r.body = error_body("not_found", "Not found");
+        }
+        return r;
+    }
+
+    static bool authorized(const HttpIn& req, Reply& r) {
+        if (req.header("authorization").rfind("Bearer ", 0) == 0) return true;
+        r.status = 401;
+        r.body = error_body("jwt_verification", "Missing Authorization header");
+        return false;
+    }
+
+    void market_all(Reply& r) {
+        r.body = "[";
+        for (size_t i = 0; i < markets.size(); ++i) {
+            if (i > 0) r.body += ',';
+            JsonObject(r.body).str("market", markets[i].code).str("korean_name", markets[i].code).str("english_name", markets[i].code);
+        }
+        r.body += ']';
+    }
+
+    void ticker(const HttpIn& req, Reply& r) {
+        const std::string list = query_param(req.query, "markets");
+        std::lock_guard<std::mutex> lock(mutex);
+        r.body = "[";
+        bool any = false;
+        size_t pos = 0;
+        while (pos <= list.size()) {
+            const size_t comma = std::min(list.find(',', pos), list.size());
+            const auto it = market_index.find(std::string_view(list).substr(pos, comma - pos));
+            pos = comma + 1;
+            if (it == market_index.end()) continue;
+            const Market& m = markets[it->second];
+            if (m.minutes.empty()) continue;
+            double open = 0.0, high = 0.0, low = 0.0, volume = 0.0, notional = 0.0;
+            const long long since = m.last_wall - kDayMs;
+            for (auto b = m.minutes.rbegin(); b != m.minutes.rend() && b->bar.ts_ms >= since; ++b) {
+                open = b->bar.open;
+                high = std::max(high, b->bar.high);
+                low = low > 0.0 ? std::min(low, b->bar.low) : b->bar.low;
+                volume += b->bar.volume;
+                notional += b->notional;
+            }
+            if (any) r.body += ',';
+            any = true;
+            JsonObject(r.body).str("market", m.code).num("opening_price", open).num("high_price", high).num("low_price", low)
+                .num("trade_price", m.last_price).num("prev_closing_price", open)
+                .num("acc_trade_price_24h", notional).num("acc_trade_volume_24h", volume).integer("timestamp", m.last_wall);
+        }
+        r.body += ']';
+        if (!any) {
+            r.status = 404;
+            r.body = error_body("404", "Code not found");
+        }
+    }
+
+    void candles(const HttpIn& req, Reply& r) {
+        static constexpr int kUnits[] = {1, 3, 5, 10, 15, 30, 60, 240};
+        const int unit = static_cast<int>(std::strtol(req.path.c_str() + std::strlen("/v1/candles/minutes/"), nullptr, 10));
+        const int count = std::clamp(static_cast<int>(std::strtol(query_param(req.query, "count").c_str(), nullptr, 10)), 1, kMaxCandleCount);
+        const std::string to = query_param(req.query, "to");
+        const long long to_ms = to.empty() ? LLONG_MAX : parse_time_ms(to);
+        if (std::find(std::begin(kUnits), std::end(kUnits), unit) == std::end(kUnits) || to_ms < 0) {
+            r.status = 400;
+            r.body = error_body("invalid_parameter", "Invalid unit or to");
+            return;
+        }
+        const std::string market = query_param(req.query, "market");
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = market_index.find(market);
+        if (it == market_index.end()) {
+            r.status = 404;
+            r.body = error_body("404", "Code not found");
+            return;
+        }
+        const Market& m = markets[it->second];
+        const long long period = unit * kMinuteMs;
+
+        // newest first, folding minutes into unit-sized buckets
+        r.body = "[";
+        int emitted = 0;
+        auto b = m.minutes.rbegin();
+        while (b != m.minutes.rend() && b->bar.ts_ms / period * period >= to_ms) ++b;
+        while (b != m.minutes.rend() && emitted < count) {
+            const long long start = b->bar.ts_ms / period * period;
+            Candle c = b->bar;
+            const long long last_ms = b->last_ms;
+            double notional = 0.0;
+            for (; b != m.minutes.rend() && b->bar.ts_ms >= start; ++b) {
+                c.open = b->bar.open;
+                c.high = std::max(c.high, b->bar.high);
+                c.low = std::min(c.low, b->bar.low);
+                notional += b->notional;
+                if (b->bar.ts_ms != c.ts_ms) c.volume += b->bar.volume;
+            }
+            if (emitted++ > 0) r.body += ',';
+            JsonObject(r.body).str("market", m.code).str("candle_date_time_utc", time_string(start, 0))
+                .str("candle_date_time_kst", time_string(start, kKstOffsetMs)).num("opening_price", c.open)
+                .num("high_price", c.high).num("low_price", c.low).num("trade_price", c.close).integer("timestamp", last_ms)
+                .num("candle_acc_trade_price", notional).num("candle_acc_trade_volume", c.volume).integer("unit", unit);
+        }
+        r.body += ']';
+    }
+
+    std::string order_json(const Order& o) {
+        std::string out;
+        JsonObject j(out);
+        j.str("uuid", o.uuid).str("side", o.is_buy ? "bid" : "ask").str("ord_type", o.ord_type);
+        if (!o.identifier.empty()) j.str("identifier", o.identifier);
+        if (o.ord_type == "market") j.null("price");
+        else j.decimal("price", o.price);
+        j.str("state", o.state).str("market", markets[o.market].code)
+            .str("created_at", time_string(o.created_ms, kKstOffsetMs) + "+09:00");
+        if (o.ord_type == "price") j.null("volume").null("remaining_volume");
+        else j.decimal("volume", o.volume).decimal("remaining_volume", std::max(0.0, o.volume - o.executed));
+        j.decimal("paid_fee", o.paid_fee).decimal("executed_volume", o.executed).integer("trades_count", o.trades);
+        return out;
+    }
+
+    void place(const HttpIn& req, Reply& r) {
+        std::string market, side, ord_type, identifier;
+        double price = 0.0, volume = 0.0;
+        json_for_each_member(req.body, [&](std::string_view key, std::string_view value) {
+            const std::string_view v = json_unquote(value);
+            if (key == "market") market = std::string(v);
+            else if (key == "side") side = std::string(v);
+            else if (key == "ord_type") ord_type = std::string(v);
+            else if (key == "price") json_to_double(v, price);
+            else if (key == "volume") json_to_double(v, volume);
+            else if (key == "identifier") identifier = std::string(v);
+            return true;
+        });
+        const bool is_buy = side == "bid";
+        const bool valid_type = ord_type == "limit" || (ord_type == "price" && is_buy) || (ord_type == "market" && !is_buy);
+        if ((side != "bid" && side != "ask") || !valid_type) {
+            r.status = 400;
+            r.body = error_body("invalid_parameter", "Invalid side or ord_type");
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = market_index.find(market);
+        if (it == market_index.end()) {
+            r.status = 404;
+            r.body = error_body("market_does_not_exist", "Market does not exist");
+            return;
+        }
+        if (!identifier.empty() && uuid_by_identifier.count(identifier)) {
+            r.status = 400;
+            r.body = error_body("duplicate_identifier", "Identifier already used");
+            return;
+        }
+        Market& m = markets[it->second];
+        const double total = ord_type == "limit" ? price * volume : ord_type == "price" ? price : volume * m.last_price;
+        if (total < kMinTotalKrw) {
+            r.status = 400;
+            r.body = error_body(is_buy ? "under_min_total_bid" : "under_min_total_ask", "Order total below minimum");
+            return;
+        }
+        OrderRequest post;
+        post.market = market;
+        post.side = side;
+        post.ord_type = ord_type;
+        post.price = price;
+        post.volume = volume;
+        const OrderResult sim = m.exchange.post_order(post);
+        if (!sim.accepted) {
+            r.status = sim.http_status;
+            r.body = error_body("invalid_parameter", sim.error_message.c_str());
+            return;
+        }
+        Order o;
+        char uuid[40];
+        std::snprintf(uuid, sizeof(uuid), "%08x-0000-4000-a000-%012llx", config.seed, static_cast<unsigned long long>(next_order++));
+        o.uuid = uuid;
+        o.identifier = identifier;
+        o.market = it->second;
+        o.sim_id = m.exchange.last_order_id();
+        o.sim_uuid = sim.uuid;
+        o.is_buy = is_buy;
+        o.ord_type = ord_type;
+        o.price = ord_type == "market" ? m.last_price : price;
+        o.volume = ord_type == "price" ? 0.0 : volume;
+        o.created_ms = wall_ms();
+        m.orders_by_sim_id[o.sim_id] = o.uuid;
+        if (!identifier.empty()) uuid_by_identifier.emplace(identifier, o.uuid);
+        ++orders_placed;
+        r.status = 201;
+        r.body = order_json(o);
+        pending_events.emplace_back(o.market, my_order_frame(o, nullptr, o.created_ms));
+        orders.emplace(o.uuid, std::move(o));
+    }
+
+    void cancel(const HttpIn& req, Reply& r) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = find_order(req);
+        if (it == orders.end()) {
+            r.status = 404;
+            r.body = error_body("order_not_found", "Order not found");
+            return;
+        }
+        Order& o = it->second;
+        Market& m = markets[o.market];
+        if (o.state != "wait" && o.state != "trade") {
+            r.status = 400;
+            r.body = error_body("invalid_order_state", "Order is already closed");
+            return;
+        }
+        m.exchange.cancel_order(CancelRequest{o.sim_uuid});
+        m.orders_by_sim_id.erase(o.sim_id);
+        r.body = order_json(o); // as Upbit does, the reply still shows the pre-cancel state
+        o.state = "cancel";
+        ++cancels;
+        pending_events.emplace_back(o.market, my_order_frame(o, nullptr, wall_ms()));
+    }
+
+    // By ?uuid= or ?identifier=; call with the mutex held.
+    std::unordered_map<std::string, Order>::iterator find_order(const HttpIn& req) {
+        std::string uuid = query_param(req.query, "uuid");
+        if (uuid.empty()) {
+            const auto id = uuid_by_identifier.find(query_param(req.query, "identifier"));
+            if (id != uuid_by_identifier.end()) uuid = id->second;
+        }
+        return orders.find(uuid);
+    }
+
+    void order_status(const HttpIn& req, Reply& r) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = find_order(req);
+        if (it == orders.end()) {
+            r.status = 404;
+            r.body = error_body("order_not_found", "Order not found");
+            return;
+        }
+        r.body = order_json(it->second);
+    }
+
+    // myOrder frames raised by REST calls, sent once the mutex is released
+    std::vector<std::pair<size_t, std::string>> pending_events;
+
+    void flush_events() {
+        std::vector<std::pair<size_t, std::string>> events;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.swap(pending_events);
+        }
+        for (const auto& [market, frame] : events) publish_my_order(market, frame);
+    }
+
+    // --- connections ---
+
+    void subscribe(Conn& c, const std::string& message) {
+        std::vector<char> trade(markets.size(), 0), book(markets.size(), 0), mine(markets.size(), 0);
+        bool simple = false;
+        bool auth = c.authorized;
+        bool wants_private = false;
+        json_for_each_element(message, [&](std::string_view elem) {
+            std::string type;
+            std::vector<std::string> codes;
+            json_for_each_member(elem, [&](std::string_view key, std::string_view value) {
+                if (key == "type") {
+                    type = std::string(json_unquote(value));
+                } else if (key == "codes") {
+                    json_for_each_element(value, [&](std::string_view code) {
+                        codes.emplace_back(json_unquote(code));
+                        return true;
+                    });
+                } else if (key == "format") {
+                    simple = json_unquote(value).substr(0, 6) == "SIMPLE";
+                } else if (key == "authorization") {
+                    auth = !json_unquote(value).empty();
+                }
+                return true;
+            });
+            const bool is_private = type == "myOrder" || type == "myOrders";
+            std::vector<char>* target = type == "trade" ? &trade : type == "orderbook" ? &book : is_private ? &mine : nullptr;
+            if (!target) return true;
+            wants_private = wants_private || is_private;
+            if (is_private && codes.empty()) std::fill(target->begin(), target->end(), 1);
+            for (const auto& code : codes) {
+                const auto it = market_index.find(code);
+                if (it != market_index.end()) (*target)[it->second] = 1;
+            }
+            return true;
+        });
+        if (wants_private && !auth) {
+            std::fill(mine.begin(), mine.end(), 0);
+            send_ws(c, 2, error_body("INVALID_AUTH", "myOrder needs an authorization token"));
+        }
+        std::lock_guard<std::mutex> lock(c.sub_mutex);
+        c.trade.swap(trade);
+        c.book.swap(book);
+        c.my_orders.swap(mine);
+        c.simple = simple;
+        c.authorized = auth;
+    }
+
+    void ws_session(Conn& c, const HttpIn& req, std::string& buf) {
+        const std::string key = req.header("sec-websocket-key");
+        if (key.empty()) return;
+        const std::string reply = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                  "Sec-WebSocket-Accept: " + websocket_accept(key) + "\r\n\r\n";
+        {
+            std::lock_guard<std::mutex> lock(c.write_mutex);
+            if (!send_all(c.fd, reply.data(), reply.size())) return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(c.sub_mutex);
+            c.trade.assign(markets.size(), 0);
+            c.book.assign(markets.size(), 0);
+            c.my_orders.assign(markets.size(), 0);
+            c.authorized = req.header("authorization").rfind("Bearer ", 0) == 0;
+        }
+        c.ws = true;
+        ++ws_sessions;
+
+        std::string message, payload;
+        while (!stopping) {
+            int opcode = 0;
+            bool fin = false;
+            const int got = take_ws_frame(buf, opcode, fin, payload);
+            if (got < 0) break;
+            if (got == 0) {
+                if (!recv_some(c.fd, buf)) break;
+                continue;
+            }
+            if (opcode == 8) {
+                send_ws(c, 8, payload);
+                break;
+            }
+            if (opcode == 9) {
+                send_ws(c, 10, payload);
+                continue;
+            }
+            if (opcode == 10) continue;
+            message += payload;
+            if (!fin) continue;
+            subscribe(c, message);
+            message.clear();
+        }
+    }
+
+    void serve(std::shared_ptr<Conn> c) {
+        std::string buf;
+        HttpIn req;
+        while (!stopping && read_request(c->fd, buf, req)) {
+            if (req.header("upgrade") == "websocket" || req.header("upgrade") == "WebSocket") {
+                if (req.path == "/websocket/v1") ws_session(*c, req, buf);
+                break;
+            }
+            const Reply r = handle(req);
+            flush_events();
+            long long delay = config.latency_us;
+            if (config.jitter_us > 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                delay += std::uniform_int_distribution<long long>(0, config.jitter_us)(rng);
+            }
+            if (delay > 0) std::this_thread::sleep_for(std::chrono::microseconds(delay));
+
+            std::string out = "HTTP/1.1 " + std::to_string(r.status) + ' ' + reason(r.status) +
+                              "\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: " +
+                              std::to_string(r.body.size()) + "\r\n";
+            if (!r.remaining_req.empty()) out += "Remaining-Req: " + r.remaining_req + "\r\n";
+            out += "\r\n";
+            out += r.body;
+            {
+                std::lock_guard<std::mutex> lock(c->write_mutex);
+                if (!send_all(c->fd, out.data(), out.size())) break;
+            }
+            if (req.header("connection") == "close") break;
+        }
+        // out of the list first so the feed can no longer write to the fd
+        {
+            std::lock_guard<std::mutex> lock(conns_mutex);
+            conns.erase(std::remove(conns.begin(), conns.end(), c), conns.end());
+        }
+        // a feed send may still hold a copy of `c`
+        std::lock_guard<std::mutex> lock(c->write_mutex);
+        ::close(c->fd);
+        c->fd = -1;
+    }
+
+    // Joins the threads of connections that have ended. Under conns_mutex.
+    void reap_workers() {
+        auto ended = std::partition(workers.begin(), workers.end(), [](const Worker& w) { return !*w.done; });
+        for (auto it = ended; it != workers.end(); ++it) it->thread.join();
+        workers.erase(ended, workers.end());
+    }
+
+    void accept_loop() {
+        while (!stopping) {
+            const int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (stopping) break;
+                if (errno != EINTR) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            auto c = std::make_shared<Conn>();
+            c->fd = fd;
+            auto done = std::make_shared<std::atomic<bool>>(false);
+            std::lock_guard<std::mutex> lock(conns_mutex);
+            reap_workers();
+            conns.push_back(c);
+            workers.push_back(Worker{std::thread([this, c, done] {
+                serve(c);
+                *done = true;
+            }), done});
+        }
+    }
+};
+
+MockUpbitServer::MockUpbitServer(MockExchangeConfig config) : impl_(std::make_unique<Impl>(std::move(config))) {}
+
+MockUpbitServer::~MockUpbitServer() {
+    stop();
+}
+
+void MockUpbitServer::add_market(const std::string& market, std::vector<TradeRecord> tape) {
+    Impl& s = *impl_;
+    if (s.started || s.market_index.count(market)) return;
+    s.market_index.emplace(market, s.markets.size());
+    Impl::Market m;
+    m.code = market;
+    m.tape = std::move(tape);
+    m.exchange = SimulatedExchange(FillModel{0, false, UpbitRestClient::taker_fee_rate()});
+    s.markets.push_back(std::move(m));
+}
+
+bool MockUpbitServer::start(std::string* error) {
+    Impl& s = *impl_;
+    if (s.started) return true;
+    if (s.markets.empty()) {
+        for (const char* code : {"KRW-BTC", "KRW-ETH", "KRW-XRP", "KRW-SOL", "KRW-DOGE"}) add_market(code);
+    }
+
+    // synthetic tapes long enough to cover the history and a day of feed
+    const long long start_ms = 1'700'000'000'000LL;
+    const int days = static_cast<int>(1 + s.config.history_ms / kDayMs + 1);
+    static constexpr double kPrices[] = {95'000'000.0, 4'500'000.0, 800.0, 250'000.0, 200.0};
+    for (size_t i = 0; i < s.markets.size(); ++i) {
+        auto& m = s.markets[i];
+        if (!m.tape.empty()) continue;
+        const double price = i < std::size(kPrices) ? kPrices[i] : 1'000.0 * static_cast<double>(i + 1);
+        m.tape = synthetic_tape(start_ms, days, price, s.config.seed + static_cast<unsigned>(i));
+    }
+
+    // replay the history part of every tape into the candles, ending now
+    long long first = LLONG_MAX;
+    for (const auto& m : s.markets) {
+        if (!m.tape.empty()) first = std::min(first, m.tape.front().ts_ms);
+    }
+    s.wall_start = wall_ms();
+    s.cut = first == LLONG_MAX ? 0 : first + std::max(0LL, s.config.history_ms);
+    for (auto& m : s.markets) {
+        if (m.tape.empty()) continue;
+        while (m.cursor < m.tape.size() && m.tape[m.cursor].ts_ms < s.cut) {
+            const TradeRecord& t = m.tape[m.cursor];
+            s.record_print(m, t, s.wall_start - (s.cut - t.ts_ms));
+            ++m.cursor;
+        }
+        if (m.cursor == m.tape.size()) {
+            m.cursor = m.tape.size() - 1;
+            s.advance(m);
+        }
+    }
+
+    s.listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (s.listen_fd < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    const int one = 1;
+    ::setsockopt(s.listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(s.config.port));
+    if (::inet_pton(AF_INET, s.config.host.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(s.listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(s.listen_fd, 128) != 0) {
+        if (error) *error = "listen on " + s.config.host + ":" + std::to_string(s.config.port) + ": " + std::strerror(errno);
+        ::close(s.listen_fd);
+        s.listen_fd = -1;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(s.listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    s.bound_port = ntohs(addr.sin_port);
+
+    s.started = true;
+    s.stopping = false;
+    s.acceptor = std::thread([&s] { s.accept_loop(); });
+    s.feeder = std::thread([&s] { s.feed_loop(); });
+    return true;
+}
+
+void MockUpbitServer::stop() {
+    Impl& s = *impl_;
+    if (!s.started) return;
+    s.stopping = true;
+    s.feed_cv.notify_all();
+    ::shutdown(s.listen_fd, SHUT_RDWR);
+    s.acceptor.join();
+    ::close(s.listen_fd);
+    s.listen_fd = -1;
+    s.feeder.join();
+
+    std::vector<Impl::Worker> workers;
+    {
+        std::lock_guard<std::mutex> lock(s.conns_mutex);
+        for (const auto& c : s.conns) ::shutdown(c->fd, SHUT_RDWR);
+        workers.swap(s.workers);
+    }
+    for (auto& w : workers) w.thread.join();
+    s.started = false;
+}
+
+int MockUpbitServer::port() const {
+    return impl_->bound_port;
+}
+
+std::string MockUpbitServer::rest_url() const {
+    return "http://" + impl_->config.host + ":" + std::to_string(impl_->bound_port);
+}
+
+std::string MockUpbitServer::ws_url() const {
+    return "ws://" + impl_->config.host + ":" + std::to_string(impl_->bound_port) + "/websocket/v1";
+}
+
+MockExchangeStats MockUpbitServer::stats() const {
+    const Impl& s = *impl_;
+    MockExchangeStats out;
+    out.requests = s.requests;
+    out.rate_limited = s.rate_limited;
+    out.orders = s.orders_placed;
+    out.cancels = s.cancels;
+    out.fills = s.filled;
+    out.ws_sessions = s.ws_sessions;
+    out.frames_sent = s.frames_sent;
+    out.bytes_sent = s.bytes_sent;
+    return out;
+}
@@ -0,0 +1,146 @@
+// Serves a local mock of Upbit's REST and WebSocket APIs until interrupted.
+// Point the engine and UI at it with UPBIT_REST_URL / UPBIT_WS_URL.
+//
+//   mock_upbit [--port N] [--latency-us N] [--jitter-us N] [--speed X]
+//              [--reject P] [--market-rps N] [--candles-rps N] [--order-rps N]
+//              [--default-rps N] [--history-ms N] [--seed S]
+//              [--archive DIR [--from-ms T] [--to-ms T]] [--synthetic DAYS] [MARKET...]
+//
+// Without an archive every market replays a synthetic tape. --speed 0
+// streams as fast as clients read; a rps of 0 turns that group's limit off.
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "backtest.hpp"
+#include "mock_exchange.hpp"
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void on_signal(int) {
+    g_stop = true;
+}
+
+struct Options {
+    MockExchangeConfig config;
+    std::string archive_dir;
+    long long from_ms{0};
+    long long to_ms{0};
+    int synthetic_days{0};
+    std::vector<std::string> markets;
+};
+
+bool parse(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto value = [&]() -> const char* {
+            ++i;
+            return next;
+        };
+        if (arg[0] == '-' && arg[1] == '-' && !next) {
+            std::cerr << "mock_upbit: " << arg << " needs a value\n";
+            return false;
+        } else if (std::strcmp(arg, "--port") == 0) {
+            opt.config.port = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--latency-us") == 0) {
+            opt.config.latency_us = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--jitter-us") == 0) {
+            opt.config.jitter_us = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--speed") == 0) {
+            opt.config.feed_speed = std::strtod(value(), nullptr);
+        } else if (std::strcmp(arg, "--reject") == 0) {
+            opt.config.reject_ratio = std::strtod(value(), nullptr);
+        } else if (std::strcmp(arg, "--market-rps") == 0) {
+            opt.config.market_per_sec = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--candles-rps") == 0) {
+            opt.config.candles_per_sec = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--order-rps") == 0) {
+            opt.config.order_per_sec = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--default-rps") == 0) {
+            opt.config.default_per_sec = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--history-ms") == 0) {
+            opt.config.history_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            opt.config.seed = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--archive") == 0) {
+            opt.archive_dir = value();
+        } else if (std::strcmp(arg, "--from-ms") == 0) {
+            opt.from_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--to-ms") == 0) {
+            opt.to_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--synthetic") == 0) {
+            opt.synthetic_days = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (arg[0] == '-') {
+            std::cerr << "mock_upbit: unknown option " << arg << '\n';
+            return false;
+        } else {
+            opt.markets.emplace_back(arg);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse(argc, argv, opt)) return 2;
+
+    MockUpbitServer server(opt.config);
+    if (!opt.archive_dir.empty()) {
+        // copied out of the archive: the server owns its tapes
+        MarketArchive archive(opt.archive_dir);
+        if (opt.markets.empty()) opt.markets = replay_markets(opt.archive_dir);
+        for (const auto& market : opt.markets) {
+            ReplayData data;
+            std::string error;
+            if (!open_replay(archive, market, opt.from_ms, opt.to_ms, data, &error)) {
+                std::cerr << "mock_upbit: " << error << '\n';
+                continue;
+            }
+            const TradeRecord* first = data.trades.data();
+            server.add_market(market, std::vector<TradeRecord>(first + data.begin, first + data.end));
+        }
+    } else {
+        for (size_t i = 0; i < opt.markets.size(); ++i) {
+            std::vector<TradeRecord> tape;
+            if (opt.synthetic_days > 0) {
+                tape = synthetic_tape(1'700'000'000'000LL, opt.synthetic_days, 10'000.0 * static_cast<double>(i + 1),
+                                      opt.config.seed + static_cast<unsigned>(i));
+            }
+            server.add_market(opt.markets[i], std::move(tape));
+        }
+    }
+
+    std::string error;
+    if (!server.start(&error)) {
+        std::cerr << "mock_upbit: " << error << '\n';
+        return 1;
+    }
+    std::printf("mock_upbit: REST %s  WS %s\n", server.rest_url().c_str(), server.ws_url().c_str());
+    std::printf("  export UPBIT_REST_URL=%s UPBIT_WS_URL=%s\n", server.rest_url().c_str(), server.ws_url().c_str());
+    std::fflush(stdout);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    while (!g_stop) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    server.stop();
+
+    const MockExchangeStats s = server.stats();
+    std::printf("mock_upbit: %llu requests (%llu rate-limited), %llu orders, %llu cancels, %llu fills, "
+                "%llu ws sessions, %llu frames / %llu bytes sent\n",
+                static_cast<unsigned long long>(s.requests), static_cast<unsigned long long>(s.rate_limited),
+                static_cast<unsigned long long>(s.orders), static_cast<unsigned long long>(s.cancels),
+                static_cast<unsigned long long>(s.fills), static_cast<unsigned long long>(s.ws_sessions),
+                static_cast<unsigned long long>(s.frames_sent), static_cast<unsigned long long>(s.bytes_sent));
+    return 0;
+}
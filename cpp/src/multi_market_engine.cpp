@@ -0,0 +1,213 @@
+#include "multi_market_engine.hpp"
+#include "latency_histogram.hpp"
+#include <algorithm>
+
+namespace {
+
+void append_codes(std::string& out, const std::vector<std::string>& codes) {
+    out += '[';
+    for (size_t i = 0; i < codes.size(); ++i) {
+        if (i > 0) out += ',';
+        out += '"';
+        out += codes[i];
+        out += '"';
+    }
+    out += ']';
+}
+
+} // namespace
+
+void MarketState::seed(CandleSpan candles) {
+    bars.seed(Timeframe::M5, candles);
+    signal.seed(candles_5m());
+    last_decision = candles_5m().empty() ? TradeDecision{} : signal.on_tick(candles_5m().back());
+}
+
+void MarketState::merge_candles(CandleSpan candles) {
+    if (candles.empty()) return;
+    bars.merge(Timeframe::M5, candles);
+    signal.seed(candles_5m());
+    last_decision = candles_5m().empty() ? TradeDecision{} : signal.on_tick(candles_5m().back());
+}
+
+void MarketState::on_trade(const TradeTick& trade) {
+    if (trade.price <= 0.0 || trade.ts_ms <= 0) return;
+    last_trade_ms = std::max(last_trade_ms, trade.ts_ms);
+    const unsigned closed = bars.on_trade(trade.ts_ms, trade.price, trade.volume);
+    const Candles5m& c5 = candles_5m();
+    if (closed & TimeframeBars::bit(Timeframe::M5)) signal.on_bar_close(c5[c5.size() - 2]);
+    last_decision = signal.on_tick(c5.back());
+}
+
+void MarketState::on_fill(bool is_buy, double price, double volume) {
+    if (volume <= 0.0) return;
+    if (is_buy) {
+        const double cost = position.avg_price * position.qty + price * volume;
+        position.qty += volume;
+        position.avg_price = position.qty > 0.0 ? cost / position.qty : 0.0;
+    } else if (volume >= position.qty - 1e-8) {
+        position = MarketPosition{};
+    } else {
+        position.qty -= volume;
+    }
+}
+
+MultiMarketEngine::MultiMarketEngine(std::vector<std::string> markets, int workers) : codes_(std::move(markets)) {
+    std::sort(codes_.begin(), codes_.end());
+    codes_.erase(std::unique(codes_.begin(), codes_.end()), codes_.end());
+
+    int n = workers > 0 ? workers : static_cast<int>(std::thread::hardware_concurrency());
+    n = std::max(1, std::min(n, static_cast<int>(codes_.size())));
+    for (int i = 0; i < n; ++i) shards_.push_back(std::make_unique<Shard>());
+
+    states_.reserve(codes_.size());
+    routes_.reserve(codes_.size());
+    for (size_t i = 0; i < codes_.size(); ++i) {
+        auto state = std::make_unique<MarketState>();
+        state->code = codes_[i];
+        Shard* shard = shards_[i % shards_.size()].get();
+        shard->markets.push_back(state.get());
+        routes_.push_back(Route{state->code, state.get(), shard});
+        states_.push_back(std::move(state));
+    }
+
+    for (auto& shard : shards_) {
+        Shard* s = shard.get();
+        s->worker = std::thread([this, s]() { run(*s); });
+    }
+}
+
+MultiMarketEngine::~MultiMarketEngine() {
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stop = true;
+        }
+        shard->cv.notify_one();
+    }
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+}
+
+std::string MultiMarketEngine::subscription_message(std::string_view ticket, WsFormat format,
+                                                   const std::vector<std::string>& trade_only) const {
+    std::vector<std::string> trade_codes = codes_;
+    for (const std::string& code : trade_only) {
+        if (!route(code)) trade_codes.push_back(code);
+    }
+    std::string out;
+    out.reserve(128 + (codes_.size() + trade_codes.size()) * 24);
+    out += R"([{"ticket":")";
+    out += ticket;
+    out += R"("},{"type":"trade","codes":)";
+    append_codes(out, trade_codes);
+    out += R"(},{"type":"orderbook","codes":)";
+    append_codes(out, codes_);
+    out += R"(,"isOnlyRealtime":true})";
+    if (format == WsFormat::Simple) out += R"(,{"format":"SIMPLE"})";
+    out += ']';
+    return out;
+}
+
+const MultiMarketEngine::Route* MultiMarketEngine::route(std::string_view code) const {
+    auto it = std::lower_bound(routes_.begin(), routes_.end(), code,
+                               [](const Route& r, std::string_view c) { return r.code < c; });
+    if (it == routes_.end() || it->code != code) return nullptr;
+    return &*it;
+}
+
+void MultiMarketEngine::enqueue(Shard& shard, Event ev) {
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.events.push_back(std::move(ev));
+    }
+    shard.cv.notify_one();
+}
+
+bool MultiMarketEngine::dispatch(std::string_view frame, WsFormat format) {
+    switch (WsFrameDecoder::decode(frame, trade_scratch_, book_scratch_, format)) {
+    case WsMessageType::Trade: return dispatch(trade_scratch_);
+    case WsMessageType::Orderbook: return dispatch(book_scratch_);
+    default: return false;
+    }
+}
+
+bool MultiMarketEngine::dispatch(const TradeTick& trade) {
+    const Route* r = route(trade.code);
+    if (!r) return false;
+    enqueue(*r->shard, trade);
+    return true;
+}
+
+bool MultiMarketEngine::dispatch(const OrderbookSnapshot& book) {
+    const Route* r = route(book.code);
+    if (!r) return false;
+    enqueue(*r->shard, book);
+    return true;
+}
+
+bool MultiMarketEngine::post(std::string_view code, StateFn fn) {
+    const Route* r = route(code);
+    if (!r) return false;
+    MarketState* state = r->state;
+    enqueue(*r->shard, std::function<void()>([state, fn = std::move(fn)]() { fn(*state); }));
+    return true;
+}
+
+void MultiMarketEngine::seed_candles(std::string_view code, std::vector<Candle> candles) {
+    post(code, [candles = std::move(candles)](MarketState& s) mutable { s.seed(std::move(candles)); });
+}
+
+void MultiMarketEngine::merge_candles(std::string_view code, std::vector<Candle> candles) {
+    post(code, [candles = std::move(candles)](MarketState& s) { s.merge_candles(candles); });
+}
+
+void MultiMarketEngine::evaluate_all(double order_krw, const DecisionFn& on_decision) {
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t remaining = shards_.size();
+
+    for (auto& shard : shards_) {
+        Shard* s = shard.get();
+        enqueue(*s, std::function<void()>([&, s]() {
+            for (MarketState* m : s->markets) {
+                const double ref = m->book.best_ask() > 0.0 ? m->book.best_ask()
+                                 : (m->candles_5m().empty() ? 0.0 : m->candles_5m().back().close);
+                const double size = ref > 0.0 ? order_krw / ref : 0.0;
+                {
+                    LatencySpan span(LatencyStage::Decision);
+                    m->last_decision = s->strategy.evaluate(m->candles_5m(), m->book, size);
+                }
+                if (on_decision) on_decision(*m, m->last_decision);
+            }
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0) done_cv.notify_one();
+        }));
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&]() { return remaining == 0; });
+}
+
+void MultiMarketEngine::run(Shard& shard) {
+    std::deque<Event> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.cv.wait(lock, [&]() { return shard.stop || !shard.events.empty(); });
+            if (shard.stop && shard.events.empty()) return;
+            batch.swap(shard.events);
+        }
+        for (Event& ev : batch) {
+            if (auto* trade = std::get_if<TradeTick>(&ev)) {
+                if (const Route* r = route(trade->code)) r->state->on_trade(*trade);
+            } else if (auto* book = std::get_if<OrderbookSnapshot>(&ev)) {
+                if (const Route* r = route(book->code)) r->state->book.apply(*book);
+            } else if (auto* task = std::get_if<std::function<void()>>(&ev)) {
+                (*task)();
+            }
+        }
+        batch.clear();
+    }
+}
@@ -0,0 +1,109 @@
+#include "order_book.hpp"
+#include <algorithm>
+
+namespace {
+
+// true if a ranks ahead of b on the given side
+bool better(BookSide side, double a, double b) {
+    return side == BookSide::Bid ? a > b : a < b;
+}
+
+} // namespace
+
+void OrderBook::apply(const OrderbookSnapshot& snap) {
+    bid_depth_ = 0;
+    ask_depth_ = 0;
+    const int n = std::min(snap.depth, kMaxLevels);
+    for (int i = 0; i < n; ++i) {
+        const BookLevel& row = snap.levels[i];
+        if (row.bid_price > 0.0 && row.bid_size > 0.0) bids_[bid_depth_++] = {row.bid_price, row.bid_size};
+        if (row.ask_price > 0.0 && row.ask_size > 0.0) asks_[ask_depth_++] = {row.ask_price, row.ask_size};
+    }
+    ts_ms_ = snap.ts_ms;
+}
+
+bool OrderBook::update_level(BookSide side, double price, double size) {
+    if (price <= 0.0) return false;
+    auto& levels = side == BookSide::Bid ? bids_ : asks_;
+    int& depth = side == BookSide::Bid ? bid_depth_ : ask_depth_;
+
+    int i = 0;
+    while (i < depth && better(side, levels[i].price, price)) ++i;
+    const bool exists = i < depth && levels[i].price == price;
+
+    if (size <= 0.0) {
+        if (!exists) return true;
+        std::copy(levels.begin() + i + 1, levels.begin() + depth, levels.begin() + i);
+        --depth;
+        return true;
+    }
+    if (exists) {
+        levels[i].size = size;
+        return true;
+    }
+    if (i >= kMaxLevels) return false;
+    // the worst level falls off when the side is full
+    const int last = std::min(depth, kMaxLevels - 1);
+    std::copy_backward(levels.begin() + i, levels.begin() + last, levels.begin() + last + 1);
+    levels[i] = {price, size};
+    depth = last + 1;
+    return true;
+}
+
+void OrderBook::clear() {
+    bid_depth_ = 0;
+    ask_depth_ = 0;
+    ts_ms_ = 0;
+}
+
+double OrderBook::mid() const {
+    if (empty()) return 0.0;
+    return 0.5 * (bids_[0].price + asks_[0].price);
+}
+
+double OrderBook::spread() const {
+    if (empty()) return 0.0;
+    return asks_[0].price - bids_[0].price;
+}
+
+double OrderBook::depth_at_price(BookSide side, double price) const {
+    const auto& levels = side == BookSide::Bid ? bids_ : asks_;
+    const int depth = this->depth(side);
+    double total = 0.0;
+    for (int i = 0; i < depth && !better(side, price, levels[i].price); ++i) total += levels[i].size;
+    return total;
+}
+
+double OrderBook::vwap_to_size(BookSide side, double size, double* filled) const {
+    const auto& levels = side == BookSide::Bid ? bids_ : asks_;
+    const int depth = this->depth(side);
+    double remaining = size;
+    double notional = 0.0;
+    for (int i = 0; i < depth && remaining > 0.0; ++i) {
+        const double take = std::min(remaining, levels[i].size);
+        notional += take * levels[i].price;
+        remaining -= take;
+    }
+    const double got = size - std::max(0.0, remaining);
+    if (filled) *filled = got;
+    return got > 0.0 ? notional / got : 0.0;
+}
+
+double OrderBook::imbalance(int levels) const {
+    double bid = 0.0;
+    double ask = 0.0;
+    for (int i = 0; i < std::min(levels, bid_depth_); ++i) bid += bids_[i].size;
+    for (int i = 0; i < std::min(levels, ask_depth_); ++i) ask += asks_[i].size;
+    const double total = bid + ask;
+    return total > 0.0 ? (bid - ask) / total : 0.0;
+}
+
+double OrderBook::microprice() const {
+    if (empty()) return 0.0;
+    const PriceLevel& b = bids_[0];
+    const PriceLevel& a = asks_[0];
+    const double total = b.size + a.size;
+    if (total <= 0.0) return mid();
+    // heavy bid queue -> next trade more likely at the ask, so lean toward it
+    return (a.price * b.size + b.price * a.size) / total;
+}
@@ -0,0 +1,253 @@
+#include "order_gateway.hpp"
+#include <utility>
+#include <vector>
+#include "order_tracker.hpp"
+
+const char* gateway_op_name(GatewayOp op) {
+    switch (op) {
+    case GatewayOp::Post: return "post";
+    case GatewayOp::Cancel: return "cancel";
+    case GatewayOp::Replace: return "replace";
+    case GatewayOp::Query: return "query";
+    }
+    return "unknown";
+}
+
+OrderGateway::OrderGateway(UpbitRestClient& rest, OrderGatewayConfig config)
+    : rest_(rest), config_(config) {
+    worker_ = std::thread([this]() { run(); });
+}
+
+OrderGateway::~OrderGateway() {
+    stop();
+}
+
+void OrderGateway::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) worker_.join();
+}
+
+bool OrderGateway::post(OrderRequest req, Callback cb) {
+    Command cmd;
+    cmd.op = GatewayOp::Post;
+    cmd.report.identifier = req.identifier;
+    cmd.req = std::move(req);
+    cmd.cb = std::move(cb);
+    return enqueue(std::move(cmd));
+}
+
+bool OrderGateway::cancel(std::string uuid, Callback cb) {
+    Command cmd;
+    cmd.op = GatewayOp::Cancel;
+    cmd.report.uuid = uuid;
+    cmd.uuid = std::move(uuid);
+    cmd.cb = std::move(cb);
+    return enqueue(std::move(cmd));
+}
+
+bool OrderGateway::cancel_replace(std::string uuid, OrderRequest replacement, Callback cb) {
+    Command cmd;
+    cmd.op = GatewayOp::Replace;
+    cmd.report.uuid = uuid;
+    cmd.report.identifier = replacement.identifier;
+    cmd.uuid = std::move(uuid);
+    cmd.req = std::move(replacement);
+    cmd.cb = std::move(cb);
+    return enqueue(std::move(cmd));
+}
+
+bool OrderGateway::query(std::string uuid, std::string identifier, Callback cb) {
+    Command cmd;
+    cmd.op = GatewayOp::Query;
+    cmd.report.uuid = uuid;
+    cmd.report.identifier = identifier;
+    cmd.uuid = std::move(uuid);
+    cmd.req.identifier = std::move(identifier);
+    cmd.cb = std::move(cb);
+    return enqueue(std::move(cmd));
+}
+
+GatewayStats OrderGateway::stats() const {
+    GatewayStats s;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        s.queued = queue_.size();
+        s.in_flight = in_flight_;
+    }
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.rejected_full = rejected_full_.load(std::memory_order_relaxed);
+    s.completed = completed_.load(std::memory_order_relaxed);
+    s.replaced = replaced_.load(std::memory_order_relaxed);
+    s.replace_aborted = replace_aborted_.load(std::memory_order_relaxed);
+    s.queue_wait = queue_wait_.summary();
+    s.ack = ack_.summary();
+    return s;
+}
+
+size_t OrderGateway::group_of(GatewayOp op) {
+    return static_cast<size_t>(op == GatewayOp::Query ? RateGroup::Default : RateGroup::Order);
+}
+
+bool OrderGateway::enqueue(Command cmd) {
+    cmd.report.op = cmd.op;
+    cmd.queued_at = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return false;
+        if (queue_.size() >= config_.queue_capacity) {
+            rejected_full_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(std::move(cmd));
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    cv_.notify_one();
+    return true;
+}
+
+bool OrderGateway::sendable() const {
+    for (const Command& cmd : queue_) {
+        const size_t g = group_of(cmd.op);
+        if (in_flight_[g] < config_.max_in_flight[g]) return true;
+    }
+    return false;
+}
+
+bool OrderGateway::idle() const {
+    for (int n : in_flight_) {
+        if (n > 0) return false;
+    }
+    return true;
+}
+
+void OrderGateway::run() {
+    std::vector<std::shared_ptr<Command>> ready;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this]() {
+            return !done_.empty() || (stop_ ? !queue_.empty() || idle() : sendable());
+        });
+
+        // answers first: they free the slots the queue is waiting on
+        if (!done_.empty()) {
+            Completion done = std::move(done_.front());
+            done_.pop_front();
+            lock.unlock();
+            complete(std::move(done));
+            lock.lock();
+            continue;
+        }
+
+        if (stop_) {
+            if (queue_.empty()) break; // and nothing in flight
+            Command cmd = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            (cmd.op == GatewayOp::Cancel ? cmd.report.cancel : cmd.report.result).error_message = "gateway stopped";
+            finish(cmd);
+            lock.lock();
+            continue;
+        }
+
+        // first come first served within a group; a full group does not hold up the others
+        std::array<bool, 4> full{};
+        for (auto it = queue_.begin(); it != queue_.end();) {
+            const size_t g = group_of(it->op);
+            if (full[g] || in_flight_[g] >= config_.max_in_flight[g]) {
+                full[g] = true;
+                ++it;
+                continue;
+            }
+            ++in_flight_[g];
+            ready.push_back(std::make_shared<Command>(std::move(*it)));
+            it = queue_.erase(it);
+        }
+        lock.unlock();
+        for (const auto& cmd : ready) send(cmd);
+        ready.clear();
+        lock.lock();
+    }
+}
+
+UpbitRestClient::OrderCallback OrderGateway::on_result(const std::shared_ptr<Command>& cmd) {
+    return [this, cmd](OrderResult result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.push_back(Completion{cmd, std::move(result)});
+        }
+        cv_.notify_one();
+    };
+}
+
+void OrderGateway::send(const std::shared_ptr<Command>& cmd) {
+    cmd->sent_at = Clock::now();
+    const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(cmd->sent_at - cmd->queued_at).count();
+    queue_wait_.record(waited);
+    cmd->report.queue_us = waited / 1000;
+    switch (cmd->op) {
+    case GatewayOp::Post: rest_.post_order_async(cmd->req, on_result(cmd)); break;
+    case GatewayOp::Cancel:
+    case GatewayOp::Replace: rest_.cancel_order_async(CancelRequest{cmd->uuid}, on_result(cmd)); break;
+    case GatewayOp::Query: rest_.get_order_async(cmd->uuid, cmd->req.identifier, on_result(cmd)); break;
+    }
+}
+
+void OrderGateway::complete(Completion done) {
+    Command& cmd = *done.cmd;
+    const auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - cmd.sent_at).count();
+    ack_.record(took);
+    cmd.report.ack_us += took / 1000;
+
+    switch (cmd.op) {
+    case GatewayOp::Post:
+    case GatewayOp::Query: cmd.report.result = std::move(done.result); break;
+    case GatewayOp::Cancel: cmd.report.cancel = std::move(done.result); break;
+    case GatewayOp::Replace:
+        if (cmd.report.replacement_sent) {
+            cmd.report.result = std::move(done.result);
+            if (cmd.report.result.accepted) replaced_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        cmd.report.cancel = std::move(done.result);
+        if (cmd.report.cancel.accepted) {
+            // the reply is the order as cancelled: what it still had open is what we may re-post
+            double volume = cmd.req.volume;
+            if (volume <= 0.0) {
+                OrderEvent cancelled;
+                if (parse_order_event(cmd.report.cancel.raw_response, cancelled)) volume = cancelled.remaining_volume;
+            }
+            bool stopping;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping = stop_;
+            }
+            if (volume > 0.0 && !stopping) {
+                // the replacement keeps the cancel's slot
+                cmd.req.volume = volume;
+                cmd.report.replacement_volume = volume;
+                cmd.report.replacement_sent = true;
+                cmd.sent_at = Clock::now();
+                rest_.post_order_async(cmd.req, on_result(done.cmd));
+                return;
+            }
+            cmd.report.result.error_message = stopping ? "gateway stopped" : "nothing left to replace";
+        }
+        replace_aborted_.fetch_add(1, std::memory_order_relaxed);
+        break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_[group_of(cmd.op)];
+    }
+    finish(cmd);
+}
+
+void OrderGateway::finish(Command& cmd) {
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    if (cmd.cb) cmd.cb(cmd.report);
+}
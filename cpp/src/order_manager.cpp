@@ -1,13 +1,25 @@
 #include "order_manager.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <cctype>
+#include "latency_histogram.hpp"
 
-OrderManager::OrderManager(UpbitRestClient& rest, double fee_rate, double min_notional)
-    : rest_(rest), fee_rate_(fee_rate), min_notional_(min_notional) {}
+namespace {
+
+long long now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+OrderManager::OrderManager(OrderVenue& venue, double fee_rate, double min_notional)
+    : venue_(venue), fee_rate_(fee_rate), min_notional_(min_notional) {}
 
 OrderResult OrderManager::place_order(const OrderRequest& req) {
+    const long long start = LatencyRecorder::now_ns();
     OrderRequest normalized = req;
     const bool is_buy = req.side == "buy" || req.side == "bid";
     if (normalized.ord_type.empty()) normalized.ord_type = "limit";
@@ -29,7 +41,14 @@ OrderResult OrderManager::place_order(const OrderRequest& req) {
         normalized.volume = UpbitRestClient::normalize_volume(ref_price, req.volume, is_buy, min_notional_);
     }
 
-    auto res = rest_.post_order(normalized);
+    if (tracker_) tracker_->submit(normalized, now_ms());
+    LatencyRecorder::record(LatencyStage::OrderPrepare, LatencyRecorder::now_ns() - start);
+    auto res = venue_.post_order(normalized);
+    if (tracker_) {
+        updates_.clear();
+        tracker_->on_post_result(normalized.identifier, res, now_ms(), updates_);
+    }
+    if (!logging_) return res;
     if (res.accepted && normalized.ord_type == "limit") {
         const double gross = normalized.price * normalized.volume;
         const double fee_est = gross * fee_rate_;
@@ -40,6 +59,7 @@ OrderResult OrderManager::place_order(const OrderRequest& req) {
                   << " gross=" << gross
                   << " fee_est=" << fee_est
                   << " uuid=" << res.uuid
+                  << " id=" << normalized.identifier
                   << " status=" << res.http_status << '\n';
     } else if (!res.accepted) {
         std::clog << "[order_manager] order failed status=" << res.http_status
@@ -49,5 +69,10 @@ OrderResult OrderManager::place_order(const OrderRequest& req) {
 }
 
 OrderResult OrderManager::cancel_order(const CancelRequest& req) {
-    return rest_.cancel_order(req);
+    auto res = venue_.cancel_order(req);
+    if (tracker_) {
+        updates_.clear();
+        tracker_->on_cancel_result(req.uuid, res, now_ms(), updates_);
+    }
+    return res;
 }
@@ -0,0 +1,266 @@
+#include "order_tracker.hpp"
+#include <chrono>
+#include <cmath>
+#include "json_scan.hpp"
+
+namespace {
+
+constexpr double kVolumeEps = 1e-12;
+
+} // namespace
+
+const char* order_state_name(OrderState s) {
+    switch (s) {
+    case OrderState::PendingNew: return "pending-new";
+    case OrderState::Open: return "open";
+    case OrderState::PartiallyFilled: return "partially-filled";
+    case OrderState::Done: return "done";
+    case OrderState::Cancelled: return "cancelled";
+    case OrderState::Rejected: return "rejected";
+    }
+    return "unknown";
+}
+
+bool parse_order_event(std::string_view json, OrderEvent& out) {
+    out = OrderEvent{};
+    const bool ok = json_for_each_member(json, [&](std::string_view key, std::string_view value) {
+        if (key == "uuid") {
+            out.uuid = std::string(json_unquote(value));
+        } else if (key == "identifier") {
+            if (value != "null") out.identifier = std::string(json_unquote(value));
+        } else if (key == "state") {
+            out.state = std::string(json_unquote(value));
+        } else if (key == "market" || key == "code") {
+            out.market = std::string(json_unquote(value));
+        } else if (key == "side") {
+            out.is_buy = json_unquote(value) == "bid";
+        } else if (key == "ask_bid") {
+            out.is_buy = json_unquote(value) == "BID";
+        } else if (key == "executed_volume") {
+            json_to_double(value, out.executed_volume);
+        } else if (key == "remaining_volume") {
+            json_to_double(value, out.remaining_volume);
+        } else if (key == "avg_price") {
+            json_to_double(value, out.avg_price);
+        } else if (key == "trade_price") {
+            json_to_double(value, out.trade_price);
+        } else if (key == "trade_volume") {
+            json_to_double(value, out.trade_volume);
+        } else if (key == "trade_timestamp") {
+            json_to_int64(value, out.trade_ts);
+        }
+        return true;
+    });
+    return ok && (!out.uuid.empty() || !out.identifier.empty());
+}
+
+OrderTracker::OrderTracker(std::string prefix) {
+    const long long session = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    prefix_ = std::move(prefix) + '-' + std::to_string(session) + '-';
+}
+
+const TrackedOrder& OrderTracker::submit(OrderRequest& req, long long now_ms) {
+    if (req.identifier.empty()) req.identifier = prefix_ + std::to_string(next_++);
+    auto [it, inserted] = orders_.try_emplace(req.identifier);
+    TrackedOrder& o = it->second;
+    if (!inserted) {
+        // a retry under the same identifier (the exchange refuses a second
+        // order with it), typically after a post got no response
+        if (o.state == OrderState::PendingNew && o.acked_ms != 0) {
+            o.acked_ms = 0;
+            ++pending_acks_;
+        }
+        return o;
+    }
+    o.identifier = req.identifier;
+    o.market = req.market;
+    o.is_buy = req.side == "buy" || req.side == "bid";
+    o.ord_type = req.ord_type.empty() ? "limit" : req.ord_type;
+    o.price = req.price;
+    o.volume = req.volume;
+    o.submitted_ms = now_ms;
+    o.updated_ms = now_ms;
+    ++pending_acks_;
+    return o;
+}
+
+void OrderTracker::on_post_result(const std::string& identifier, const OrderResult& res, long long now_ms,
+                                  std::vector<OrderUpdate>& updates) {
+    const auto it = orders_.find(identifier);
+    if (it == orders_.end()) return;
+    TrackedOrder& o = it->second;
+    const bool first = o.acked_ms == 0;
+    if (first) {
+        o.acked_ms = now_ms;
+        --pending_acks_;
+    }
+
+    if (res.accepted) {
+        if (o.uuid.empty()) link(o, res.uuid);
+        OrderEvent body;
+        if (!parse_order_event(res.raw_response, body)) body.uuid = res.uuid;
+        if (o.state == OrderState::PendingNew && body.state.empty()) body.state = "wait";
+        release_orphans(o.uuid, now_ms, updates);
+        apply(o, body, now_ms, updates);
+    } else if (res.http_status != 0 && o.state == OrderState::PendingNew) {
+        const OrderUpdate u{&o, o.uuid, o.is_buy, o.state, true};
+        o.reject_reason = res.error_message;
+        set_state(o, OrderState::Rejected);
+        o.updated_ms = now_ms;
+        updates.push_back(u);
+    } else if (res.http_status == 0) {
+        o.reject_reason = "no response: " + res.error_message;
+    }
+
+    // with every ack in, whatever is still unclaimed was placed elsewhere
+    if (first && pending_acks_ == 0 && !orphans_.empty()) {
+        for (auto& [uuid, events] : orphans_) {
+            for (const OrderEvent& e : events) {
+                updates.push_back(OrderUpdate{nullptr, e.uuid, e.is_buy, OrderState::PendingNew, false, e.trade_price,
+                                              e.trade_volume, e.trade_ts > 0 ? e.trade_ts : now_ms});
+            }
+        }
+        orphans_.clear();
+    }
+}
+
+void OrderTracker::on_not_sent(const std::string& identifier, const std::string& reason, long long now_ms,
+                               std::vector<OrderUpdate>& updates) {
+    OrderResult res;
+    res.http_status = -1; // a definite answer, unlike a transport failure
+    res.error_message = reason;
+    on_post_result(identifier, res, now_ms, updates);
+}
+
+void OrderTracker::on_cancel_result(const std::string& uuid, const OrderResult& res, long long now_ms,
+                                    std::vector<OrderUpdate>& updates) {
+    const auto id = by_uuid_.find(uuid);
+    if (id == by_uuid_.end() || !res.accepted) return;
+    TrackedOrder& o = orders_.at(id->second);
+    // the reply shows the order as it was; only its fills count
+    OrderEvent body;
+    parse_order_event(res.raw_response, body);
+    body.state = "cancel";
+    apply(o, body, now_ms, updates);
+}
+
+void OrderTracker::on_event(const OrderEvent& e, long long now_ms, std::vector<OrderUpdate>& updates) {
+    TrackedOrder* o = nullptr;
+    if (!e.uuid.empty()) {
+        const auto id = by_uuid_.find(e.uuid);
+        if (id != by_uuid_.end()) o = &orders_.at(id->second);
+    }
+    if (!o && !e.identifier.empty()) {
+        const auto it = orders_.find(e.identifier);
+        if (it != orders_.end()) {
+            o = &it->second;
+            if (o->uuid.empty() && !e.uuid.empty()) {
+                link(*o, e.uuid);
+                release_orphans(e.uuid, now_ms, updates);
+            }
+        }
+    }
+    if (o) {
+        apply(*o, e, now_ms, updates);
+        return;
+    }
+    // an unknown uuid without an identifier may be the answer to a post still in flight
+    if (pending_acks_ > 0 && !e.uuid.empty() && e.identifier.empty()) {
+        orphans_[e.uuid].push_back(e);
+        return;
+    }
+    updates.push_back(OrderUpdate{nullptr, e.uuid, e.is_buy, OrderState::PendingNew, false, e.trade_price, e.trade_volume,
+                                  e.trade_ts > 0 ? e.trade_ts : now_ms});
+}
+
+const TrackedOrder* OrderTracker::find_by_identifier(const std::string& identifier) const {
+    const auto it = orders_.find(identifier);
+    return it == orders_.end() ? nullptr : &it->second;
+}
+
+const TrackedOrder* OrderTracker::find_by_uuid(const std::string& uuid) const {
+    const auto id = by_uuid_.find(uuid);
+    return id == by_uuid_.end() ? nullptr : find_by_identifier(id->second);
+}
+
+std::vector<const TrackedOrder*> OrderTracker::live_orders() const {
+    std::vector<const TrackedOrder*> out;
+    for (const auto& [id, o] : orders_) {
+        if (o.state == OrderState::Open || o.state == OrderState::PartiallyFilled) out.push_back(&o);
+    }
+    return out;
+}
+
+size_t OrderTracker::forget_closed(long long before_ms) {
+    size_t dropped = 0;
+    for (auto it = orders_.begin(); it != orders_.end();) {
+        const TrackedOrder& o = it->second;
+        if (is_terminal(o.state) && o.updated_ms < before_ms && o.acked_ms != 0) {
+            if (!o.uuid.empty()) by_uuid_.erase(o.uuid);
+            it = orders_.erase(it);
+            ++dropped;
+        } else {
+            ++it;
+        }
+    }
+    return dropped;
+}
+
+void OrderTracker::apply(TrackedOrder& o, const OrderEvent& e, long long now_ms, std::vector<OrderUpdate>& updates) {
+    OrderUpdate u{&o, o.uuid, o.is_buy, o.state};
+
+    // cumulative volume when the report has it, so a replayed report adds nothing
+    const double delta = e.executed_volume >= 0.0 ? e.executed_volume - o.filled_volume : e.trade_volume;
+    if (delta > kVolumeEps) {
+        double price = 0.0;
+        if (e.trade_price > 0.0 && std::fabs(e.trade_volume - delta) <= kVolumeEps + 1e-9 * delta) {
+            price = e.trade_price;
+        } else if (e.avg_price > 0.0 && e.executed_volume > 0.0) {
+            price = (e.avg_price * e.executed_volume - o.filled_notional) / delta;
+        }
+        if (price <= 0.0) price = e.trade_price > 0.0 ? e.trade_price : o.price;
+        o.filled_volume += delta;
+        o.filled_notional += price * delta;
+        ++o.fills;
+        u.fill_price = price;
+        u.fill_volume = delta;
+        u.fill_ts = e.trade_ts > 0 ? e.trade_ts : now_ms;
+    }
+
+    OrderState next = o.state;
+    if (e.state == "done" || (e.remaining_volume == 0.0 && o.filled_volume > 0.0)) {
+        next = OrderState::Done;
+    } else if (e.state == "cancel") {
+        next = OrderState::Cancelled;
+    } else if (o.filled_volume > 0.0) {
+        next = OrderState::PartiallyFilled;
+    } else if (!e.state.empty()) {
+        next = OrderState::Open;
+    }
+    set_state(o, next);
+    u.state_changed = o.state != u.previous;
+    o.updated_ms = now_ms;
+    if (u.state_changed || u.fill_volume > 0.0) updates.push_back(u);
+}
+
+void OrderTracker::set_state(TrackedOrder& o, OrderState s) {
+    // closed stays closed, except that any report proves a "rejected" order exists
+    if (is_terminal(o.state) && o.state != OrderState::Rejected) return;
+    o.state = s;
+}
+
+void OrderTracker::link(TrackedOrder& o, const std::string& uuid) {
+    if (uuid.empty()) return;
+    o.uuid = uuid;
+    by_uuid_[uuid] = o.identifier;
+}
+
+void OrderTracker::release_orphans(const std::string& uuid, long long now_ms, std::vector<OrderUpdate>& updates) {
+    const auto it = orphans_.find(uuid);
+    if (it == orphans_.end()) return;
+    const std::vector<OrderEvent> events = std::move(it->second);
+    orphans_.erase(it);
+    TrackedOrder& o = orders_.at(by_uuid_.at(uuid));
+    for (const OrderEvent& e : events) apply(o, e, now_ms, updates);
+}
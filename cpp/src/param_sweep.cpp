@@ -0,0 +1,294 @@
+#include "param_sweep.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+// Per-worker run queues. The owner takes from the front of its own block,
+// thieves from the back of someone else's, so the two rarely meet. A run is
+// a whole tape replay, so a mutex per queue is noise.
+class StealingQueues {
+public:
+    StealingQueues(size_t workers, size_t runs) {
+        for (size_t w = 0; w < workers; ++w) {
+            auto q = std::make_unique<Queue>();
+            for (size_t i = runs * w / workers; i < runs * (w + 1) / workers; ++i) q->runs.push_back(i);
+            queues_.push_back(std::move(q));
+        }
+    }
+
+    bool next(size_t self, size_t& run) {
+        {
+            Queue& own = *queues_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.runs.empty()) {
+                run = own.runs.front();
+                own.runs.pop_front();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); ++k) {
+            Queue& victim = *queues_[(self + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.runs.empty()) {
+                run = victim.runs.back();
+                victim.runs.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> runs;
+    };
+    std::vector<std::unique_ptr<Queue>> queues_;
+};
+
+BacktestConfig with_point(BacktestConfig c, size_t breakout, size_t atr, double risk, double tp, double sl) {
+    c.scalper.breakout_bars = breakout;
+    c.scalper.atr_period = atr;
+    c.risk_per_trade = risk;
+    c.take_profit_atr = tp;
+    c.stop_loss_atr = sl;
+    return c;
+}
+
+template <typename T>
+std::pair<T, T> bounds(const std::vector<T>& v, T fallback) {
+    if (v.empty()) return {fallback, fallback};
+    const auto mm = std::minmax_element(v.begin(), v.end());
+    return {*mm.first, *mm.second};
+}
+
+// Output columns shared by the CSV and columnar writers.
+struct Row {
+    size_t config_index;
+    const BacktestConfig& config;
+    const BacktestReport& report;
+};
+
+struct Column {
+    const char* name;
+    bool integer;
+    double (*get)(const Row&);
+};
+
+double as_double(size_t v) { return static_cast<double>(v); }
+
+const Column kColumns[] = {
+    {"config", true, [](const Row& r) { return as_double(r.config_index); }},
+    {"breakout_bars", true, [](const Row& r) { return as_double(r.config.scalper.breakout_bars); }},
+    {"atr_period", true, [](const Row& r) { return as_double(r.config.scalper.atr_period); }},
+    {"risk_per_trade", false, [](const Row& r) { return r.config.risk_per_trade; }},
+    {"take_profit_atr", false, [](const Row& r) { return r.config.take_profit_atr; }},
+    {"stop_loss_atr", false, [](const Row& r) { return r.config.stop_loss_atr; }},
+    {"prints", true, [](const Row& r) { return as_double(r.report.prints); }},
+    {"orders", true, [](const Row& r) { return as_double(r.report.orders); }},
+    {"orders_filled", true, [](const Row& r) { return as_double(r.report.orders_filled); }},
+    {"orders_cancelled", true, [](const Row& r) { return as_double(r.report.orders_cancelled); }},
+    {"fill_rate", false, [](const Row& r) { return r.report.fill_rate(); }},
+    {"volume_fill_rate", false, [](const Row& r) { return r.report.volume_fill_rate(); }},
+    {"round_trips", true, [](const Row& r) { return as_double(r.report.round_trips); }},
+    {"wins", true, [](const Row& r) { return as_double(r.report.wins); }},
+    {"gross_pnl", false, [](const Row& r) { return r.report.gross_pnl; }},
+    {"fees", false, [](const Row& r) { return r.report.fees; }},
+    {"net_pnl", false, [](const Row& r) { return r.report.net_pnl; }},
+    {"final_equity", false, [](const Row& r) { return r.report.final_equity; }},
+    {"max_drawdown", false, [](const Row& r) { return r.report.max_drawdown; }},
+    {"slippage_mean_bps", false, [](const Row& r) { return r.report.slippage_mean_bps; }},
+    {"slippage_p50_bps", false, [](const Row& r) { return r.report.slippage_p50_bps; }},
+    {"slippage_p95_bps", false, [](const Row& r) { return r.report.slippage_p95_bps; }},
+};
+
+bool check_shape(const std::vector<BacktestConfig>& configs, const std::vector<BacktestReport>& reports,
+                 std::string* error) {
+    if (configs.empty() || reports.size() % configs.size() != 0) {
+        if (error) *error = "reports do not cover every config";
+        return false;
+    }
+    return true;
+}
+
+bool fail(std::string* error, const std::string& what) {
+    if (error) *error = what + ": " + std::strerror(errno);
+    return false;
+}
+
+// Closes the file on every path; a failed close (or earlier write) fails the call.
+bool finish(std::FILE* f, bool ok, const std::string& path, std::string* error) {
+    ok = ok && std::ferror(f) == 0;
+    ok = std::fclose(f) == 0 && ok;
+    return ok || fail(error, "write " + path);
+}
+
+} // namespace
+
+std::vector<BacktestConfig> sweep_grid(const SweepSpace& space, const BacktestConfig& base) {
+    std::vector<BacktestConfig> out;
+    for (size_t b : space.breakout_bars)
+        for (size_t a : space.atr_period)
+            for (double r : space.risk_per_trade)
+                for (double tp : space.take_profit_atr)
+                    for (double sl : space.stop_loss_atr) out.push_back(with_point(base, b, a, r, tp, sl));
+    return out;
+}
+
+std::vector<BacktestConfig> sweep_random(const SweepSpace& space, const BacktestConfig& base, size_t count, unsigned seed) {
+    const auto b = bounds(space.breakout_bars, base.scalper.breakout_bars);
+    const auto a = bounds(space.atr_period, base.scalper.atr_period);
+    const auto r = bounds(space.risk_per_trade, base.risk_per_trade);
+    const auto tp = bounds(space.take_profit_atr, base.take_profit_atr);
+    const auto sl = bounds(space.stop_loss_atr, base.stop_loss_atr);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> breakout(b.first, b.second);
+    std::uniform_int_distribution<size_t> atr(a.first, a.second);
+    std::uniform_real_distribution<double> risk(r.first, r.second);
+    std::uniform_real_distribution<double> take(tp.first, tp.second);
+    std::uniform_real_distribution<double> stop(sl.first, sl.second);
+
+    std::vector<BacktestConfig> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        // draw in a fixed order so a seed always gives the same configs
+        const size_t pb = breakout(rng);
+        const size_t pa = atr(rng);
+        const double pr = risk(rng);
+        const double ptp = take(rng);
+        const double psl = stop(rng);
+        out.push_back(with_point(base, pb, pa, pr, ptp, psl));
+    }
+    return out;
+}
+
+std::vector<BacktestReport> run_sweep(const std::vector<BacktestConfig>& configs, const std::vector<SweepTape>& tapes,
+                                      int threads, const SweepProgressFn& on_progress) {
+    const size_t total = configs.size() * tapes.size();
+    std::vector<BacktestReport> reports(total);
+    if (total == 0) return reports;
+
+    int n = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+    n = std::max(1, std::min(n, static_cast<int>(total)));
+    // runs are numbered tape-major so a worker's block replays one tape
+    // under many configs while its pages are hot
+    StealingQueues queues(static_cast<size_t>(n), total);
+    std::atomic<size_t> done{0};
+
+    auto worker = [&](size_t self) {
+        Backtester bt;
+        size_t run = 0;
+        while (queues.next(self, run)) {
+            const size_t tape = run / configs.size();
+            const size_t config = run % configs.size();
+            const SweepTape& t = tapes[tape];
+            bt.set_config(configs[config]);
+            reports[config * tapes.size() + tape] = bt.run(t.market, t.warmup, t.trades, t.size);
+            const size_t finished = ++done;
+            if (on_progress) on_progress(finished, total);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < n; ++i) pool.emplace_back(worker, static_cast<size_t>(i));
+    worker(0);
+    for (auto& th : pool) th.join();
+    return reports;
+}
+
+bool write_sweep_csv(const std::string& path, const std::vector<BacktestConfig>& configs,
+                     const std::vector<BacktestReport>& reports, std::string* error) {
+    if (!check_shape(configs, reports, error)) return false;
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return fail(error, "open " + path);
+
+    std::fputs("market", f);
+    for (const Column& c : kColumns) std::fprintf(f, ",%s", c.name);
+    std::fputc('\n', f);
+    const size_t per_config = reports.size() / configs.size();
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const Row row{i / per_config, configs[i / per_config], reports[i]};
+        std::fputs(reports[i].market.c_str(), f);
+        for (const Column& c : kColumns) {
+            const double v = c.get(row);
+            if (c.integer) {
+                std::fprintf(f, ",%" PRIu64, static_cast<std::uint64_t>(v));
+            } else {
+                std::fprintf(f, ",%.10g", v);
+            }
+        }
+        std::fputc('\n', f);
+    }
+    return finish(f, true, path, error);
+}
+
+bool write_sweep_columns(const std::string& dir, const std::vector<BacktestConfig>& configs,
+                         const std::vector<BacktestReport>& reports, std::string* error) {
+    if (!check_shape(configs, reports, error)) return false;
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        if (error) *error = "create " + dir + ": " + ec.message();
+        return false;
+    }
+    const size_t per_config = reports.size() / configs.size();
+
+    // markets as a dictionary column
+    std::vector<std::string> names;
+    std::vector<std::uint32_t> market(reports.size());
+    for (size_t i = 0; i < reports.size(); ++i) {
+        auto it = std::find(names.begin(), names.end(), reports[i].market);
+        if (it == names.end()) it = names.insert(names.end(), reports[i].market);
+        market[i] = static_cast<std::uint32_t>(it - names.begin());
+    }
+    const std::string dict_path = dir + "/market.dict";
+    std::FILE* f = std::fopen(dict_path.c_str(), "w");
+    if (!f) return fail(error, "open " + dict_path);
+    for (const auto& name : names) std::fprintf(f, "%s\n", name.c_str());
+    if (!finish(f, true, dict_path, error)) return false;
+
+    const std::string market_path = dir + "/market.u32";
+    f = std::fopen(market_path.c_str(), "wb");
+    if (!f) return fail(error, "open " + market_path);
+    bool ok = std::fwrite(market.data(), sizeof(std::uint32_t), market.size(), f) == market.size();
+    if (!finish(f, ok, market_path, error)) return false;
+
+    std::vector<double> doubles(reports.size());
+    std::vector<std::uint64_t> ints(reports.size());
+    for (const Column& c : kColumns) {
+        for (size_t i = 0; i < reports.size(); ++i) {
+            const double v = c.get(Row{i / per_config, configs[i / per_config], reports[i]});
+            if (c.integer) {
+                ints[i] = static_cast<std::uint64_t>(v);
+            } else {
+                doubles[i] = v;
+            }
+        }
+        const std::string path = dir + "/" + c.name + (c.integer ? ".u64" : ".f64");
+        f = std::fopen(path.c_str(), "wb");
+        if (!f) return fail(error, "open " + path);
+        ok = c.integer ? std::fwrite(ints.data(), sizeof(std::uint64_t), ints.size(), f) == ints.size()
+                       : std::fwrite(doubles.data(), sizeof(double), doubles.size(), f) == doubles.size();
+        if (!finish(f, ok, path, error)) return false;
+    }
+
+    const std::string schema_path = dir + "/schema.txt";
+    f = std::fopen(schema_path.c_str(), "w");
+    if (!f) return fail(error, "open " + schema_path);
+    std::fprintf(f, "rows %zu\nmarket u32 dict=market.dict\n", reports.size());
+    for (const Column& c : kColumns) std::fprintf(f, "%s %s\n", c.name, c.integer ? "u64" : "f64");
+    return finish(f, true, schema_path, error);
+}
@@ -0,0 +1,157 @@
+#include "rate_limiter.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace {
+
+// Upbit's published per-second budgets for each group.
+constexpr double kMarketPerSec = 10.0;
+constexpr double kCandlesPerSec = 10.0;
+constexpr double kOrderPerSec = 8.0;
+constexpr double kDefaultPerSec = 30.0;
+// slack for a High try_acquire caller to come back after its wait
+constexpr auto kHighClaimGrace = std::chrono::milliseconds(50);
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r' || s.back() == '\n')) s.remove_suffix(1);
+    return s;
+}
+
+} // namespace
+
+RateLimiter::RateLimiter() {
+    configure(RateGroup::Market, kMarketPerSec);
+    configure(RateGroup::Candles, kCandlesPerSec);
+    configure(RateGroup::Order, kOrderPerSec);
+    configure(RateGroup::Default, kDefaultPerSec);
+}
+
+RateGroup RateLimiter::group_from_name(std::string_view name) {
+    if (name == "candles" || name == "candle") return RateGroup::Candles;
+    if (name == "market" || name == "ticker" || name == "orderbook" || name == "trades") return RateGroup::Market;
+    if (name == "order" || name == "order-cancel-all") return RateGroup::Order;
+    return RateGroup::Default;
+}
+
+bool RateLimiter::parse_remaining_req(std::string_view header, RemainingReq& out) {
+    bool has_group = false;
+    while (!header.empty()) {
+        const size_t semi = header.find(';');
+        const std::string_view part = trim(header.substr(0, semi));
+        header = semi == std::string_view::npos ? std::string_view{} : header.substr(semi + 1);
+        const size_t eq = part.find('=');
+        if (eq == std::string_view::npos) continue;
+        const std::string_view key = trim(part.substr(0, eq));
+        const std::string_view value = trim(part.substr(eq + 1));
+        if (key == "group") {
+            out.group = group_from_name(value);
+            has_group = true;
+        } else if (key == "sec" || key == "min") {
+            int v = -1;
+            if (std::from_chars(value.data(), value.data() + value.size(), v).ec != std::errc()) continue;
+            if (key == "sec") out.per_sec = v;
+            else out.per_min = v;
+        }
+    }
+    return has_group && out.per_sec >= 0;
+}
+
+void RateLimiter::configure(RateGroup group, double requests_per_sec) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket& b = bucket(group);
+    b.capacity = std::max(1.0, requests_per_sec);
+    b.refill_per_sec = b.capacity;
+    b.tokens = b.capacity;
+    b.last_refill = Clock::now();
+}
+
+void RateLimiter::refill(Bucket& b, Clock::time_point now) {
+    const double elapsed = std::chrono::duration<double>(now - b.last_refill).count();
+    if (elapsed > 0.0) {
+        b.tokens = std::min(b.capacity, b.tokens + elapsed * b.refill_per_sec);
+        b.last_refill = now;
+    }
+}
+
+RateLimiter::Clock::duration RateLimiter::take_locked(Bucket& b, RateLane lane, Clock::time_point now) {
+    const auto one_token = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / b.refill_per_sec));
+    if (lane == RateLane::Low && (b.high_waiting > 0 || now < b.high_claim_until)) {
+        return std::max<Clock::duration>(one_token, b.blocked_until - now);
+    }
+    Clock::duration wait = b.blocked_until - now;
+    if (now >= b.blocked_until) {
+        refill(b, now);
+        if (b.tokens >= 1.0) {
+            b.tokens -= 1.0;
+            ++b.stats.granted;
+            if (lane == RateLane::High) b.high_claim_until = {};
+            return Clock::duration::zero();
+        }
+        wait = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((1.0 - b.tokens) / b.refill_per_sec));
+    }
+    if (lane == RateLane::High) b.high_claim_until = std::max(b.high_claim_until, now + wait + kHighClaimGrace);
+    return wait;
+}
+
+void RateLimiter::acquire(RateGroup group, RateLane lane) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Bucket& b = bucket(group);
+    bool waiting_high = false;
+    bool delayed = false;
+    for (;;) {
+        const auto wait = take_locked(b, lane, Clock::now());
+        if (wait == Clock::duration::zero()) break;
+        if (lane == RateLane::High && !waiting_high) {
+            ++b.high_waiting;
+            waiting_high = true;
+        }
+        delayed = true;
+        cv_.wait_for(lock, wait);
+    }
+    if (delayed) ++b.stats.delayed;
+    if (waiting_high) {
+        --b.high_waiting;
+        cv_.notify_all();
+    }
+}
+
+long RateLimiter::try_acquire(RateGroup group, RateLane lane) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket& b = bucket(group);
+    const auto wait = take_locked(b, lane, Clock::now());
+    if (wait == Clock::duration::zero()) return 0;
+    ++b.stats.delayed;
+    return std::max<long>(1, static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(wait).count()));
+}
+
+void RateLimiter::on_response(std::string_view remaining_req_header) {
+    RemainingReq rr;
+    if (!parse_remaining_req(remaining_req_header, rr)) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket& b = bucket(rr.group);
+    const auto now = Clock::now();
+    refill(b, now);
+    // the server is authoritative; never believe we have more than it says
+    b.tokens = std::min(b.tokens, static_cast<double>(rr.per_sec));
+    if (rr.per_sec == 0) b.blocked_until = std::max(b.blocked_until, now + std::chrono::seconds(1));
+}
+
+void RateLimiter::on_rate_limited(RateGroup group) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket& b = bucket(group);
+    const auto now = Clock::now();
+    b.tokens = 0.0;
+    b.last_refill = now;
+    b.blocked_until = std::max(b.blocked_until, now + std::chrono::seconds(1));
+    ++b.stats.rate_limited;
+}
+
+RateGroupStats RateLimiter::stats(RateGroup group) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RateGroupStats s = buckets_[static_cast<size_t>(group)].stats;
+    s.tokens = buckets_[static_cast<size_t>(group)].tokens;
+    return s;
+}
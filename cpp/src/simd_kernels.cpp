@@ -0,0 +1,107 @@
+#include "simd_kernels.hpp"
+#include <atomic>
+#include "simd_kernels_impl.hpp"
+
+namespace {
+
+constexpr SimdKernelTable kScalarKernels = make_kernel_table<ScalarOps>();
+#if defined(__SSE2__)
+constexpr SimdKernelTable kSse2Kernels = make_kernel_table<Sse2Ops>();
+#endif
+
+const SimdKernelTable* table_for(SimdIsa isa) {
+    switch (isa) {
+#if defined(UPBIT_AVX2_KERNELS)
+    case SimdIsa::Avx2: return &kSimdAvx2Kernels;
+#endif
+#if defined(__SSE2__)
+    case SimdIsa::Sse2: return &kSse2Kernels;
+#endif
+    default: return &kScalarKernels;
+    }
+}
+
+SimdIsa detect_isa() {
+#if defined(UPBIT_AVX2_KERNELS) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdIsa::Avx2;
+#endif
+#if defined(__SSE2__)
+    return SimdIsa::Sse2;
+#else
+    return SimdIsa::Scalar;
+#endif
+}
+
+std::atomic<SimdIsa> g_isa{SimdIsa::Scalar};
+std::atomic<const SimdKernelTable*> g_kernels{nullptr};
+
+const SimdKernelTable& kernels() {
+    const SimdKernelTable* t = g_kernels.load(std::memory_order_acquire);
+    if (t) return *t;
+    simd_set_isa(simd_best_isa());
+    return *g_kernels.load(std::memory_order_acquire);
+}
+
+} // namespace
+
+SimdIsa simd_best_isa() {
+    static const SimdIsa best = detect_isa();
+    return best;
+}
+
+SimdIsa simd_active_isa() {
+    kernels();
+    return g_isa.load(std::memory_order_relaxed);
+}
+
+SimdIsa simd_set_isa(SimdIsa isa) {
+    if (static_cast<int>(isa) > static_cast<int>(simd_best_isa())) isa = simd_best_isa();
+    g_isa.store(isa, std::memory_order_relaxed);
+    g_kernels.store(table_for(isa), std::memory_order_release);
+    return isa;
+}
+
+const char* simd_isa_name(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::Avx2: return "avx2";
+    case SimdIsa::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+void simd_log_returns(const double* close, size_t n, double* out) {
+    kernels().log_returns(close, n, out);
+}
+
+double simd_sum_sq_log_returns(const double* close, size_t n) {
+    return kernels().sum_sq_log_returns(close, n);
+}
+
+void simd_true_ranges(const double* high, const double* low, const double* close, size_t n, double* out) {
+    kernels().true_ranges(high, low, close, n, out);
+}
+
+double simd_sum_true_ranges(const double* high, const double* low, const double* close, size_t n) {
+    return kernels().sum_true_ranges(high, low, close, n);
+}
+
+double simd_sum_sq(const double* v, size_t n) {
+    return kernels().sum_sq(v, n);
+}
+
+double simd_max(const double* v, size_t n) {
+    return kernels().max_of(v, n);
+}
+
+double simd_min(const double* v, size_t n) {
+    return kernels().min_of(v, n);
+}
+
+void simd_rolling_max(const double* v, size_t n, size_t window, double* out) {
+    kernels().rolling_max(v, n, window, out);
+}
+
+void simd_rolling_min(const double* v, size_t n, size_t window, double* out) {
+    kernels().rolling_min(v, n, window, out);
+}
@@ -0,0 +1,5 @@
+// Built with -mavx2 -mfma (see CMakeLists.txt); only reached through the
+// dispatch in simd_kernels.cpp once the CPU has been checked.
+#include "simd_kernels_impl.hpp"
+
+const SimdKernelTable kSimdAvx2Kernels = make_kernel_table<Avx2Ops>();
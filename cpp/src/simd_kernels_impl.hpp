@@ -0,0 +1,290 @@
+#pragma once
+// Kernel bodies shared by simd_kernels.cpp (scalar, SSE2) and
+// simd_kernels_avx2.cpp (built with -mavx2 -mfma). Everything below has
+// internal linkage, and the file sticks to operators and C math calls rather
+// than inline library templates (std::max and friends): a weak out-of-line
+// copy compiled for AVX2 must never be what the rest of the program links to.
+#include <cmath>
+#include <cstddef>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+struct SimdKernelTable {
+    void (*log_returns)(const double*, size_t, double*);
+    double (*sum_sq_log_returns)(const double*, size_t);
+    void (*true_ranges)(const double*, const double*, const double*, size_t, double*);
+    double (*sum_true_ranges)(const double*, const double*, const double*, size_t);
+    double (*sum_sq)(const double*, size_t);
+    double (*max_of)(const double*, size_t);
+    double (*min_of)(const double*, size_t);
+    void (*rolling_max)(const double*, size_t, size_t, double*);
+    void (*rolling_min)(const double*, size_t, size_t, double*);
+};
+
+#if defined(UPBIT_AVX2_KERNELS)
+extern const SimdKernelTable kSimdAvx2Kernels;
+#endif
+
+namespace {
+
+constexpr double kSqrt2 = 1.41421356237309504880;
+constexpr double kLn2Hi = 6.93147180369123816490e-01; // low bits zero, so e * kLn2Hi is exact
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kInf = HUGE_VAL;
+
+inline double max_scalar(double a, double b) { return a > b ? a : b; }
+inline double min_scalar(double a, double b) { return a < b ? a : b; }
+inline double abs_scalar(double x) { return x < 0.0 ? -x : x; }
+inline double true_range_scalar(double high, double low, double prev_close) {
+    return max_scalar(high - low, max_scalar(abs_scalar(high - prev_close), abs_scalar(low - prev_close)));
+}
+
+struct ScalarOps {
+    using reg = double;
+    static constexpr size_t kWidth = 1;
+    static reg load(const double* p) { return *p; }
+    static void store(double* p, reg v) { *p = v; }
+    static reg set1(double v) { return v; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg sub(reg a, reg b) { return a - b; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg div(reg a, reg b) { return a / b; }
+    static reg mul_add(reg a, reg b, reg c) { return a * b + c; }
+    static reg max(reg a, reg b) { return max_scalar(a, b); }
+    static reg min(reg a, reg b) { return min_scalar(a, b); }
+    static reg abs(reg a) { return abs_scalar(a); }
+    static reg log(reg a) { return std::log(a); }
+    static double hsum(reg a) { return a; }
+    static double hmax(reg a) { return a; }
+    static double hmin(reg a) { return a; }
+};
+
+// log(x) for positive normal x: x = m * 2^e with m in [sqrt(1/2), sqrt(2)),
+// log(m) = 2 atanh(u), u = (m - 1) / (m + 1), |u| < 0.172. The odd series to
+// u^21 is below half an ulp there, so results are within a couple of ulps
+// of std::log.
+template <typename V>
+typename V::reg log_poly(typename V::reg x) {
+    using R = typename V::reg;
+    R e;
+    R m = V::split_exponent(x, e);
+    const R big = V::greater(m, V::set1(kSqrt2));
+    m = V::select(big, V::mul(m, V::set1(0.5)), m);
+    e = V::select(big, V::add(e, V::set1(1.0)), e);
+
+    const R one = V::set1(1.0);
+    const R u = V::div(V::sub(m, one), V::add(m, one));
+    const R u2 = V::mul(u, u);
+    R p = V::set1(1.0 / 21.0);
+    p = V::mul_add(p, u2, V::set1(1.0 / 19.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 17.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 15.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 13.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 11.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 9.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 7.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 5.0));
+    p = V::mul_add(p, u2, V::set1(1.0 / 3.0));
+    const R two_u = V::add(u, u);
+    const R log_m = V::mul_add(V::mul(two_u, u2), p, two_u);
+    return V::mul_add(e, V::set1(kLn2Hi), V::mul_add(e, V::set1(kLn2Lo), log_m));
+}
+
+#if defined(__SSE2__)
+struct Sse2Ops {
+    using reg = __m128d;
+    static constexpr size_t kWidth = 2;
+    static reg load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+    static reg mul_add(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+    static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+    static reg abs(reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    // Two lanes are not enough to beat libm with the polynomial (no FMA here).
+    static reg log(reg a) {
+        return _mm_set_pd(std::log(_mm_cvtsd_f64(_mm_unpackhi_pd(a, a))), std::log(_mm_cvtsd_f64(a)));
+    }
+    static double hsum(reg a) { return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a))); }
+    static double hmax(reg a) { return _mm_cvtsd_f64(_mm_max_sd(a, _mm_unpackhi_pd(a, a))); }
+    static double hmin(reg a) { return _mm_cvtsd_f64(_mm_min_sd(a, _mm_unpackhi_pd(a, a))); }
+};
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+struct Avx2Ops {
+    using reg = __m256d;
+    static constexpr size_t kWidth = 4;
+    static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm256_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+    static reg mul_add(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+    static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+    static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+    static reg abs(reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static reg greater(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static reg select(reg mask, reg a, reg b) { return _mm256_blendv_pd(b, a, mask); }
+    static reg split_exponent(reg x, reg& e) {
+        const __m256i bits = _mm256_castpd_si256(x);
+        const __m256i biased = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x4330000000000000LL));
+        e = _mm256_sub_pd(_mm256_castsi256_pd(biased), _mm256_set1_pd(4503599627370496.0 + 1023.0));
+        const __m256i mant = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                             _mm256_set1_epi64x(0x3FF0000000000000LL));
+        return _mm256_castsi256_pd(mant);
+    }
+    static reg log(reg a) { return log_poly<Avx2Ops>(a); }
+    static double hsum(reg a) { return Sse2Ops::hsum(_mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1))); }
+    static double hmax(reg a) { return Sse2Ops::hmax(_mm_max_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1))); }
+    static double hmin(reg a) { return Sse2Ops::hmin(_mm_min_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1))); }
+};
+#endif
+
+// Each kernel runs whole registers first, then finishes the tail one value
+// at a time with the scalar formula.
+
+template <typename V>
+void log_returns_k(const double* close, size_t n, double* out) {
+    if (n < 2) return;
+    const size_t m = n - 1;
+    size_t i = 0;
+    for (; i + V::kWidth <= m; i += V::kWidth) {
+        V::store(out + i, V::log(V::div(V::load(close + i + 1), V::load(close + i))));
+    }
+    for (; i < m; ++i) out[i] = std::log(close[i + 1] / close[i]);
+}
+
+template <typename V>
+double sum_sq_log_returns_k(const double* close, size_t n) {
+    if (n < 2) return 0.0;
+    const size_t m = n - 1;
+    typename V::reg acc = V::set1(0.0);
+    size_t i = 0;
+    for (; i + V::kWidth <= m; i += V::kWidth) {
+        const typename V::reg r = V::log(V::div(V::load(close + i + 1), V::load(close + i)));
+        acc = V::mul_add(r, r, acc);
+    }
+    double s = V::hsum(acc);
+    for (; i < m; ++i) {
+        const double r = std::log(close[i + 1] / close[i]);
+        s += r * r;
+    }
+    return s;
+}
+
+template <typename V>
+typename V::reg true_range_v(const double* high, const double* low, const double* prev_close) {
+    const typename V::reg h = V::load(high);
+    const typename V::reg l = V::load(low);
+    const typename V::reg pc = V::load(prev_close);
+    return V::max(V::sub(h, l), V::max(V::abs(V::sub(h, pc)), V::abs(V::sub(l, pc))));
+}
+
+template <typename V>
+void true_ranges_k(const double* high, const double* low, const double* close, size_t n, double* out) {
+    if (n < 2) return;
+    const size_t m = n - 1;
+    size_t i = 0;
+    for (; i + V::kWidth <= m; i += V::kWidth) V::store(out + i, true_range_v<V>(high + i + 1, low + i + 1, close + i));
+    for (; i < m; ++i) out[i] = true_range_scalar(high[i + 1], low[i + 1], close[i]);
+}
+
+template <typename V>
+double sum_true_ranges_k(const double* high, const double* low, const double* close, size_t n) {
+    if (n < 2) return 0.0;
+    const size_t m = n - 1;
+    typename V::reg acc = V::set1(0.0);
+    size_t i = 0;
+    for (; i + V::kWidth <= m; i += V::kWidth) acc = V::add(acc, true_range_v<V>(high + i + 1, low + i + 1, close + i));
+    double s = V::hsum(acc);
+    for (; i < m; ++i) s += true_range_scalar(high[i + 1], low[i + 1], close[i]);
+    return s;
+}
+
+template <typename V>
+double sum_sq_k(const double* v, size_t n) {
+    typename V::reg acc = V::set1(0.0);
+    size_t i = 0;
+    for (; i + V::kWidth <= n; i += V::kWidth) {
+        const typename V::reg x = V::load(v + i);
+        acc = V::mul_add(x, x, acc);
+    }
+    double s = V::hsum(acc);
+    for (; i < n; ++i) s += v[i] * v[i];
+    return s;
+}
+
+template <typename V>
+double max_of_k(const double* v, size_t n) {
+    typename V::reg acc = V::set1(-kInf);
+    size_t i = 0;
+    for (; i + V::kWidth <= n; i += V::kWidth) acc = V::max(acc, V::load(v + i));
+    double r = V::hmax(acc);
+    for (; i < n; ++i) r = max_scalar(r, v[i]);
+    return r;
+}
+
+template <typename V>
+double min_of_k(const double* v, size_t n) {
+    typename V::reg acc = V::set1(kInf);
+    size_t i = 0;
+    for (; i + V::kWidth <= n; i += V::kWidth) acc = V::min(acc, V::load(v + i));
+    double r = V::hmin(acc);
+    for (; i < n; ++i) r = min_scalar(r, v[i]);
+    return r;
+}
+
+// Window-at-a-time: O(n * window / width), which beats a monotonic deque for
+// the short lookbacks the strategies use.
+template <typename V>
+void rolling_max_k(const double* v, size_t n, size_t window, double* out) {
+    if (window == 0 || n < window) return;
+    const size_t m = n - window + 1;
+    size_t i = 0;
+    for (; i + V::kWidth <= m; i += V::kWidth) {
+        typename V::reg acc = V::load(v + i);
+        for (size_t k = 1; k < window; ++k) acc = V::max(acc, V::load(v + i + k));
+        V::store(out + i, acc);
+    }
+    for (; i < m; ++i) {
+        double r = v[i];
+        for (size_t k = 1; k < window; ++k) r = max_scalar(r, v[i + k]);
+        out[i] = r;
+    }
+}
+
+template <typename V>
+void rolling_min_k(const double* v, size_t n, size_t window, double* out) {
+    if (window == 0 || n < window) return;
+    const size_t m = n - window + 1;
+    size_t i = 0;
+    for (; i + V::kWidth <= m; i += V::kWidth) {
+        typename V::reg acc = V::load(v + i);
+        for (size_t k = 1; k < window; ++k) acc = V::min(acc, V::load(v + i + k));
+        V::store(out + i, acc);
+    }
+    for (; i < m; ++i) {
+        double r = v[i];
+        for (size_t k = 1; k < window; ++k) r = min_scalar(r, v[i + k]);
+        out[i] = r;
+    }
+}
+
+template <typename V>
+constexpr SimdKernelTable make_kernel_table() {
+    return SimdKernelTable{
+        &log_returns_k<V>,   &sum_sq_log_returns_k<V>, &true_ranges_k<V>,
+        &sum_true_ranges_k<V>, &sum_sq_k<V>,           &max_of_k<V>,
+        &min_of_k<V>,        &rolling_max_k<V>,        &rolling_min_k<V>,
+    };
+}
+
+} // namespace
@@ -1,23 +1,24 @@
 #include "strategy_5m_scalper.hpp"
 #include <algorithm>
+#include "order_book.hpp"
 
-static double atr5(const std::vector<Candle>& c, int n) {
-    if ((int)c.size() < n+1) return 0.0;
-    double s = 0.0; int k = 0;
-    for (size_t i = c.size()-n; i < c.size(); ++i) {
-        double tr = std::max({c[i].high - c[i].low, std::abs(c[i].high - c[i-1].close), std::abs(c[i].low - c[i-1].close)});
-        s += tr; ++k;
-    }
-    return k? s/k : 0.0;
+namespace {
+ScalperParams sanitized(ScalperParams p) {
+    p.atr_period = std::max<size_t>(2, p.atr_period);
+    p.breakout_bars = std::max<size_t>(1, p.breakout_bars);
+    p.min_bars = std::max(p.min_bars, p.breakout_bars + 1);
+    return p;
+}
 }
 
-TradeDecision Strategy5mScalper::evaluate(const std::vector<Candle>& c) {
+Strategy5mScalper::Strategy5mScalper(ScalperParams params) : params_(sanitized(params)) {}
+
+TradeDecision Strategy5mScalper::evaluate(CandleSpan c) {
     TradeDecision d;
-    if (c.size() < 8) return d;
+    if (c.size() < params_.min_bars) return d;
     const auto& last = c.back();
-    double atr = atr5(c, 14);
-    double hh = last.high;
-    for (size_t i = c.size()-6; i < c.size()-1; ++i) hh = std::max(hh, c[i].high);
+    double atr = batch_sma_atr(c, params_.atr_period);
+    double hh = batch_highest_high(c, c.size() - 1 - params_.breakout_bars, c.size() - 1);
     bool breakout = last.close > hh;
     if (breakout && atr > 0.0) {
         d.enter_long = true;
@@ -26,3 +27,60 @@ TradeDecision Strategy5mScalper::evaluate(const std::vector<Candle>& c) {
     return d;
 }
 
+TradeDecision Strategy5mScalper::evaluate(CandleSpan c, const OrderBook& book, double size) {
+    TradeDecision d = evaluate(c);
+    if (!d.enter_long || book.empty() || size <= 0.0) return d;
+    double filled = 0.0;
+    d.expected_price = book.vwap_to_size(BookSide::Ask, size, &filled);
+    if (filled < size) {
+        d.enter_long = false;
+        return d;
+    }
+    double cum = 0.0;
+    for (int i = 0; i < book.depth(BookSide::Ask); ++i) {
+        const PriceLevel& lvl = book.level(BookSide::Ask, i);
+        cum += lvl.size;
+        if (cum >= size) {
+            d.limit_price = lvl.price;
+            break;
+        }
+    }
+    return d;
+}
+
+ScalperStream::ScalperStream(ScalperParams params)
+    : params_(sanitized(params)), closed_tr_(params_.atr_period - 1), closed_high_(params_.breakout_bars) {}
+
+void ScalperStream::reset() {
+    closed_tr_.reset();
+    closed_high_.reset();
+    prev_close_ = 0.0;
+    closed_ = 0;
+}
+
+void ScalperStream::seed(CandleSpan c) {
+    reset();
+    for (size_t i = 0; i + 1 < c.size(); ++i) on_bar_close(c[i]);
+}
+
+void ScalperStream::on_bar_close(const Candle& bar) {
+    if (closed_ > 0) closed_tr_.push(true_range(bar, prev_close_));
+    closed_high_.push(bar.high);
+    prev_close_ = bar.close;
+    ++closed_;
+}
+
+TradeDecision ScalperStream::on_tick(const Candle& forming) const {
+    TradeDecision d;
+    if (closed_ + 1 < params_.min_bars) return d;
+    // ATR over the forming bar plus the last atr_period - 1 closed bars, as evaluate() does
+    double atr = 0.0;
+    if (closed_ >= params_.atr_period) {
+        atr = (closed_tr_.sum() + true_range(forming, prev_close_)) / static_cast<double>(params_.atr_period);
+    }
+    if (forming.close > closed_high_.value() && atr > 0.0) {
+        d.enter_long = true;
+        d.limit_price = forming.close;
+    }
+    return d;
+}
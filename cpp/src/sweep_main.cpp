@@ -0,0 +1,204 @@
+// Sweeps the scalper's parameters over archived (or synthetic) tapes on every
+// core. Each list flag gives the values to grid over; with --random N, N
+// configs are drawn between each list's smallest and largest value instead.
+//
+//   sweep [--archive DIR] [--from-ms T] [--to-ms T] [--synthetic DAYS]
+//         [--breakout 3,5,8] [--atr 10,14,20] [--risk 0.005,0.01]
+//         [--tp 1,1.5,2] [--sl 0.5,1] [--random N] [--seed S]
+//         [--latency-ms N] [--touch] [--threads N]
+//         [--csv sweep.csv] [--columns DIR] [--top K] [MARKET...]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "param_sweep.hpp"
+
+namespace {
+
+struct Options {
+    std::string archive_dir;
+    long long from_ms{0};
+    long long to_ms{0};
+    int synthetic_days{0};
+    int threads{0};
+    size_t random{0};
+    unsigned seed{1};
+    size_t top{10};
+    std::string csv{"sweep.csv"};
+    std::string columns;
+    SweepSpace space;
+    BacktestConfig base;
+    std::vector<std::string> markets;
+};
+
+template <typename T>
+std::vector<T> parse_list(const char* s) {
+    std::vector<T> out;
+    while (*s) {
+        char* end = nullptr;
+        const double v = std::strtod(s, &end);
+        if (end == s) break;
+        out.push_back(static_cast<T>(v));
+        s = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+bool parse(int argc, char** argv, Options& opt) {
+    if (const char* dir = std::getenv("UPBIT_ARCHIVE_DIR")) opt.archive_dir = dir;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto value = [&]() -> const char* {
+            ++i;
+            return next;
+        };
+        if (std::strcmp(arg, "--touch") == 0) {
+            opt.base.fill.fill_on_touch = true;
+        } else if (arg[0] == '-' && arg[1] == '-' && !next) {
+            std::cerr << "sweep: " << arg << " needs a value\n";
+            return false;
+        } else if (std::strcmp(arg, "--archive") == 0) {
+            opt.archive_dir = value();
+        } else if (std::strcmp(arg, "--from-ms") == 0) {
+            opt.from_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--to-ms") == 0) {
+            opt.to_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--synthetic") == 0) {
+            opt.synthetic_days = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--breakout") == 0) {
+            opt.space.breakout_bars = parse_list<size_t>(value());
+        } else if (std::strcmp(arg, "--atr") == 0) {
+            opt.space.atr_period = parse_list<size_t>(value());
+        } else if (std::strcmp(arg, "--risk") == 0) {
+            opt.space.risk_per_trade = parse_list<double>(value());
+        } else if (std::strcmp(arg, "--tp") == 0) {
+            opt.space.take_profit_atr = parse_list<double>(value());
+        } else if (std::strcmp(arg, "--sl") == 0) {
+            opt.space.stop_loss_atr = parse_list<double>(value());
+        } else if (std::strcmp(arg, "--random") == 0) {
+            opt.random = static_cast<size_t>(std::strtoull(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            opt.seed = static_cast<unsigned>(std::strtoul(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--latency-ms") == 0) {
+            opt.base.fill.latency_ms = std::strtoll(value(), nullptr, 10);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            opt.threads = static_cast<int>(std::strtol(value(), nullptr, 10));
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            opt.csv = value();
+        } else if (std::strcmp(arg, "--columns") == 0) {
+            opt.columns = value();
+        } else if (std::strcmp(arg, "--top") == 0) {
+            opt.top = static_cast<size_t>(std::strtoull(value(), nullptr, 10));
+        } else if (arg[0] == '-') {
+            std::cerr << "sweep: unknown option " << arg << '\n';
+            return false;
+        } else {
+            opt.markets.emplace_back(arg);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse(argc, argv, opt)) return 2;
+
+    // tapes stay mapped (or in memory) for the whole sweep; every run reads them in place
+    std::unique_ptr<MarketArchive> archive;
+    std::vector<std::unique_ptr<ReplayData>> replays;
+    std::vector<std::vector<TradeRecord>> synthetic;
+    std::vector<SweepTape> tapes;
+    if (opt.synthetic_days > 0) {
+        if (opt.markets.empty()) opt.markets = {"SYN-A", "SYN-B", "SYN-C", "SYN-D"};
+        for (size_t i = 0; i < opt.markets.size(); ++i) {
+            synthetic.push_back(synthetic_tape(opt.from_ms > 0 ? opt.from_ms : 1'700'000'000'000LL, opt.synthetic_days,
+                                               10'000.0 * static_cast<double>(i + 1), static_cast<unsigned>(i + 1)));
+            tapes.push_back(SweepTape{opt.markets[i], CandleSpan(), synthetic.back().data(), synthetic.back().size()});
+        }
+    } else {
+        if (opt.archive_dir.empty()) {
+            std::cerr << "sweep: no archive (set --archive or UPBIT_ARCHIVE_DIR) and no --synthetic\n";
+            return 2;
+        }
+        archive = std::make_unique<MarketArchive>(opt.archive_dir);
+        if (opt.markets.empty()) opt.markets = replay_markets(opt.archive_dir);
+        for (const auto& market : opt.markets) {
+            auto data = std::make_unique<ReplayData>();
+            std::string error;
+            if (!open_replay(*archive, market, opt.from_ms, opt.to_ms, *data, &error)) {
+                std::cerr << "sweep: " << error << '\n';
+                continue;
+            }
+            tapes.push_back(SweepTape{market, data->warmup, data->trades.data() + data->begin, data->end - data->begin});
+            replays.push_back(std::move(data));
+        }
+    }
+    if (tapes.empty()) {
+        std::cerr << "sweep: no tapes\n";
+        return 2;
+    }
+
+    const std::vector<BacktestConfig> configs =
+        opt.random > 0 ? sweep_random(opt.space, opt.base, opt.random, opt.seed) : sweep_grid(opt.space, opt.base);
+    if (configs.empty()) {
+        std::cerr << "sweep: empty parameter space\n";
+        return 2;
+    }
+    std::fprintf(stderr, "sweep: %zu configs x %zu tapes\n", configs.size(), tapes.size());
+
+    std::mutex progress_mutex;
+    size_t last_pct = 0;
+    const auto started = std::chrono::steady_clock::now();
+    const auto reports = run_sweep(configs, tapes, opt.threads, [&](size_t done, size_t total) {
+        const size_t pct = done * 100 / total;
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        if (pct <= last_pct && done != total) return;
+        last_pct = pct;
+        std::fprintf(stderr, "\rsweep: %zu/%zu runs (%zu%%)", done, total, pct);
+        if (done == total) std::fputc('\n', stderr);
+    });
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::string error;
+    if (!opt.csv.empty() && !write_sweep_csv(opt.csv, configs, reports, &error)) {
+        std::cerr << "sweep: " << error << '\n';
+        return 1;
+    }
+    if (!opt.columns.empty() && !write_sweep_columns(opt.columns, configs, reports, &error)) {
+        std::cerr << "sweep: " << error << '\n';
+        return 1;
+    }
+
+    // rank configs by net PnL summed over the tapes
+    std::vector<std::pair<double, size_t>> ranked(configs.size());
+    size_t prints = 0;
+    for (size_t c = 0; c < configs.size(); ++c) {
+        ranked[c] = {0.0, c};
+        for (size_t t = 0; t < tapes.size(); ++t) {
+            const BacktestReport& r = reports[c * tapes.size() + t];
+            ranked[c].first += r.net_pnl;
+            prints += r.prints;
+        }
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for (size_t i = 0; i < std::min(opt.top, ranked.size()); ++i) {
+        const BacktestConfig& c = configs[ranked[i].second];
+        std::printf("#%zu config=%zu breakout=%zu atr=%zu risk=%.4f tp=%.2f sl=%.2f net=%.0f\n", i + 1, ranked[i].second,
+                    c.scalper.breakout_bars, c.scalper.atr_period, c.risk_per_trade, c.take_profit_atr, c.stop_loss_atr,
+                    ranked[i].first);
+    }
+    std::printf("%zu runs, %zu prints in %.2fs (%.1fM prints/s)\n", reports.size(), prints, secs,
+                secs > 0.0 ? static_cast<double>(prints) / secs / 1e6 : 0.0);
+    return 0;
+}
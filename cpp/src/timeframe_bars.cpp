@@ -0,0 +1,125 @@
+#include "timeframe_bars.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr std::array<int, kTimeframeCount> kMinutes{{1, 3, 5, 15, 60}};
+
+void merge_into(Candle& into, const Candle& c) {
+    into.high = std::max(into.high, c.high);
+    into.low = std::min(into.low, c.low);
+    into.close = c.close;
+    into.volume += c.volume;
+}
+
+std::vector<Candle> aligned(CandleSpan bars, Timeframe tf) {
+    std::vector<Candle> out = bars.to_vector();
+    for (Candle& c : out) c.ts_ms = bar_open_ms(c.ts_ms, tf);
+    return out;
+}
+
+// Both oldest first; on equal timestamps the bar from `newer` wins.
+std::vector<Candle> merge_by_time(CandleSpan older, CandleSpan newer) {
+    std::vector<Candle> out;
+    out.reserve(older.size() + newer.size());
+    size_t i = 0, j = 0;
+    while (i < older.size() || j < newer.size()) {
+        if (j == newer.size() || (i < older.size() && older[i].ts_ms < newer[j].ts_ms)) {
+            out.push_back(older[i++]);
+        } else {
+            if (i < older.size() && older[i].ts_ms == newer[j].ts_ms) ++i;
+            out.push_back(newer[j++]);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int timeframe_minutes(Timeframe tf) {
+    return kMinutes[static_cast<size_t>(tf)];
+}
+
+const char* timeframe_name(Timeframe tf) {
+    switch (tf) {
+    case Timeframe::M1: return "1m";
+    case Timeframe::M3: return "3m";
+    case Timeframe::M5: return "5m";
+    case Timeframe::M15: return "15m";
+    case Timeframe::M60: return "60m";
+    }
+    return "unknown";
+}
+
+std::vector<Candle> resample(CandleSpan bars, Timeframe tf) {
+    std::vector<Candle> out;
+    for (const Candle& c : bars) {
+        const long long open = bar_open_ms(c.ts_ms, tf);
+        if (!out.empty() && out.back().ts_ms == open) {
+            merge_into(out.back(), c);
+        } else if (out.empty() || open > out.back().ts_ms) {
+            out.push_back(c);
+            out.back().ts_ms = open;
+        }
+    }
+    return out;
+}
+
+void TimeframeBars::seed(Timeframe tf, CandleSpan bars) {
+    clear();
+    const std::vector<Candle> own = aligned(bars, tf);
+    series_[static_cast<size_t>(tf)].assign(own);
+    for (size_t i = static_cast<size_t>(tf) + 1; i < kTimeframeCount; ++i) {
+        if (kMinutes[i] % timeframe_minutes(tf) != 0) continue;
+        series_[i].assign(resample(own, static_cast<Timeframe>(i)));
+    }
+}
+
+void TimeframeBars::merge(Timeframe tf, CandleSpan bars) {
+    if (bars.empty()) return;
+    const std::vector<Candle> own = aligned(bars, tf);
+    Series& base = series_[static_cast<size_t>(tf)];
+    base.assign(merge_by_time(base.view(), own));
+    if (base.empty()) return;
+    for (size_t i = static_cast<size_t>(tf) + 1; i < kTimeframeCount; ++i) {
+        if (kMinutes[i] % timeframe_minutes(tf) != 0) continue;
+        const auto longer = static_cast<Timeframe>(i);
+        const long long from = bar_open_ms(own.front().ts_ms, longer);
+        const long long to = bar_open_ms(own.back().ts_ms, longer);
+        // only buckets `base` covers from their start
+        std::vector<Candle> touched;
+        for (const Candle& c : resample(base.view(), longer)) {
+            if (c.ts_ms >= from && c.ts_ms <= to && c.ts_ms >= base.front().ts_ms) touched.push_back(c);
+        }
+        series_[i].assign(merge_by_time(series_[i].view(), touched));
+    }
+}
+
+void TimeframeBars::clear() {
+    for (Series& s : series_) s.clear();
+}
+
+unsigned TimeframeBars::on_trade(long long ts_ms, double price, double volume) {
+    unsigned closed = 0;
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        Series& s = series_[i];
+        if (!s.empty()) {
+            const Candle& last = s.back();
+            if (ts_ms < last.ts_ms) continue;
+            // still inside the forming bar: no division on the common path
+            if (ts_ms - last.ts_ms < kMinutes[i] * 60'000LL) {
+                Candle bar = last;
+                bar.close = price;
+                bar.high = std::max(bar.high, price);
+                bar.low = std::min(bar.low, price);
+                bar.volume += volume;
+                s.set_back(bar);
+                continue;
+            }
+            closed |= 1u << i;
+        }
+        const long long open = bar_open_ms(ts_ms, static_cast<Timeframe>(i));
+        s.push_back(Candle{open, price, price, price, price, volume});
+    }
+    return closed;
+}
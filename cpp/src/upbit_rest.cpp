@@ -1,14 +1,15 @@
 #include "upbit_rest.hpp"
-#include <curl/curl.h>
-#include <openssl/evp.h>
-#include <openssl/hmac.h>
-#include <openssl/sha.h>
+#include "async_http.hpp"
+#include "http_pool.hpp"
+#include "json_scan.hpp"
+#include "latency_histogram.hpp"
+#include "timeframe_bars.hpp"
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdlib>
+#include <ctime>
 #include <iomanip>
-#include <mutex>
-#include <random>
 #include <sstream>
 #include <stdexcept>
 
@@ -16,68 +17,7 @@ namespace {
 
 constexpr double kMinNotionalKRW = 5000.0;
 constexpr double kFeeRateTaker = 0.0005;
-
-void ensure_curl_global() {
-    static std::once_flag once;
-    std::call_once(once, []() {
-        curl_global_init(CURL_GLOBAL_DEFAULT);
-        std::atexit([]() { curl_global_cleanup(); });
-    });
-}
-
-std::string generate_nonce() {
-    std::array<unsigned char, 16> bytes{};
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dist(0, 255);
-    for (auto& b : bytes) b = static_cast<unsigned char>(dist(gen));
-    std::ostringstream oss;
-    for (size_t i = 0; i < bytes.size(); ++i) {
-        if (i == 4 || i == 6 || i == 8 || i == 10) oss << '-';
-        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(bytes[i]);
-    }
-    return oss.str();
-}
-
-std::string bytes_to_hex(const unsigned char* data, size_t len) {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < len; ++i) {
-        oss << std::setw(2) << static_cast<int>(data[i]);
-    }
-    return oss.str();
-}
-
-std::string base64_url_encode(const std::string& input) {
-    if (input.empty()) return {};
-    int encoded_len = 4 * ((static_cast<int>(input.size()) + 2) / 3);
-    std::string buffer(static_cast<size_t>(encoded_len), '\0');
-    int actual_len = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&buffer[0]),
-                                     reinterpret_cast<const unsigned char*>(input.data()),
-                                     static_cast<int>(input.size()));
-    if (actual_len <= 0) return {};
-    buffer.resize(static_cast<size_t>(actual_len));
-    for (char& c : buffer) {
-        if (c == '+') c = '-';
-        else if (c == '/') c = '_';
-    }
-    while (!buffer.empty() && buffer.back() == '=') buffer.pop_back();
-    return buffer;
-}
-
-std::string url_encode(const std::string& value) {
-    ensure_curl_global();
-    CURL* curl = curl_easy_init();
-    if (!curl) return {};
-    char* escaped = curl_easy_escape(curl, value.c_str(), static_cast<int>(value.size()));
-    std::string result;
-    if (escaped) {
-        result.assign(escaped);
-        curl_free(escaped);
-    }
-    curl_easy_cleanup(curl);
-    return result;
-}
+constexpr size_t kTickerChunk = 100;
 
 std::string format_decimal(double value, int max_decimals) {
     std::ostringstream oss;
@@ -92,13 +32,6 @@ std::string format_decimal(double value, int max_decimals) {
     return str;
 }
 
-size_t write_callback(char* ptr, size_t size, size_t nmemb, void* userdata) {
-    if (!userdata) return 0;
-    auto* out = static_cast<std::string*>(userdata);
-    out->append(ptr, size * nmemb);
-    return size * nmemb;
-}
-
 std::string extract_uuid(const std::string& body) {
     auto key_pos = body.find("\"uuid\"");
     if (key_pos == std::string::npos) return {};
@@ -111,28 +44,111 @@ std::string extract_uuid(const std::string& body) {
     return body.substr(quote + 1, end - quote - 1);
 }
 
+// "2024-01-02T03:04:05Z"
+std::string utc_time_string(long long ms) {
+    const std::time_t secs = static_cast<std::time_t>(ms / 1000);
+    std::tm tm{};
+    gmtime_r(&secs, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+// Upbit's `timestamp` is the bar's last trade; bars here carry their bucket start.
+std::vector<Candle> parse_candles(const std::string& body, long long period_ms) {
+    std::vector<Candle> out;
+    json_for_each_element(body, [&](std::string_view elem) {
+        Candle c{};
+        json_for_each_member(elem, [&](std::string_view key, std::string_view value) {
+            if (key == "timestamp") json_to_int64(value, c.ts_ms);
+            else if (key == "opening_price") json_to_double(value, c.open);
+            else if (key == "high_price") json_to_double(value, c.high);
+            else if (key == "low_price") json_to_double(value, c.low);
+            else if (key == "trade_price") json_to_double(value, c.close);
+            else if (key == "candle_acc_trade_volume") json_to_double(value, c.volume);
+            return true;
+        });
+        if (period_ms > 0) c.ts_ms = bar_open_ms(c.ts_ms, period_ms);
+        out.push_back(c);
+        return true;
+    });
+    // the API returns newest first
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
 } // namespace
 
-UpbitRestClient::UpbitRestClient(const std::string& base_url) : base_url_(base_url) {}
+UpbitRestClient::UpbitRestClient(const std::string& base_url)
+    : base_url_(base_url), pool_(std::make_unique<HttpConnectionPool>()) {}
+
+UpbitRestClient::~UpbitRestClient() = default;
+
+AsyncHttpClient& UpbitRestClient::async_client() {
+    std::call_once(async_once_, [this]() { async_ = std::make_unique<AsyncHttpClient>(*pool_, limiter_); });
+    return *async_;
+}
+
+bool UpbitRestClient::warm_up() {
+    return pool_->warm_up(base_url_ + "/v1/market/all");
+}
+
+HttpPoolStats UpbitRestClient::connection_stats() const {
+    return pool_->stats();
+}
+
+HttpResponse UpbitRestClient::perform(const HttpRequest& req) {
+    limiter_.acquire(req.group, req.lane);
+    return transfer(req);
+}
+
+HttpResponse UpbitRestClient::transfer(const HttpRequest& req) {
+    HttpResponse res = pool_->perform(req);
+    if (!res.remaining_req.empty()) limiter_.on_response(res.remaining_req);
+    if (res.status == 429) limiter_.on_rate_limited(req.group);
+    return res;
+}
+
+OrderResult UpbitRestClient::to_order_result(const HttpResponse& res) const {
+    OrderResult result{};
+    result.http_status = res.status;
+    result.raw_response = res.body;
+    if (!res.error_message.empty()) {
+        result.error_message = res.error_message;
+        return result;
+    }
+    if (res.status >= 400) {
+        if (res.status == 429) result.error_message = "HTTP 429 rate limited";
+        else result.error_message = "HTTP error " + std::to_string(result.http_status);
+        return result;
+    }
+
+    result.uuid = extract_uuid(res.body);
+    result.accepted = !result.uuid.empty();
+    return result;
+}
 
 void UpbitRestClient::set_credentials(std::string access_key, std::string secret_key) {
-    access_key_ = std::move(access_key);
-    secret_key_ = std::move(secret_key);
+    signer_.set_credentials(access_key, secret_key);
+}
+
+double UpbitRestClient::tick_size(double price) {
+    if (price >= 2'000'000.0) return 1'000.0;
+    if (price >= 1'000'000.0) return 500.0;
+    if (price >= 500'000.0) return 100.0;
+    if (price >= 100'000.0) return 50.0;
+    if (price >= 50'000.0) return 10.0;
+    if (price >= 10'000.0) return 5.0;
+    if (price >= 1'000.0) return 1.0;
+    if (price >= 100.0) return 0.1;
+    if (price >= 10.0) return 0.01;
+    if (price >= 1.0) return 0.001;
+    return 0.0001;
 }
 
 double UpbitRestClient::normalize_price(double price) {
     if (price <= 0.0) return 0.0;
-    double tick = 0.0001;
-    if (price >= 2'000'000.0) tick = 1'000.0;
-    else if (price >= 1'000'000.0) tick = 500.0;
-    else if (price >= 500'000.0) tick = 100.0;
-    else if (price >= 100'000.0) tick = 50.0;
-    else if (price >= 50'000.0) tick = 10.0;
-    else if (price >= 10'000.0) tick = 5.0;
-    else if (price >= 1'000.0) tick = 1.0;
-    else if (price >= 100.0) tick = 0.1;
-    else if (price >= 10.0) tick = 0.01;
-    else if (price >= 1.0) tick = 0.001;
+    const double tick = tick_size(price);
     const double scaled = std::floor((price / tick) + 1e-9) * tick;
     const double rounded = std::round(scaled * 100000000.0) / 100000000.0;
     return rounded;
@@ -160,81 +176,167 @@ double UpbitRestClient::normalize_volume(double price, double volume, bool is_bu
     return quantized;
 }
 
+std::string UpbitRestClient::default_base_url() {
+    const char* url = std::getenv("UPBIT_REST_URL");
+    return url && *url ? url : "https://api.upbit.com";
+}
+
+std::string UpbitRestClient::default_ws_url() {
+    const char* url = std::getenv("UPBIT_WS_URL");
+    return url && *url ? url : "wss://api.upbit.com/websocket/v1";
+}
+
 double UpbitRestClient::taker_fee_rate() {
     return kFeeRateTaker;
 }
 
 std::vector<std::string> UpbitRestClient::get_markets_krw() {
-    // TODO: replace with live REST call
-    return {"KRW-BTC", "KRW-ETH"};
+    HttpRequest http;
+    http.url = base_url_ + "/v1/market/all?isDetails=false";
+    http.group = RateGroup::Market;
+    http.headers = {"Accept: application/json"};
+    const HttpResponse res = perform(http);
+    std::vector<std::string> out;
+    if (!res.error_message.empty() || res.status >= 400) return out;
+    json_for_each_element(res.body, [&](std::string_view elem) {
+        json_for_each_member(elem, [&](std::string_view key, std::string_view value) {
+            if (key != "market") return true;
+            const std::string_view market = json_unquote(value);
+            if (market.substr(0, 4) == "KRW-") out.emplace_back(market);
+            return false;
+        });
+        return true;
+    });
+    return out;
 }
 
 std::vector<Ticker24h> UpbitRestClient::get_tickers(const std::vector<std::string>& markets) {
-    // TODO: replace with live REST call
+    std::vector<std::future<HttpResponse>> pending;
+    for (size_t i = 0; i < markets.size(); i += kTickerChunk) {
+        std::string joined;
+        for (size_t j = i; j < std::min(markets.size(), i + kTickerChunk); ++j) {
+            if (!joined.empty()) joined += ',';
+            joined += markets[j];
+        }
+        HttpRequest http;
+        http.url = base_url_ + "/v1/ticker?markets=" + url_encode(joined);
+        http.group = RateGroup::Market;
+        http.headers = {"Accept: application/json"};
+        pending.push_back(async_client().submit(std::move(http)));
+    }
+
     std::vector<Ticker24h> out;
-    for (const auto& m : markets) out.push_back({m, m == "KRW-BTC" ? 1.0 : 0.8});
+    out.reserve(markets.size());
+    for (auto& f : pending) {
+        const HttpResponse res = f.get();
+        if (!res.error_message.empty() || res.status >= 400) continue;
+        json_for_each_element(res.body, [&](std::string_view elem) {
+            Ticker24h t;
+            json_for_each_member(elem, [&](std::string_view key, std::string_view value) {
+                if (key == "market") t.market = std::string(json_unquote(value));
+                else if (key == "acc_trade_price_24h") json_to_double(value, t.acc_trade_price_24h);
+                return true;
+            });
+            if (!t.market.empty()) out.push_back(std::move(t));
+            return true;
+        });
+    }
     return out;
 }
 
 std::vector<Candle> UpbitRestClient::get_candles_minutes(const std::string& market, int unit, int count) {
-    // TODO: replace with live REST call
-    std::vector<Candle> v; v.reserve(static_cast<size_t>(count));
-    double px = market == "KRW-BTC" ? 100.0 : 50.0;
-    for (int i = 0; i < count; ++i) {
-        v.push_back({1000LL * i, px, px*1.01, px*0.99, px*(1.0 + 0.001*i), 1.0});
-    }
-    return v;
+    return get_candles_minutes_async(market, unit, count).get();
 }
 
-std::string UpbitRestClient::build_authorization_token(const std::vector<std::pair<std::string, std::string>>& params) const {
-    if (access_key_.empty() || secret_key_.empty()) return {};
-    std::vector<std::pair<std::string, std::string>> sorted(params);
-    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
-        return a.first < b.first;
+std::future<std::vector<Candle>> UpbitRestClient::get_candles_minutes_async(const std::string& market, int unit, int count,
+                                                                            long long to_ms) {
+    HttpRequest http;
+    http.url = base_url_ + "/v1/candles/minutes/" + std::to_string(unit) +
+               "?market=" + url_encode(market) + "&count=" + std::to_string(count);
+    if (to_ms > 0) http.url += "&to=" + url_encode(utc_time_string(to_ms));
+    http.group = RateGroup::Candles;
+    http.headers = {"Accept: application/json"};
+    auto promise = std::make_shared<std::promise<std::vector<Candle>>>();
+    auto future = promise->get_future();
+    const long long period_ms = static_cast<long long>(unit) * 60'000;
+    async_client().submit(std::move(http), [promise, period_ms](HttpResponse res) {
+        if (!res.error_message.empty() || res.status >= 400) promise->set_value({});
+        else promise->set_value(parse_candles(res.body, period_ms));
     });
-    std::ostringstream query_stream;
-    for (size_t i = 0; i < sorted.size(); ++i) {
-        if (i > 0) query_stream << '&';
-        query_stream << url_encode(sorted[i].first) << '=' << url_encode(sorted[i].second);
-    }
-    const std::string query = query_stream.str();
-    std::string query_hash_hex;
-    if (!query.empty()) {
-        unsigned char hash[SHA512_DIGEST_LENGTH];
-        SHA512(reinterpret_cast<const unsigned char*>(query.data()), query.size(), hash);
-        query_hash_hex = bytes_to_hex(hash, SHA512_DIGEST_LENGTH);
+    return future;
+}
+
+std::vector<std::pair<std::string, std::vector<Candle>>> UpbitRestClient::get_candles_minutes_batch(
+    const std::vector<std::string>& markets, int unit, int count) {
+    std::vector<std::future<std::vector<Candle>>> pending;
+    pending.reserve(markets.size());
+    for (const auto& m : markets) pending.push_back(get_candles_minutes_async(m, unit, count));
+
+    std::vector<std::pair<std::string, std::vector<Candle>>> out;
+    out.reserve(markets.size());
+    for (size_t i = 0; i < markets.size(); ++i) out.emplace_back(markets[i], pending[i].get());
+    return out;
+}
+
+std::string UpbitRestClient::build_authorization_token(const std::vector<std::pair<std::string, std::string>>& params) const {
+    if (!signer_.ready()) return {};
+    return signer_.sign(params);
+}
+
+OrderResult UpbitRestClient::post_order(const OrderRequest& req) {
+    const long long start = LatencyRecorder::now_ns();
+    HttpRequest http;
+    if (!build_post_order(req, http)) return OrderResult{};
+    limiter_.acquire(http.group, http.lane);
+    const long long sent = LatencyRecorder::now_ns();
+    LatencyRecorder::record(LatencyStage::OrderSend, sent - start);
+    HttpResponse res = transfer(http);
+    LatencyRecorder::record(LatencyStage::RestAck, LatencyRecorder::now_ns() - sent);
+    return to_order_result(res);
+}
+
+void UpbitRestClient::post_order_async(const OrderRequest& req, OrderCallback cb) {
+    const long long start = LatencyRecorder::now_ns();
+    HttpRequest http;
+    if (!build_post_order(req, http)) {
+        cb(OrderResult{});
+        return;
     }
+    // the async client waits for the limiter itself, so here that wait counts as ack time
+    const long long sent = LatencyRecorder::now_ns();
+    LatencyRecorder::record(LatencyStage::OrderSend, sent - start);
+    async_client().submit(std::move(http), [this, sent, cb = std::move(cb)](HttpResponse res) {
+        LatencyRecorder::record(LatencyStage::RestAck, LatencyRecorder::now_ns() - sent);
+        cb(to_order_result(res));
+    });
+}
+
+OrderResult UpbitRestClient::cancel_order(const CancelRequest& req) {
+    HttpRequest http;
+    if (!build_order_query("DELETE", req.uuid, {}, http)) return OrderResult{};
+    return to_order_result(perform(http));
+}
 
-    const std::string nonce = generate_nonce();
+void UpbitRestClient::cancel_order_async(const CancelRequest& req, OrderCallback cb) {
+    HttpRequest http;
+    if (!build_order_query("DELETE", req.uuid, {}, http)) {
+        cb(OrderResult{});
+        return;
+    }
+    async_client().submit(std::move(http), [this, cb = std::move(cb)](HttpResponse res) { cb(to_order_result(res)); });
+}
 
-    std::ostringstream payload_oss;
-    payload_oss << R"({"access_key":")" << access_key_ << R"(","nonce":")" << nonce << R"(")";
-    if (!query.empty()) {
-        payload_oss << R"(,"query_hash":")" << query_hash_hex << R"(","query_hash_alg":"SHA512")";
+void UpbitRestClient::get_order_async(const std::string& uuid, const std::string& identifier, OrderCallback cb) {
+    HttpRequest http;
+    if (!build_order_query("GET", uuid, identifier, http)) {
+        cb(OrderResult{});
+        return;
     }
-    payload_oss << '}';
-
-    const std::string header = R"({"alg":"HS256","typ":"JWT"})";
-    const std::string header_b64 = base64_url_encode(header);
-    const std::string payload_b64 = base64_url_encode(payload_oss.str());
-    if (header_b64.empty() || payload_b64.empty()) return {};
-    const std::string signing_input = header_b64 + "." + payload_b64;
-
-    unsigned char mac[EVP_MAX_MD_SIZE];
-    unsigned int mac_len = 0;
-    HMAC(EVP_sha256(),
-         reinterpret_cast<const unsigned char*>(secret_key_.data()), static_cast<int>(secret_key_.size()),
-         reinterpret_cast<const unsigned char*>(signing_input.data()), signing_input.size(),
-         mac, &mac_len);
-    std::string signature(reinterpret_cast<char*>(mac), mac_len);
-    const std::string signature_b64 = base64_url_encode(signature);
-    if (signature_b64.empty()) return {};
-    return "Bearer " + signing_input + "." + signature_b64;
+    async_client().submit(std::move(http), [this, cb = std::move(cb)](HttpResponse res) { cb(to_order_result(res)); });
 }
 
-OrderResult UpbitRestClient::post_order(const OrderRequest& req) {
-    OrderResult result{};
-    if (req.market.empty()) return result;
+bool UpbitRestClient::build_post_order(const OrderRequest& req, HttpRequest& http) const {
+    if (req.market.empty()) return false;
     const bool is_buy = req.side == "buy" || req.side == "bid";
     const std::string side = is_buy ? "bid" : "ask";
     std::string ord_type = req.ord_type.empty() ? "limit" : req.ord_type;
@@ -266,17 +368,10 @@ OrderResult UpbitRestClient::post_order(const OrderRequest& req) {
         volume_stream << format_decimal(req.volume, 8);
         params.emplace_back("volume", volume_stream.str());
     }
+    if (!req.identifier.empty()) params.emplace_back("identifier", req.identifier);
 
     const std::string auth = build_authorization_token(params);
-    if (auth.empty()) return result;
-
-    ensure_curl_global();
-    CURL* curl = curl_easy_init();
-    if (!curl) return result;
-
-    std::string url = base_url_ + "/v1/orders";
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    if (auth.empty()) return false;
 
     std::ostringstream body;
     body << '{';
@@ -285,95 +380,31 @@ OrderResult UpbitRestClient::post_order(const OrderRequest& req) {
         body << '"' << params[i].first << "\":\"" << params[i].second << '"';
     }
     body << '}';
-    const std::string body_str = body.str();
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body_str.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body_str.size()));
-
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Accept: application/json");
-    const std::string auth_header = "Authorization: " + auth;
-    headers = curl_slist_append(headers, auth_header.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    std::string response;
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-    CURLcode rc = curl_easy_perform(curl);
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    result.http_status = static_cast<int>(http_code);
-    result.raw_response = response;
-    if (rc != CURLE_OK) {
-        result.error_message = curl_easy_strerror(rc);
-        return result;
-    }
-    if (http_code >= 400) {
-        if (http_code == 429) result.error_message = "HTTP 429 rate limited";
-        else result.error_message = "HTTP error " + std::to_string(result.http_status);
-        return result;
-    }
 
-    result.uuid = extract_uuid(response);
-    result.accepted = !result.uuid.empty();
-    return result;
+    http.method = "POST";
+    http.url = base_url_ + "/v1/orders";
+    http.group = RateGroup::Order;
+    http.lane = RateLane::High;
+    http.body = body.str();
+    http.headers = {"Content-Type: application/json", "Accept: application/json", "Authorization: " + auth};
+    return true;
 }
 
-OrderResult UpbitRestClient::cancel_order(const CancelRequest& req) {
-    OrderResult result{};
-    if (req.uuid.empty()) return result;
-
+bool UpbitRestClient::build_order_query(const char* method, const std::string& uuid, const std::string& identifier,
+                                        HttpRequest& http) const {
     std::vector<std::pair<std::string, std::string>> params;
-    params.emplace_back("uuid", req.uuid);
+    if (!uuid.empty()) params.emplace_back("uuid", uuid);
+    else if (!identifier.empty()) params.emplace_back("identifier", identifier);
+    else return false;
     const std::string auth = build_authorization_token(params);
-    if (auth.empty()) return result;
-
-    ensure_curl_global();
-    CURL* curl = curl_easy_init();
-    if (!curl) return result;
-
-    std::ostringstream url_oss;
-    url_oss << base_url_ << "/v1/order?uuid=" << url_encode(req.uuid);
-    const std::string url = url_oss.str();
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Accept: application/json");
-    const std::string auth_header = "Authorization: " + auth;
-    headers = curl_slist_append(headers, auth_header.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    std::string response;
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-    CURLcode rc = curl_easy_perform(curl);
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    result.http_status = static_cast<int>(http_code);
-    result.raw_response = response;
-    if (rc != CURLE_OK) {
-        result.error_message = curl_easy_strerror(rc);
-        return result;
-    }
-    if (http_code >= 400) {
-        if (http_code == 429) result.error_message = "HTTP 429 rate limited";
-        else result.error_message = "HTTP error " + std::to_string(result.http_status);
-        return result;
-    }
-
-    result.uuid = extract_uuid(response);
-    result.accepted = !result.uuid.empty();
-    return result;
+    if (auth.empty()) return false;
+
+    http.method = method;
+    http.url = base_url_ + "/v1/order?" + params[0].first + '=' + url_encode(params[0].second);
+    // a cancel competes with orders for the order group; a status query does not
+    const bool cancel = http.method == "DELETE";
+    http.group = cancel ? RateGroup::Order : RateGroup::Default;
+    http.lane = cancel ? RateLane::High : RateLane::Low;
+    http.headers = {"Accept: application/json", "Authorization: " + auth};
+    return true;
 }
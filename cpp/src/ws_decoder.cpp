@@ -0,0 +1,112 @@
+#include "ws_decoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include "json_scan.hpp"
+
+namespace {
+
+struct WsKeys {
+    std::string_view type;
+    std::string_view code;
+    std::string_view timestamp;
+    std::string_view trade_timestamp;
+    std::string_view trade_price;
+    std::string_view trade_volume;
+    std::string_view ask_bid;
+    std::string_view sequential_id;
+    std::string_view total_ask_size;
+    std::string_view total_bid_size;
+    std::string_view units;
+    std::string_view ask_price;
+    std::string_view bid_price;
+    std::string_view ask_size;
+    std::string_view bid_size;
+};
+
+constexpr WsKeys kDefaultKeys{
+    "type", "code", "timestamp", "trade_timestamp", "trade_price", "trade_volume", "ask_bid",
+    "sequential_id", "total_ask_size", "total_bid_size", "orderbook_units",
+    "ask_price", "bid_price", "ask_size", "bid_size",
+};
+
+constexpr WsKeys kSimpleKeys{
+    "ty", "cd", "tms", "ttms", "tp", "tv", "ab",
+    "sid", "tas", "tbs", "obu",
+    "ap", "bp", "as", "bs",
+};
+
+void copy_code(std::string_view raw, char (&out)[16]) {
+    const std::string_view v = json_unquote(raw);
+    const size_t n = std::min(v.size(), sizeof(out) - 1);
+    std::memcpy(out, v.data(), n);
+    out[n] = '\0';
+}
+
+bool decode_units(std::string_view raw, const WsKeys& k, OrderbookSnapshot& book) {
+    book.depth = 0;
+    return json_for_each_element(raw, [&](std::string_view unit) {
+        if (book.depth >= OrderbookSnapshot::kMaxLevels) return false;
+        BookLevel& lvl = book.levels[book.depth++];
+        lvl = BookLevel{};
+        json_for_each_member(unit, [&](std::string_view key, std::string_view value) {
+            if (key == k.ask_price) json_to_double(value, lvl.ask_price);
+            else if (key == k.bid_price) json_to_double(value, lvl.bid_price);
+            else if (key == k.ask_size) json_to_double(value, lvl.ask_size);
+            else if (key == k.bid_size) json_to_double(value, lvl.bid_size);
+            return true;
+        });
+        return true;
+    });
+}
+
+WsMessageType decode_with(const WsKeys& k, std::string_view frame, TradeTick& trade, OrderbookSnapshot& book) {
+    WsMessageType type = WsMessageType::Unknown;
+    long long timestamp = 0;
+    bool units_ok = true;
+    const bool ok = json_for_each_member(frame, [&](std::string_view key, std::string_view value) {
+        if (key == k.type) {
+            const std::string_view t = json_unquote(value);
+            if (t == "trade") type = WsMessageType::Trade;
+            else if (t == "orderbook") type = WsMessageType::Orderbook;
+        } else if (key == k.code) {
+            copy_code(value, trade.code);
+            copy_code(value, book.code);
+        } else if (key == k.trade_price) {
+            json_to_double(value, trade.price);
+        } else if (key == k.trade_volume) {
+            json_to_double(value, trade.volume);
+        } else if (key == k.trade_timestamp) {
+            json_to_int64(value, trade.ts_ms);
+        } else if (key == k.timestamp) {
+            json_to_int64(value, timestamp);
+        } else if (key == k.ask_bid) {
+            trade.is_bid = json_unquote(value) == "BID";
+        } else if (key == k.sequential_id) {
+            json_to_int64(value, trade.sequential_id);
+        } else if (key == k.units) {
+            units_ok = decode_units(value, k, book);
+        } else if (key == k.total_ask_size) {
+            json_to_double(value, book.total_ask_size);
+        } else if (key == k.total_bid_size) {
+            json_to_double(value, book.total_bid_size);
+        }
+        return true;
+    });
+    if (!ok || !units_ok) return WsMessageType::Invalid;
+    if (type == WsMessageType::Orderbook) book.ts_ms = timestamp;
+    else if (type == WsMessageType::Trade && trade.ts_ms <= 0) trade.ts_ms = timestamp;
+    return type;
+}
+
+} // namespace
+
+WsMessageType WsFrameDecoder::decode(std::string_view frame, TradeTick& trade, OrderbookSnapshot& book,
+                                     WsFormat format) {
+    trade = TradeTick{};
+    book.code[0] = '\0';
+    book.ts_ms = 0;
+    book.total_ask_size = 0.0;
+    book.total_bid_size = 0.0;
+    book.depth = 0;
+    return decode_with(format == WsFormat::Simple ? kSimpleKeys : kDefaultKeys, frame, trade, book);
+}
@@ -0,0 +1,112 @@
+// CandlePyramid's merged() and collect() against merging the bars one by one,
+// through a random mix of appends, rewrites and drops at both ends.
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include "candle_pyramid.hpp"
+#include "checks.hpp"
+
+namespace {
+
+// Volumes are whole numbers, so every sum is exact.
+Candle make_bar(std::mt19937_64& rng, long long ts_ms, double& px) {
+    std::normal_distribution<double> step(0.0, 0.001);
+    Candle c{};
+    c.ts_ms = ts_ms;
+    c.open = px;
+    px *= std::exp(step(rng));
+    c.close = px;
+    c.high = std::max(c.open, c.close) * (1.0 + std::abs(step(rng)));
+    c.low = std::min(c.open, c.close) * (1.0 - std::abs(step(rng)));
+    c.volume = static_cast<double>(1 + rng() % 5);
+    return c;
+}
+
+Candle brute_merge(const std::deque<Candle>& bars, size_t first, size_t last) {
+    Candle out = bars[first];
+    for (size_t i = first + 1; i < last; ++i) {
+        out.high = std::max(out.high, bars[i].high);
+        out.low = std::min(out.low, bars[i].low);
+        out.close = bars[i].close;
+        out.volume += bars[i].volume;
+    }
+    return out;
+}
+
+bool same_bar(const Candle& a, const Candle& b) {
+    return a.ts_ms == b.ts_ms && a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close &&
+           a.volume == b.volume;
+}
+
+std::string compare_ranges(const CandlePyramid& pyramid, const std::deque<Candle>& bars, std::mt19937_64& rng,
+                           std::vector<CandleBucket>& buckets) {
+    if (pyramid.size() != bars.size()) return "size";
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (!same_bar(pyramid[i], bars[i])) return "bar " + std::to_string(i);
+    }
+    for (int k = 0; k < 20; ++k) {
+        const size_t first = rng() % bars.size();
+        const size_t last = first + 1 + rng() % (bars.size() - first);
+        const std::string range = " [" + std::to_string(first) + ", " + std::to_string(last) + ")";
+        if (!same_bar(pyramid.merged(first, last), brute_merge(bars, first, last))) return "merged" + range;
+
+        const size_t level = rng() % (pyramid.levels() + 1);
+        pyramid.collect(level, first, last, buckets);
+        size_t pos = first;
+        for (const CandleBucket& b : buckets) {
+            if (b.first != pos || b.count == 0) return "collect level " + std::to_string(level) + range + ": gap";
+            if (!same_bar(b.bar, brute_merge(bars, b.first, b.first + b.count))) {
+                return "collect level " + std::to_string(level) + range + ": bucket at " + std::to_string(b.first);
+            }
+            pos += b.count;
+        }
+        if (pos != last) return "collect level " + std::to_string(level) + range + ": short";
+    }
+    return {};
+}
+
+} // namespace
+
+std::string check_candle_pyramid() {
+    std::mt19937_64 rng(23);
+    double px = 51'000'000.0;
+    long long ts = 1'700'000'000'000LL;
+    std::deque<Candle> bars;
+    for (int i = 0; i < 3000; ++i, ts += 60'000) bars.push_back(make_bar(rng, ts, px));
+    CandlePyramid pyramid;
+    pyramid.assign(std::vector<Candle>(bars.begin(), bars.end()));
+
+    std::vector<CandleBucket> buckets;
+    for (int step = 0; step < 2000; ++step) {
+        const unsigned op = rng() % 8;
+        if (op < 4) {
+            bars.push_back(make_bar(rng, ts, px));
+            ts += 60'000;
+            pyramid.push_back(bars.back());
+        } else if (op < 6) {
+            Candle c = bars.back();
+            c.close = c.open * (1.0 + 0.002 * (static_cast<double>(rng() % 11) - 5.0));
+            c.high = std::max(c.open, c.close);
+            c.low = std::min(c.open, c.close);
+            bars.back() = c;
+            pyramid.set_back(c);
+        } else if (op == 6 && bars.size() > 100) {
+            const size_t n = 1 + rng() % 40;
+            bars.erase(bars.begin(), bars.begin() + static_cast<std::ptrdiff_t>(n));
+            pyramid.pop_front(n);
+        } else if (bars.size() > 100) {
+            const size_t n = 1 + rng() % 7;
+            bars.resize(bars.size() - n);
+            ts -= static_cast<long long>(n) * 60'000;
+            pyramid.pop_back(n);
+        }
+        if (step % 50 == 0 || step == 1999) {
+            const std::string mismatch = compare_ranges(pyramid, bars, rng, buckets);
+            if (!mismatch.empty()) return "step " + std::to_string(step) + ": " + mismatch;
+        }
+    }
+    return {};
+}
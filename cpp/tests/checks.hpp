@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+// Equivalence checks run by upbit_tests: each fast path against a brute-force
+// or batch reference. Each returns an empty string when everything matched,
+// else what did not.
+std::string check_indicators();
+std::string check_simd_kernels();
+std::string check_order_tracker();
+std::string check_candle_pyramid();
+std::string check_timeframe_bars();
+std::string check_market_ranker();
@@ -0,0 +1,144 @@
+// Streaming indicators and the tick-by-tick scalper against their batch
+// formulas over a synthetic tape.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "checks.hpp"
+#include "indicators.hpp"
+#include "strategy_5m_scalper.hpp"
+
+namespace {
+
+struct Tape {
+    std::vector<Candle> bars;                // closed 5m bars
+    std::vector<std::vector<double>> ticks;  // trade prices inside each bar
+};
+
+Tape make_tape(size_t bars, size_t ticks_per_bar, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.002);
+    Tape t;
+    double px = 50'000'000.0;
+    for (size_t i = 0; i < bars; ++i) {
+        Candle c{};
+        c.ts_ms = static_cast<long long>(i) * 300'000;
+        c.open = c.high = c.low = px;
+        std::vector<double> prices;
+        for (size_t k = 0; k < ticks_per_bar; ++k) {
+            px *= std::exp(step(rng));
+            prices.push_back(px);
+            c.high = std::max(c.high, px);
+            c.low = std::min(c.low, px);
+            c.volume += 0.01;
+        }
+        c.close = px;
+        t.bars.push_back(c);
+        t.ticks.push_back(std::move(prices));
+    }
+    return t;
+}
+
+bool close_enough(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max({1.0, std::abs(a), std::abs(b)});
+}
+
+// Returns an empty string when every streaming value matched the batch one.
+std::string compare(const Tape& tape) {
+    constexpr size_t kN = 14;
+    RollingAtr atr(kN);
+    WilderAtr wilder(kN);
+    RollingMax hi(5);
+    RollingMin lo(5);
+    Ema ema(kN);
+    Vwap vwap;
+    RealizedVol rv(kN);
+    ScalperStream stream;
+    Strategy5mScalper batch;
+
+    std::vector<Candle> seen;
+    std::vector<double> closes;
+    std::vector<std::pair<double, double>> pv;
+    for (size_t i = 0; i < tape.bars.size(); ++i) {
+        // tick by tick through the forming bar, comparing scalper decisions
+        Candle forming{};
+        forming.ts_ms = tape.bars[i].ts_ms;
+        forming.open = forming.high = forming.low = tape.bars[i].open;
+        for (double p : tape.ticks[i]) {
+            forming.close = p;
+            forming.high = std::max(forming.high, p);
+            forming.low = std::min(forming.low, p);
+            seen.push_back(forming);
+            const TradeDecision a = stream.on_tick(forming);
+            const TradeDecision b = batch.evaluate(seen);
+            seen.pop_back();
+            if (a.enter_long != b.enter_long || a.limit_price != b.limit_price) return "scalper decision at bar " + std::to_string(i);
+        }
+
+        const Candle& bar = tape.bars[i];
+        stream.on_bar_close(bar);
+        seen.push_back(bar);
+        closes.push_back(bar.close);
+        pv.emplace_back(bar.close, bar.volume);
+        atr.on_bar(bar);
+        wilder.on_bar(bar);
+        hi.push(bar.high);
+        lo.push(bar.low);
+        ema.push(bar.close);
+        vwap.push(bar.close, bar.volume);
+        rv.push(bar.close);
+
+        if (atr.ready() && !close_enough(atr.value(), batch_sma_atr(seen, kN))) return "sma atr at bar " + std::to_string(i);
+        if (wilder.ready() && !close_enough(wilder.value(), batch_wilder_atr(seen, kN))) return "wilder atr at bar " + std::to_string(i);
+        const size_t from = seen.size() >= 5 ? seen.size() - 5 : 0;
+        if (hi.value() != batch_highest_high(seen, from, seen.size())) return "rolling max at bar " + std::to_string(i);
+        double low = seen[from].low;
+        for (size_t k = from; k < seen.size(); ++k) low = std::min(low, seen[k].low);
+        if (lo.value() != low) return "rolling min at bar " + std::to_string(i);
+        if (!close_enough(ema.value(), batch_ema(closes, kN))) return "ema at bar " + std::to_string(i);
+        if (!close_enough(vwap.value(), batch_vwap(pv))) return "vwap at bar " + std::to_string(i);
+        if (rv.ready() && !close_enough(rv.value(), batch_realized_vol(seen, kN))) return "realized vol at bar " + std::to_string(i);
+    }
+    return {};
+}
+
+// Streaming vs batch scalper decisions under non-default parameters.
+std::string compare_scalper(const Tape& tape, const ScalperParams& params) {
+    ScalperStream stream(params);
+    Strategy5mScalper batch(params);
+    std::vector<Candle> seen;
+    for (size_t i = 0; i < tape.bars.size(); ++i) {
+        Candle forming{};
+        forming.ts_ms = tape.bars[i].ts_ms;
+        forming.open = forming.high = forming.low = tape.bars[i].open;
+        for (double p : tape.ticks[i]) {
+            forming.close = p;
+            forming.high = std::max(forming.high, p);
+            forming.low = std::min(forming.low, p);
+            seen.push_back(forming);
+            const TradeDecision a = stream.on_tick(forming);
+            const TradeDecision b = batch.evaluate(seen);
+            seen.pop_back();
+            if (a.enter_long != b.enter_long || a.limit_price != b.limit_price) {
+                return "scalper(atr " + std::to_string(params.atr_period) + ", breakout " +
+                       std::to_string(params.breakout_bars) + ") decision at bar " + std::to_string(i);
+            }
+        }
+        stream.on_bar_close(tape.bars[i]);
+        seen.push_back(tape.bars[i]);
+    }
+    return {};
+}
+
+} // namespace
+
+std::string check_indicators() {
+    const Tape tape = make_tape(600, 8, 7);
+    std::string mismatch = compare(tape);
+    const ScalperParams variants[] = {{2, 1, 0}, {7, 3, 8}, {20, 12, 4}};
+    for (const ScalperParams& p : variants) {
+        if (mismatch.empty()) mismatch = compare_scalper(tape, p);
+    }
+    return mismatch.empty() ? mismatch : "streaming != batch: " + mismatch;
+}
@@ -0,0 +1,112 @@
+// MarketRanker's rolling realised volatility and ranking against recomputing
+// them from the whole history of minute closes, fed trade by trade and seeded
+// from 1m bars.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "checks.hpp"
+#include "market_selector.hpp"
+#include "timeframe_bars.hpp"
+
+namespace {
+
+constexpr size_t kMarkets = 40;
+constexpr size_t kWindow = 30;
+
+struct History {
+    std::string code;
+    double turnover{0.0};
+    std::vector<Candle> bars; // 1m, last one forming
+};
+
+bool close_enough(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max({1e-12, std::abs(a), std::abs(b)});
+}
+
+// RMS of the log returns between the last kWindow + 1 closed minutes.
+double brute_rv(const std::vector<Candle>& bars) {
+    if (bars.size() < 3) return 0.0;
+    const size_t closed = bars.size() - 1;
+    const size_t from = closed > kWindow + 1 ? closed - kWindow - 1 : 0;
+    double sum = 0.0;
+    for (size_t i = from + 1; i < closed; ++i) {
+        const double r = std::log(bars[i].close / bars[i - 1].close);
+        sum += r * r;
+    }
+    return std::sqrt(sum / static_cast<double>(closed - from - 1));
+}
+
+std::vector<RankedMarket> brute_top(const std::vector<History>& markets, size_t n) {
+    std::vector<RankedMarket> all;
+    for (const History& h : markets) {
+        if (h.bars.size() < 3) continue;
+        MarketStats s;
+        s.realized_vol = brute_rv(h.bars);
+        s.turnover_24h = h.turnover;
+        all.push_back(RankedMarket{h.code, volatility_turnover_score(s)});
+    }
+    std::stable_sort(all.begin(), all.end(), [](const RankedMarket& a, const RankedMarket& b) { return a.score > b.score; });
+    all.resize(std::min(n, all.size()));
+    return all;
+}
+
+std::string compare(const MarketRanker& ranker, const std::vector<History>& markets, const std::string& what) {
+    for (const History& h : markets) {
+        const MarketStats* s = ranker.stats(h.code);
+        if (!s) return what + ": " + h.code + " missing";
+        if (!close_enough(s->realized_vol, brute_rv(h.bars))) return what + ": " + h.code + " realized vol";
+    }
+    const std::vector<RankedMarket> got = ranker.top(10);
+    const std::vector<RankedMarket> want = brute_top(markets, 10);
+    if (got.size() != want.size()) return what + ": top size";
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (!close_enough(got[i].score, want[i].score)) return what + ": score of rank " + std::to_string(i);
+    }
+    return {};
+}
+
+} // namespace
+
+std::string check_market_ranker() {
+    std::mt19937_64 rng(31);
+    std::vector<History> markets(kMarkets);
+    for (size_t i = 0; i < kMarkets; ++i) {
+        markets[i].code = "KRW-M" + std::to_string(i);
+        markets[i].turnover = 1e8 * static_cast<double>(1 + rng() % 1000);
+    }
+    std::vector<double> px(kMarkets, 1000.0);
+    MarketRanker ranker(kWindow);
+    for (const History& h : markets) ranker.set_turnover(h.code, h.turnover);
+
+    // some markets trade every minute, some skip minutes
+    const long long start = 1'700'000'020'000LL;
+    for (long long m = 0; m < 90; ++m) {
+        for (size_t i = 0; i < kMarkets; ++i) {
+            const double vol = 0.0005 * static_cast<double>(1 + i % 7);
+            std::normal_distribution<double> step(0.0, vol);
+            const size_t trades = rng() % (1 + i % 4);
+            for (size_t k = 0; k < trades; ++k) {
+                const long long ts = start + m * 60'000 + static_cast<long long>(k) * 7'000;
+                px[i] *= std::exp(step(rng));
+                ranker.on_trade(markets[i].code, ts, px[i]);
+                std::vector<Candle>& bars = markets[i].bars;
+                const long long open = bar_open_ms(ts, Timeframe::M1);
+                if (bars.empty() || bars.back().ts_ms != open) bars.push_back(Candle{open, px[i], px[i], px[i], px[i], 0.0});
+                bars.back().close = px[i];
+            }
+        }
+        if (m % 10 == 9) {
+            const std::string mismatch = compare(ranker, markets, "streamed minute " + std::to_string(m));
+            if (!mismatch.empty()) return mismatch;
+        }
+    }
+
+    MarketRanker seeded(kWindow);
+    for (const History& h : markets) {
+        seeded.set_turnover(h.code, h.turnover);
+        seeded.seed(h.code, h.bars);
+    }
+    return compare(seeded, markets, "seeded");
+}
@@ -0,0 +1,170 @@
+// OrderTracker's state transitions and fill accounting, including reports
+// that arrive before the post's response, replays, and orders placed
+// elsewhere.
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "checks.hpp"
+#include "order_tracker.hpp"
+
+namespace {
+
+OrderRequest limit_bid(double price, double volume) {
+    OrderRequest req;
+    req.market = "KRW-BTC";
+    req.side = "bid";
+    req.ord_type = "limit";
+    req.price = price;
+    req.volume = volume;
+    return req;
+}
+
+OrderResult accepted(const std::string& uuid) {
+    OrderResult res;
+    res.accepted = true;
+    res.uuid = uuid;
+    res.http_status = 201;
+    return res;
+}
+
+OrderEvent trade(const std::string& uuid, double executed, double remaining, double price, double volume) {
+    OrderEvent e;
+    e.uuid = uuid;
+    e.market = "KRW-BTC";
+    e.state = remaining == 0.0 ? "done" : "trade";
+    e.is_buy = true;
+    e.executed_volume = executed;
+    e.remaining_volume = remaining;
+    e.trade_price = price;
+    e.trade_volume = volume;
+    return e;
+}
+
+bool near(double a, double b) {
+    return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+}
+
+std::string lifecycle() {
+    OrderTracker tracker("t");
+    std::vector<OrderUpdate> updates;
+    OrderRequest req = limit_bid(100.0, 1.0);
+    const TrackedOrder& o = tracker.submit(req, 1);
+    if (req.identifier.empty() || o.state != OrderState::PendingNew || tracker.pending_acks() != 1) return "submit";
+
+    tracker.on_post_result(req.identifier, accepted("u1"), 2, updates);
+    if (o.state != OrderState::Open || updates.size() != 1 || !updates[0].state_changed) return "ack";
+    if (tracker.pending_acks() != 0 || tracker.find_by_uuid("u1") != &o) return "ack linking";
+
+    updates.clear();
+    tracker.on_event(trade("u1", 0.4, 0.6, 100.0, 0.4), 3, updates);
+    if (o.state != OrderState::PartiallyFilled || updates.size() != 1 || !near(updates[0].fill_volume, 0.4)) {
+        return "partial fill";
+    }
+    updates.clear();
+    tracker.on_event(trade("u1", 0.4, 0.6, 100.0, 0.4), 4, updates);
+    if (!updates.empty() || !near(o.filled_volume, 0.4) || o.fills != 1) return "replayed fill counted";
+
+    tracker.on_event(trade("u1", 1.0, 0.0, 101.0, 0.6), 5, updates);
+    if (o.state != OrderState::Done || !near(o.filled_volume, 1.0) || !near(o.avg_fill_price(), 100.6)) return "final fill";
+    updates.clear();
+    OrderEvent cancel;
+    cancel.uuid = "u1";
+    cancel.state = "cancel";
+    tracker.on_event(cancel, 6, updates);
+    if (o.state != OrderState::Done || !updates.empty()) return "done order reopened";
+    if (!tracker.live_orders().empty()) return "done order still live";
+    if (tracker.forget_closed(7) != 1 || tracker.size() != 0) return "forget_closed";
+    return {};
+}
+
+std::string early_reports() {
+    OrderTracker tracker("t");
+    std::vector<OrderUpdate> updates;
+
+    // a fill naming our identifier before the post's response
+    OrderRequest a = limit_bid(100.0, 1.0);
+    const TrackedOrder& oa = tracker.submit(a, 1);
+    OrderEvent e = trade("ua", 0.5, 0.5, 100.0, 0.5);
+    e.identifier = a.identifier;
+    tracker.on_event(e, 2, updates);
+    if (oa.uuid != "ua" || oa.state != OrderState::PartiallyFilled) return "fill before ack";
+    tracker.on_post_result(a.identifier, accepted("ua"), 3, updates);
+    if (oa.state != OrderState::PartiallyFilled || oa.fills != 1) return "ack after fill";
+
+    // one with only a uuid waits for the ack that names it
+    updates.clear();
+    OrderRequest b = limit_bid(100.0, 1.0);
+    const TrackedOrder& ob = tracker.submit(b, 4);
+    tracker.on_event(trade("ub", 1.0, 0.0, 99.0, 1.0), 5, updates);
+    if (!updates.empty() || ob.filled_volume != 0.0) return "orphan applied early";
+    tracker.on_post_result(b.identifier, accepted("ub"), 6, updates);
+    if (ob.state != OrderState::Done || !near(ob.filled_volume, 1.0)) return "orphan not released";
+
+    // a socket fill ahead of the REST ack, whose body reports the same fill
+    // cumulatively: counted once
+    updates.clear();
+    OrderRequest c = limit_bid(100.0, 2.0);
+    const TrackedOrder& oc = tracker.submit(c, 7);
+    tracker.on_event(trade("uc", 0.5, 1.5, 97.0, 0.5), 8, updates);
+    OrderResult ack = accepted("uc");
+    ack.raw_response = R"({"uuid":"uc","side":"bid","ord_type":"limit","state":"wait","market":"KRW-BTC",)"
+                       R"("executed_volume":"0.5","remaining_volume":"1.5"})";
+    tracker.on_post_result(c.identifier, ack, 9, updates);
+    if (oc.state != OrderState::PartiallyFilled || !near(oc.filled_volume, 0.5) || oc.fills != 1 ||
+        !near(oc.avg_fill_price(), 97.0)) {
+        return "socket fill before ack";
+    }
+
+    // with no ack outstanding, an unknown uuid was placed elsewhere
+    updates.clear();
+    tracker.on_event(trade("foreign", 0.2, 0.8, 98.0, 0.2), 10, updates);
+    if (updates.size() != 1 || updates[0].order || !near(updates[0].fill_volume, 0.2)) return "foreign order";
+    return {};
+}
+
+std::string failures() {
+    OrderTracker tracker("t");
+    std::vector<OrderUpdate> updates;
+
+    OrderRequest a = limit_bid(100.0, 1.0);
+    const TrackedOrder& oa = tracker.submit(a, 1);
+    OrderResult refused;
+    refused.http_status = 400;
+    refused.error_message = "insufficient_funds";
+    tracker.on_post_result(a.identifier, refused, 2, updates);
+    if (oa.state != OrderState::Rejected || oa.reject_reason != "insufficient_funds") return "refused post";
+
+    // no response: the order may exist, so it stays pending
+    OrderRequest b = limit_bid(100.0, 1.0);
+    const TrackedOrder& ob = tracker.submit(b, 3);
+    OrderResult lost;
+    lost.error_message = "timeout";
+    tracker.on_post_result(b.identifier, lost, 4, updates);
+    if (ob.state != OrderState::PendingNew) return "transport failure closed the order";
+    // a retry under the same identifier waits for its own ack
+    tracker.submit(b, 5);
+    if (tracker.pending_acks() != 1) return "retry ack";
+    tracker.on_post_result(b.identifier, accepted("ub"), 6, updates);
+    if (ob.state != OrderState::Open) return "retried post";
+
+    updates.clear();
+    tracker.on_cancel_result("ub", accepted("ub"), 7, updates);
+    if (ob.state != OrderState::Cancelled || updates.size() != 1) return "cancel";
+
+    OrderRequest c = limit_bid(100.0, 1.0);
+    const TrackedOrder& oc = tracker.submit(c, 8);
+    tracker.on_not_sent(c.identifier, "queue full", 9, updates);
+    if (oc.state != OrderState::Rejected) return "not sent";
+    return {};
+}
+
+} // namespace
+
+std::string check_order_tracker() {
+    for (auto run : {lifecycle, early_reports, failures}) {
+        const std::string mismatch = run();
+        if (!mismatch.empty()) return mismatch;
+    }
+    return {};
+}
@@ -0,0 +1,141 @@
+// Every vector kernel against the scalar one, and the scalar kernels against
+// the batch indicator formulas over the row layout. ISAs the CPU lacks are
+// skipped.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "candle_columns.hpp"
+#include "checks.hpp"
+#include "indicators.hpp"
+#include "simd_kernels.hpp"
+
+namespace {
+
+std::vector<std::vector<Candle>> make_markets(size_t markets, size_t bars, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.003);
+    std::uniform_real_distribution<double> wick(0.0, 0.002);
+    std::bernoulli_distribution jump(0.002);
+    std::vector<std::vector<Candle>> out(markets);
+    for (auto& series : out) {
+        double px = 100.0 + 1e6 * std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        series.reserve(bars);
+        for (size_t i = 0; i < bars; ++i) {
+            Candle c{};
+            c.ts_ms = static_cast<long long>(i) * 60'000;
+            c.open = px;
+            px *= std::exp(step(rng));
+            if (jump(rng)) px *= 0.5 + std::uniform_real_distribution<double>(0.0, 1.5)(rng);
+            c.close = px;
+            c.high = std::max(c.open, c.close) * (1.0 + wick(rng));
+            c.low = std::min(c.open, c.close) * (1.0 - wick(rng));
+            c.volume = 1.0 + wick(rng);
+            series.push_back(c);
+        }
+    }
+    return out;
+}
+
+std::vector<CandleColumns> to_columns(const std::vector<std::vector<Candle>>& markets) {
+    std::vector<CandleColumns> out(markets.size());
+    for (size_t i = 0; i < markets.size(); ++i) out[i].assign(markets[i]);
+    return out;
+}
+
+bool close_enough(double a, double b) {
+    return std::abs(a - b) <= 1e-12 * std::max({1.0, std::abs(a), std::abs(b)});
+}
+
+bool same_values(const std::vector<double>& a, const std::vector<double>& b, bool exact) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (exact ? a[i] != b[i] : !close_enough(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+struct KernelResults {
+    std::vector<double> log_returns, true_ranges, rolling_max, rolling_min;
+    double sum_sq_lr{}, sum_tr{}, sum_sq{}, max{}, min{};
+    double atr{}, highest{}, rv{};
+};
+
+KernelResults run_kernels(const CandleColumns& c) {
+    const size_t n = c.size();
+    KernelResults r;
+    r.log_returns.resize(n - 1);
+    r.true_ranges.resize(n - 1);
+    r.rolling_max.resize(n - 4);
+    r.rolling_min.resize(n - 4);
+    simd_log_returns(c.close.data(), n, r.log_returns.data());
+    simd_true_ranges(c.high.data(), c.low.data(), c.close.data(), n, r.true_ranges.data());
+    simd_rolling_max(c.high.data(), n, 5, r.rolling_max.data());
+    simd_rolling_min(c.low.data(), n, 5, r.rolling_min.data());
+    r.sum_sq_lr = simd_sum_sq_log_returns(c.close.data(), n);
+    r.sum_tr = simd_sum_true_ranges(c.high.data(), c.low.data(), c.close.data(), n);
+    r.sum_sq = simd_sum_sq(r.log_returns.data(), r.log_returns.size());
+    r.max = simd_max(c.high.data(), n);
+    r.min = simd_min(c.low.data(), n);
+    r.atr = columns_sma_atr(c, 14);
+    r.highest = columns_highest_high(c, n - 6, n - 1);
+    r.rv = columns_realized_vol(c, 60);
+    return r;
+}
+
+// Returns an empty string when every ISA matched the scalar kernels and the
+// batch formulas over the row layout.
+std::string compare_isas() {
+    // odd length so every kernel has a scalar tail
+    const auto markets = make_markets(20, 1001, 3);
+    const auto columns = to_columns(markets);
+    for (size_t m = 0; m < markets.size(); ++m) {
+        const CandleColumns& c = columns[m];
+        simd_set_isa(SimdIsa::Scalar);
+        const KernelResults ref = run_kernels(c);
+        if (ref.atr != batch_sma_atr(markets[m], 14)) return "scalar atr vs batch_sma_atr";
+        if (ref.highest != batch_highest_high(markets[m], c.size() - 6, c.size() - 1)) return "scalar highest high";
+        if (!close_enough(ref.rv, batch_realized_vol(markets[m], 60))) return "scalar realized vol";
+
+        for (SimdIsa isa : {SimdIsa::Sse2, SimdIsa::Avx2}) {
+            if (simd_set_isa(isa) != isa) continue;
+            const KernelResults r = run_kernels(c);
+            const std::string tag = std::string(simd_isa_name(isa)) + " market " + std::to_string(m) + ": ";
+            if (!same_values(r.log_returns, ref.log_returns, false)) return tag + "log returns";
+            if (!same_values(r.true_ranges, ref.true_ranges, true)) return tag + "true ranges";
+            if (!same_values(r.rolling_max, ref.rolling_max, true)) return tag + "rolling max";
+            if (!same_values(r.rolling_min, ref.rolling_min, true)) return tag + "rolling min";
+            if (!close_enough(r.sum_sq_lr, ref.sum_sq_lr)) return tag + "sum of squared log returns";
+            if (!close_enough(r.sum_tr, ref.sum_tr)) return tag + "sum of true ranges";
+            if (!close_enough(r.sum_sq, ref.sum_sq)) return tag + "sum of squares";
+            if (r.max != ref.max || r.min != ref.min) return tag + "max/min";
+            if (!close_enough(r.atr, ref.atr) || r.highest != ref.highest || !close_enough(r.rv, ref.rv)) {
+                return tag + "column indicators";
+            }
+        }
+    }
+    // log returns far outside the usual tick-to-tick range
+    const std::vector<double> wild = {1.0, 1e-3, 7.5, 7.5, 1e6, 3.0, 2.9999999, 1e-6, 123.456, 0.5, 1.0};
+    std::vector<double> ref(wild.size() - 1), got(wild.size() - 1);
+    simd_set_isa(SimdIsa::Scalar);
+    simd_log_returns(wild.data(), wild.size(), ref.data());
+    for (SimdIsa isa : {SimdIsa::Sse2, SimdIsa::Avx2}) {
+        if (simd_set_isa(isa) != isa) continue;
+        simd_log_returns(wild.data(), wild.size(), got.data());
+        for (size_t i = 0; i < got.size(); ++i) {
+            if (std::abs(got[i] - ref[i]) > 1e-15 * std::max(1.0, std::abs(ref[i]))) {
+                return std::string(simd_isa_name(isa)) + " log return " + std::to_string(i);
+            }
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+std::string check_simd_kernels() {
+    const std::string mismatch = compare_isas();
+    simd_set_isa(simd_best_isa());
+    return mismatch.empty() ? mismatch : "vector != scalar: " + mismatch;
+}
@@ -0,0 +1,55 @@
+// Runs every check, or those named on the command line (ctest runs one per
+// test), and exits non-zero on any mismatch.
+//
+//   upbit_tests [CHECK...]
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "checks.hpp"
+
+namespace {
+
+struct Check {
+    const char* name;
+    std::string (*run)();
+};
+
+constexpr Check kChecks[] = {
+    {"indicators", check_indicators},
+    {"simd_kernels", check_simd_kernels},
+    {"order_tracker", check_order_tracker},
+    {"candle_pyramid", check_candle_pyramid},
+    {"timeframe_bars", check_timeframe_bars},
+    {"market_ranker", check_market_ranker},
+};
+
+bool wanted(const char* name, int argc, char** argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int ran = 0;
+    int failed = 0;
+    for (const Check& c : kChecks) {
+        if (!wanted(c.name, argc, argv)) continue;
+        ++ran;
+        const std::string mismatch = c.run();
+        if (mismatch.empty()) {
+            std::cout << "ok   " << c.name << '\n';
+        } else {
+            std::cout << "FAIL " << c.name << ": " << mismatch << '\n';
+            ++failed;
+        }
+    }
+    if (ran == 0) {
+        std::cerr << "upbit_tests: no such check\n";
+        return 2;
+    }
+    return failed == 0 ? 0 : 1;
+}
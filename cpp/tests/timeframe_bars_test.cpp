@@ -0,0 +1,92 @@
+// TimeframeBars fed trade by trade against resampling its own 1m bars, and a
+// gap filled with merge() against the series that never had the gap.
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "checks.hpp"
+#include "timeframe_bars.hpp"
+
+namespace {
+
+constexpr long long kStartMs = 1'700'000'000'000LL - 1'700'000'000'000LL % 3'600'000; // on the hour
+constexpr long long kMinutes = 110; // inside the 1m capacity
+
+struct Trade {
+    long long ts_ms;
+    double price;
+};
+
+// A few trades most minutes around a random walk; some minutes have none.
+std::vector<Trade> make_trades(unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.001);
+    std::uniform_int_distribution<int> per_minute(0, 4);
+    std::vector<Trade> out;
+    double px = 51'000'000.0;
+    for (long long m = 0; m < kMinutes; ++m) {
+        const int n = m == 0 ? 1 : per_minute(rng);
+        for (int k = 0; k < n; ++k) {
+            px *= std::exp(step(rng));
+            out.push_back(Trade{kStartMs + m * 60'000 + (k + 1) * 11'000, px});
+        }
+    }
+    return out;
+}
+
+// Volumes are multiples of 0.5, so every sum is exact.
+bool same_bar(const Candle& a, const Candle& b) {
+    return a.ts_ms == b.ts_ms && a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close &&
+           a.volume == b.volume;
+}
+
+std::string compare_series(CandleSpan got, CandleSpan want, const std::string& what) {
+    if (got.size() != want.size()) {
+        return what + ": " + std::to_string(got.size()) + " bars, want " + std::to_string(want.size());
+    }
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (!same_bar(got[i], want[i])) return what + ": bar " + std::to_string(i);
+    }
+    return {};
+}
+
+const Timeframe kLonger[] = {Timeframe::M3, Timeframe::M5, Timeframe::M15, Timeframe::M60};
+
+} // namespace
+
+std::string check_timeframe_bars() {
+    const std::vector<Trade> trades = make_trades(17);
+    TimeframeBars full;
+    for (const Trade& t : trades) full.on_trade(t.ts_ms, t.price, 0.5);
+    for (Timeframe tf : kLonger) {
+        const std::vector<Candle> want = resample(full[Timeframe::M1], tf);
+        const std::string mismatch = compare_series(full[tf], want, std::string("streamed ") + timeframe_name(tf));
+        if (!mismatch.empty()) return mismatch;
+    }
+
+    // drop minutes [gap_from, gap_to) and fetch them back as closed 1m bars
+    const long long gap_from = kStartMs + 28 * 60'000;
+    const long long gap_to = kStartMs + 47 * 60'000;
+    TimeframeBars gapped;
+    for (const Trade& t : trades) {
+        if (t.ts_ms < gap_from || t.ts_ms >= gap_to) gapped.on_trade(t.ts_ms, t.price, 0.5);
+    }
+    std::vector<Candle> fetched;
+    for (const Candle& c : full[Timeframe::M1]) {
+        if (c.ts_ms >= gap_from && c.ts_ms < gap_to) fetched.push_back(c);
+    }
+    gapped.merge(Timeframe::M1, fetched);
+    for (Timeframe tf : {Timeframe::M1, Timeframe::M3, Timeframe::M5, Timeframe::M15, Timeframe::M60}) {
+        const std::string mismatch = compare_series(gapped[tf], full[tf], std::string("merged ") + timeframe_name(tf));
+        if (!mismatch.empty()) return mismatch;
+    }
+
+    // seeding from the 1m bars rebuilds the same longer frames
+    TimeframeBars seeded;
+    seeded.seed(Timeframe::M1, full[Timeframe::M1]);
+    for (Timeframe tf : kLonger) {
+        const std::string mismatch = compare_series(seeded[tf], full[tf], std::string("seeded ") + timeframe_name(tf));
+        if (!mismatch.empty()) return mismatch;
+    }
+    return {};
+}
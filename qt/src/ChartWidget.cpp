@@ -1,90 +1,310 @@
 #include "ChartWidget.hpp"
-#include <QtCharts/QCandlestickSet>
-#include <QtCharts/QValueAxis>
-#include <QtCharts/QDateTimeAxis>
-#include <QVBoxLayout>
 #include <QDateTime>
-#include <limits>
+#include <QFontMetrics>
+#include <QLineF>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPen>
+#include <QPointF>
+#include <QWheelEvent>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const QColor kBackground("#1e1e24");
+const QColor kGrid("#2e2e36");
+const QColor kText("#a0a0a8");
+const QColor kIncreasing("#5cb85c");
+const QColor kDecreasing("#d9534f");
+const QColor kBuy("#00c853");
+const QColor kSell("#ff3d00");
+const QColor kPosition("#f0ad4e");
+
+constexpr double kMarginRight = 72.0;  // price labels
+constexpr double kMarginBottom = 22.0; // time labels
+constexpr double kRightPad = 2.0;      // empty bars right of the newest
+constexpr double kMinBars = 10.0;
+constexpr double kDefaultBars = 120.0;
+constexpr double kMarkerSize = 8.0;
+
+} // namespace
 
 ChartWidget::ChartWidget(QWidget* parent) : QWidget(parent) {
-    chart_ = new QChart();
-    candles_ = new QCandlestickSeries();
-    candles_->setDecreasingColor(QColor("#d9534f"));
-    candles_->setIncreasingColor(QColor("#5cb85c"));
-
-    buys_ = new QScatterSeries();
-    buys_->setMarkerShape(QScatterSeries::MarkerShapeCircle);
-    buys_->setColor(QColor("#00c853"));
-    buys_->setMarkerSize(8.0);
-
-    sells_ = new QScatterSeries();
-    sells_->setMarkerShape(QScatterSeries::MarkerShapeRectangle);
-    sells_->setColor(QColor("#ff3d00"));
-    sells_->setMarkerSize(8.0);
-
-    chart_->addSeries(candles_);
-    chart_->addSeries(buys_);
-    chart_->addSeries(sells_);
-    chart_->legend()->hide();
-    chart_->setTheme(QChart::ChartThemeDark);
-
-    axisX_ = new QDateTimeAxis;
-    axisX_->setFormat("MM-dd HH:mm");
-    axisX_->setTitleText("Time");
-    chart_->addAxis(axisX_, Qt::AlignBottom);
-    candles_->attachAxis(axisX_);
-    buys_->attachAxis(axisX_);
-    sells_->attachAxis(axisX_);
-
-    axisY_ = new QValueAxis;
-    axisY_->setLabelFormat("%.0f");
-    axisY_->setTitleText("Price");
-    chart_->addAxis(axisY_, Qt::AlignLeft);
-    candles_->attachAxis(axisY_);
-    buys_->attachAxis(axisY_);
-    sells_->attachAxis(axisY_);
-
-    auto* view = new QChartView(chart_);
-    view->setRenderHint(QPainter::Antialiasing);
-    auto* layout = new QVBoxLayout(this);
-    layout->setContentsMargins(0,0,0,0);
-    layout->addWidget(view);
-}
-
-void ChartWidget::setCandles(const std::vector<Candle>& candles) {
-    data_ = candles;
-    candles_->clear();
-    buys_->clear();
-    sells_->clear();
-    qreal minPrice = std::numeric_limits<double>::max();
-    qreal maxPrice = std::numeric_limits<double>::lowest();
-    qint64 minTs = std::numeric_limits<qint64>::max();
-    qint64 maxTs = 0;
-    for (const auto& c : data_) {
-        auto* set = new QCandlestickSet(c.open, c.high, c.low, c.close, static_cast<qreal>(c.ts_ms));
-        candles_->append(set);
-        minPrice = std::min(minPrice, std::min(c.low, c.close));
-        maxPrice = std::max(maxPrice, std::max(c.high, c.close));
-        minTs = std::min(minTs, c.ts_ms);
-        maxTs = std::max(maxTs, c.ts_ms);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(320, 200);
+}
+
+void ChartWidget::setCandles(CandleSpan candles) {
+    bars_.assign(candles.last(kMaxBars));
+    buys_.clear();
+    sells_.clear();
+    follow_ = true;
+    viewBars_ = kDefaultBars;
+    clampView();
+    update();
+}
+
+void ChartWidget::syncCandles(CandleSpan candles) {
+    if (bars_.empty() || candles.empty()) {
+        setCandles(candles);
+        return;
     }
-    if (axisX_ && minTs < maxTs) {
-        axisX_->setRange(QDateTime::fromMSecsSinceEpoch(minTs), QDateTime::fromMSecsSinceEpoch(maxTs));
+    // find our newest bar in `candles`; everything after it is new
+    const long long shownLast = bars_.back().ts_ms;
+    size_t i = candles.size();
+    while (i > 0 && candles[i - 1].ts_ms > shownLast) --i;
+    const size_t from = bars_.lower_bound(candles.front().ts_ms);
+    const size_t overlap = bars_.size() - from;
+    bool same = overlap == i && (i == 0 || candles[i - 1].ts_ms == shownLast);
+    // closed bars never change on their own, so any difference is a gap fill
+    for (size_t k = 0; same && k + 1 < i; ++k) {
+        const Candle& a = bars_[from + k];
+        const Candle& b = candles[k];
+        same = a.ts_ms == b.ts_ms && a.open == b.open && a.high == b.high && a.low == b.low && a.close == b.close
+               && a.volume == b.volume;
     }
-    if (axisY_ && minPrice < maxPrice) {
-        axisY_->setRange(minPrice * 0.995, maxPrice * 1.005);
+    if (!same) {
+        // redo the overlap from `candles`; older history stays
+        bars_.pop_back(overlap);
+        i = 0;
+    } else if (i > 0) {
+        bars_.set_back(candles[i - 1]);
     }
+    for (; i < candles.size(); ++i) bars_.push_back(candles[i]);
+    trim();
+    clampView();
+    update();
+}
+
+void ChartWidget::updateLastBar(const Candle& c) {
+    bars_.set_back(c);
+    update();
+}
+
+void ChartWidget::appendBar(const Candle& c) {
+    bars_.push_back(c);
+    trim();
+    clampView();
+    update();
+}
+
+void ChartWidget::dropOldest(int count) {
+    if (count <= 0) return;
+    const size_t n = std::min(static_cast<size_t>(count), bars_.size());
+    bars_.pop_front(n);
+    viewFirst_ -= static_cast<double>(n);
+    if (!bars_.empty()) dropMarkersBefore(bars_.front().ts_ms);
+    clampView();
+    update();
+}
+
+void ChartWidget::trim() {
+    if (bars_.size() <= kMaxBars) return;
+    const size_t n = bars_.size() - kMaxBars;
+    bars_.pop_front(n);
+    viewFirst_ -= static_cast<double>(n);
+    dropMarkersBefore(bars_.front().ts_ms);
+}
+
+void ChartWidget::dropMarkersBefore(qint64 ts_ms) {
+    const auto older = [ts_ms](const Marker& m) { return m.ts_ms < ts_ms; };
+    buys_.erase(buys_.begin(), std::find_if_not(buys_.begin(), buys_.end(), older));
+    sells_.erase(sells_.begin(), std::find_if_not(sells_.begin(), sells_.end(), older));
+}
+
+void ChartWidget::insertMarker(std::vector<Marker>& markers, qint64 ts_ms, double price) {
+    // fills arrive in time order, so this is an append
+    const auto it = std::upper_bound(markers.begin(), markers.end(), ts_ms,
+                                     [](qint64 ts, const Marker& m) { return ts < m.ts_ms; });
+    markers.insert(it, Marker{ts_ms, price});
 }
 
 void ChartWidget::addBuyMarker(qint64 ts_ms, double price) {
-    buys_->append(ts_ms, price);
+    insertMarker(buys_, ts_ms, price);
+    update();
 }
 
 void ChartWidget::addSellMarker(qint64 ts_ms, double price) {
-    sells_->append(ts_ms, price);
+    insertMarker(sells_, ts_ms, price);
+    update();
 }
 
 void ChartWidget::setPosition(double avgPrice, double qty) {
     posAvg_ = avgPrice; posQty_ = qty;
+    update();
+}
+
+QRectF ChartWidget::plotRect() const {
+    return QRectF(0.0, 0.0, std::max(1.0, width() - kMarginRight), std::max(1.0, height() - kMarginBottom));
+}
+
+void ChartWidget::clampView() {
+    const double end = static_cast<double>(bars_.size()) + kRightPad;
+    viewBars_ = std::clamp(viewBars_, kMinBars, std::max(kMinBars, end));
+    if (follow_) viewFirst_ = end - viewBars_;
+    viewFirst_ = std::clamp(viewFirst_, std::min(0.0, end - viewBars_), end - viewBars_);
+}
+
+void ChartWidget::updateFollow() {
+    follow_ = false;
+    clampView();
+    follow_ = viewFirst_ + viewBars_ >= static_cast<double>(bars_.size()) + kRightPad - 0.5;
+}
+
+void ChartWidget::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+    QPainter p(this);
+    p.fillRect(rect(), kBackground);
+    if (bars_.empty()) return;
+
+    const QRectF plot = plotRect();
+    const double pxPerBar = plot.width() / viewBars_;
+    const auto first = static_cast<size_t>(std::max(0.0, std::floor(viewFirst_)));
+    const auto last = std::min(bars_.size(), static_cast<size_t>(std::max(0.0, std::ceil(viewFirst_ + viewBars_))));
+    if (first >= last) return;
+
+    // the coarsest level whose buckets are still about a pixel wide
+    size_t level = 0;
+    while (level + 1 < bars_.levels() && CandlePyramid::span_of(level + 1) * pxPerBar <= 1.0) ++level;
+    bars_.collect(level, first, last, visible_);
+
+    double lo = visible_.front().bar.low;
+    double hi = visible_.front().bar.high;
+    for (const CandleBucket& b : visible_) {
+        lo = std::min(lo, b.bar.low);
+        hi = std::max(hi, b.bar.high);
+    }
+    if (hi <= lo) {
+        hi += 1.0;
+        lo -= 1.0;
+    }
+    const double pad = (hi - lo) * 0.05;
+    lo -= pad;
+    hi += pad;
+
+    const auto xOf = [&](double index) { return plot.left() + (index - viewFirst_) * pxPerBar; };
+    const auto yOf = [&](double price) { return plot.bottom() - (price - lo) / (hi - lo) * plot.height(); };
+
+    // grid and labels
+    const QFontMetrics fm = fontMetrics();
+    std::vector<QLineF> grid;
+    p.setPen(kText);
+    const double priceStep = std::pow(10.0, std::floor(std::log10((hi - lo) / 5.0)));
+    const double step = (hi - lo) / priceStep > 25.0 ? priceStep * 5.0 : (hi - lo) / priceStep > 10.0 ? priceStep * 2.0 : priceStep;
+    const int decimals = std::max(0, -static_cast<int>(std::floor(std::log10(step))));
+    for (double v = std::ceil(lo / step) * step; v <= hi; v += step) {
+        const double y = yOf(v);
+        grid.emplace_back(plot.left(), y, plot.right(), y);
+        p.drawText(QPointF(plot.right() + 6.0, y + fm.ascent() / 2.0), QString::number(v, 'f', decimals));
+    }
+    const double labelBars = std::max(1.0, std::ceil(fm.horizontalAdvance("00-00 00:00") * 1.6 / pxPerBar));
+    for (double i = std::ceil(static_cast<double>(first) / labelBars) * labelBars; i < static_cast<double>(last); i += labelBars) {
+        const double x = xOf(i + 0.5);
+        grid.emplace_back(x, plot.top(), x, plot.bottom());
+        const QString label = QDateTime::fromMSecsSinceEpoch(bars_[static_cast<size_t>(i)].ts_ms).toString("MM-dd HH:mm");
+        p.drawText(QPointF(x - fm.horizontalAdvance(label) / 2.0, plot.bottom() + fm.ascent() + 4.0), label);
+    }
+    p.setPen(kGrid);
+    p.drawLines(grid.data(), static_cast<int>(grid.size()));
+
+    // candles: one batch of wicks and one of bodies per colour
+    std::vector<QLineF> wicks[2];
+    std::vector<QRectF> bodies[2];
+    wicks[0].reserve(visible_.size());
+    wicks[1].reserve(visible_.size());
+    for (const CandleBucket& b : visible_) {
+        const Candle& c = b.bar;
+        const int up = c.close >= c.open ? 1 : 0;
+        const double x0 = xOf(static_cast<double>(b.first));
+        const double w = static_cast<double>(b.count) * pxPerBar;
+        const double cx = std::floor(x0 + w / 2.0) + 0.5;
+        wicks[up].emplace_back(cx, yOf(c.high), cx, yOf(c.low));
+        if (w >= 3.0) {
+            const double top = yOf(std::max(c.open, c.close));
+            const double bottom = yOf(std::min(c.open, c.close));
+            bodies[up].emplace_back(x0 + w * 0.15, top, w * 0.7, std::max(1.0, bottom - top));
+        }
+    }
+    p.setClipRect(plot);
+    for (int up = 0; up < 2; ++up) {
+        const QColor& colour = up ? kIncreasing : kDecreasing;
+        p.setPen(QPen(colour, 1.0));
+        p.drawLines(wicks[up].data(), static_cast<int>(wicks[up].size()));
+        p.setPen(Qt::NoPen);
+        p.setBrush(colour);
+        p.drawRects(bodies[up].data(), static_cast<int>(bodies[up].size()));
+    }
+
+    if (posQty_ > 0.0 && posAvg_ > lo && posAvg_ < hi) {
+        p.setPen(QPen(kPosition, 1.0, Qt::DashLine));
+        const double y = yOf(posAvg_);
+        p.drawLine(QLineF(plot.left(), y, plot.right(), y));
+    }
+
+    // fills sit on the bar they happened in; round or square dots, one batch each
+    p.setRenderHint(QPainter::Antialiasing);
+    const qint64 fromMs = bars_[first].ts_ms;
+    const qint64 toMs = last < bars_.size() ? bars_[last].ts_ms : std::numeric_limits<qint64>::max();
+    std::vector<QPointF> dots;
+    const auto drawMarkers = [&](const std::vector<Marker>& markers, const QColor& colour, Qt::PenCapStyle cap) {
+        dots.clear();
+        auto it = std::lower_bound(markers.begin(), markers.end(), fromMs,
+                                   [](const Marker& m, qint64 ts) { return m.ts_ms < ts; });
+        for (; it != markers.end() && it->ts_ms < toMs; ++it) {
+            const size_t bar = bars_.lower_bound(it->ts_ms + 1) - 1;
+            dots.emplace_back(xOf(static_cast<double>(bar) + 0.5), yOf(it->price));
+        }
+        p.setPen(QPen(colour, kMarkerSize, Qt::SolidLine, cap));
+        p.drawPoints(dots.data(), static_cast<int>(dots.size()));
+    };
+    drawMarkers(buys_, kBuy, Qt::RoundCap);
+    drawMarkers(sells_, kSell, Qt::SquareCap);
+}
+
+void ChartWidget::wheelEvent(QWheelEvent* event) {
+    const QRectF plot = plotRect();
+    const double x = std::clamp(event->position().x() - plot.left(), 0.0, plot.width());
+    const double anchor = viewFirst_ + x / plot.width() * viewBars_;
+    viewBars_ *= std::pow(1.0015, -event->angleDelta().y());
+    follow_ = false;
+    viewBars_ = std::clamp(viewBars_, kMinBars, std::max(kMinBars, static_cast<double>(bars_.size()) + kRightPad));
+    viewFirst_ = anchor - x / plot.width() * viewBars_;
+    updateFollow();
+    update();
+    event->accept();
+}
+
+void ChartWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    dragging_ = true;
+    dragX_ = event->position().x();
+    dragFirst_ = viewFirst_;
+}
+
+void ChartWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (!dragging_) {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+    viewFirst_ = dragFirst_ - (event->position().x() - dragX_) / plotRect().width() * viewBars_;
+    updateFollow();
+    update();
+}
+
+void ChartWidget::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) dragging_ = false;
+    QWidget::mouseReleaseEvent(event);
+}
+
+void ChartWidget::mouseDoubleClickEvent(QMouseEvent* event) {
+    Q_UNUSED(event);
+    follow_ = true;
+    viewBars_ = kDefaultBars;
+    clampView();
+    update();
 }
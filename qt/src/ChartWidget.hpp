@@ -1,32 +1,73 @@
 #pragma once
 #include <QWidget>
-#include <QtCharts/QChartView>
-#include <QtCharts/QCandlestickSeries>
-#include <QtCharts/QScatterSeries>
-#include <QtCharts/QDateTimeAxis>
-#include <QtCharts/QValueAxis>
+#include <QRectF>
+#include <cstddef>
 #include <vector>
-#include "types.hpp"
-
-QT_CHARTS_USE_NAMESPACE
+#include "candle_pyramid.hpp"
+#include "candle_series.hpp"
 
+// Candle chart drawn in a single QPainter pass. A repaint takes the visible
+// range from a CandlePyramid at the level where a bucket is about a pixel
+// column wide, so it draws at most a few thousand batched wicks and bodies
+// whether the chart holds a hundred bars or a million, and every extreme in a
+// column still shows. Bars are spaced by index, not time.
+//
+// The wheel zooms around the cursor and dragging pans; a view that reaches
+// the newest bar keeps following new ones (double-click to go back to that).
 class ChartWidget : public QWidget {
     Q_OBJECT
 public:
+    // Beyond this the oldest bars are dropped.
+    static constexpr size_t kMaxBars = size_t{1} << 20;
+
     explicit ChartWidget(QWidget* parent = nullptr);
-    void setCandles(const std::vector<Candle>& candles);
+    // Replaces everything shown, trade markers included (e.g. a new market).
+    void setCandles(CandleSpan candles);
+    // Brings the chart up to `candles` touching only what changed: the shown
+    // forming bar is updated and newer bars appended; older history stays.
+    // Where `candles` disagrees with the shown bars it overlaps (e.g. a gap
+    // was filled in), that overlap is redrawn from `candles`.
+    void syncCandles(CandleSpan candles);
+    void updateLastBar(const Candle& c);
+    void appendBar(const Candle& c);
+    void dropOldest(int count = 1);
     void addBuyMarker(qint64 ts_ms, double price);
     void addSellMarker(qint64 ts_ms, double price);
     void setPosition(double avgPrice, double qty);
 
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+
 private:
-    QChart* chart_{nullptr};
-    QCandlestickSeries* candles_{nullptr};
-    QScatterSeries* buys_{nullptr};
-    QScatterSeries* sells_{nullptr};
-    QDateTimeAxis* axisX_{nullptr};
-    QValueAxis* axisY_{nullptr};
-    std::vector<Candle> data_;
+    struct Marker {
+        qint64 ts_ms;
+        double price;
+    };
+
+    void trim();
+    void dropMarkersBefore(qint64 ts_ms);
+    void clampView();
+    void updateFollow();
+    QRectF plotRect() const;
+    static void insertMarker(std::vector<Marker>& markers, qint64 ts_ms, double price);
+
+    CandlePyramid bars_;
+    std::vector<Marker> buys_;  // by time
+    std::vector<Marker> sells_; // by time
+    std::vector<CandleBucket> visible_; // paintEvent scratch
+
+    double viewFirst_{0.0};  // bar index at the plot's left edge
+    double viewBars_{120.0}; // bars across the plot
+    bool follow_{true};
+    bool dragging_{false};
+    double dragX_{0.0};
+    double dragFirst_{0.0};
+
     double posAvg_{0.0};
     double posQty_{0.0};
 };
@@ -1,4 +1,8 @@
 #include "EngineBridge.hpp"
+#include "PublicFeed.hpp"
+#include "http_pool.hpp"
+#include "upbit_rest.hpp"
+#include "ws_decoder.hpp"
 #include <QDateTime>
 #include <QFutureWatcher>
 #include <QNetworkAccessManager>
@@ -29,38 +33,61 @@ constexpr int kTopCandidates = 10;
 constexpr int kCandlesLookback5m = 120;
 constexpr int kCandlesLookback1m = 60;
 constexpr int kRealtimeEmitIntervalMs = 1'000;
+constexpr int kSnapshotPollMs = 100;
+constexpr double kShardOrderKrw = 10'000.0;
+// closed orders stay findable this long, for late duplicate reports
+constexpr qint64 kClosedOrderRetainMs = 10 * 60'000;
+constexpr qint64 kBarMs5m = 5 * 60'000;
+// wait past a bar's close before asking REST for it, so it is complete there
+constexpr qint64 kGapSettleMs = 3'000;
+constexpr size_t kUniverseSeedChunk = 20;
 
-double jsonToDouble(const QJsonValue& value) {
-    if (value.isString()) return value.toString().toDouble();
-    return value.toDouble();
+// Both honour UPBIT_REST_URL / UPBIT_WS_URL, e.g. to run against mock_upbit.
+QUrl restUrl(const QString& path) {
+    return QUrl(QString::fromStdString(UpbitRestClient::default_base_url()) + path);
 }
 
-qint64 jsonToTimestampMs(const QJsonValue& value) {
-    if (value.isString()) {
-        bool ok = false;
-        qint64 v = value.toString().toLongLong(&ok);
-        if (ok) return v;
-    }
-    return value.toVariant().toLongLong();
+QUrl wsUrl() {
+    return QUrl(QString::fromStdString(UpbitRestClient::default_ws_url()));
+}
 }
+
+template <typename Fn>
+auto EngineBridge::runInBackground(Fn fn) {
+    auto future = QtConcurrent::run(std::move(fn));
+    background_.erase(std::remove_if(background_.begin(), background_.end(),
+                                     [](const QFuture<void>& f) { return f.isFinished(); }),
+                      background_.end());
+    background_.append(QFuture<void>(future));
+    return future;
 }
 
 EngineBridge::EngineBridge(QString access, QString secret, QObject* parent)
-    : QObject(parent), access_(std::move(access)), secret_(std::move(secret)), restClient_() {
+    : QObject(parent), access_(std::move(access)), secret_(std::move(secret)), restClient_(), gateway_(restClient_) {
     net_ = new QNetworkAccessManager(this);
     connect(&timer_, &QTimer::timeout, this, &EngineBridge::onFiveMinuteTick);
 
     restClient_.set_credentials(access_.toStdString(), secret_.toStdString());
+    if (qEnvironmentVariableIntValue("UPBIT_WS_COMPACT") != 0) publicFormat_ = WsFormat::Simple;
+    const QString archiveDir = qEnvironmentVariable("UPBIT_ARCHIVE_DIR");
+    if (!archiveDir.isEmpty()) {
+        archive_ = std::make_unique<MarketArchive>(archiveDir.toStdString());
+        pipeline_.set_archive(archive_.get());
+        qCInfo(lcBridge) << "archiving market data under" << archiveDir;
+    }
 
-    wsPublic_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
-    wsPrivate_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    publicFeed_ = new PublicFeed(pipeline_);
+    publicFeed_->setFormat(publicFormat_);
+    publicFeed_->moveToThread(&netThread_);
+    connect(publicFeed_, &PublicFeed::connected, this, &EngineBridge::onPublicWsConnected);
+    connect(publicFeed_, &PublicFeed::disconnected, this, &EngineBridge::onPublicWsClosed);
+    netThread_.setObjectName(QStringLiteral("upbit-net"));
+    netThread_.start();
 
-    connect(wsPublic_, &QWebSocket::connected, this, &EngineBridge::onPublicWsConnected);
+    // the private socket carries our own order events only, so it stays on this thread
+    wsPrivate_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
     connect(wsPrivate_, &QWebSocket::connected, this, &EngineBridge::onPrivateWsConnected);
-    connect(wsPublic_, &QWebSocket::disconnected, this, &EngineBridge::onPublicWsClosed);
     connect(wsPrivate_, &QWebSocket::disconnected, this, &EngineBridge::onPrivateWsClosed);
-    connect(wsPublic_, &QWebSocket::textMessageReceived, this, &EngineBridge::onPublicTextMessage);
-    connect(wsPublic_, &QWebSocket::binaryMessageReceived, this, &EngineBridge::onPublicBinaryMessage);
     connect(wsPrivate_, &QWebSocket::textMessageReceived, this, &EngineBridge::onPrivateTextMessage);
     connect(wsPrivate_, &QWebSocket::binaryMessageReceived, this, &EngineBridge::onPrivateBinaryMessage);
 
@@ -68,30 +95,94 @@ EngineBridge::EngineBridge(QString access, QString secret, QObject* parent)
     wsReconnectTimer_.setSingleShot(false);
     connect(&wsReconnectTimer_, &QTimer::timeout, this, &EngineBridge::ensureSockets);
 
+    rateRetryTimer_.setSingleShot(true);
+    connect(&rateRetryTimer_, &QTimer::timeout, this, &EngineBridge::retryDeferred);
+
+    resumedFillTimer_.setSingleShot(true);
+    connect(&resumedFillTimer_, &QTimer::timeout, this, [this]() {
+        fillCandleGap(resumedFromMs_, resumedFromMs_ + kBarMs5m);
+    });
+
+    snapshotTimer_.setInterval(kSnapshotPollMs);
+    connect(&snapshotTimer_, &QTimer::timeout, this, &EngineBridge::pullSnapshot);
+
     heartbeatTimer_.setInterval(15'000);
     heartbeatTimer_.setSingleShot(false);
     connect(&heartbeatTimer_, &QTimer::timeout, this, [this]() {
-        if (wsPublic_ && wsPublicConnected_) wsPublic_->ping();
+        if (wsPublicConnected_) QMetaObject::invokeMethod(publicFeed_, [feed = publicFeed_]() { feed->ping(); });
         if (wsPrivate_ && wsPrivateConnected_) wsPrivate_->ping();
+        const HttpPoolStats stats = restClient_.connection_stats();
+        qCDebug(lcBridge) << "rest connections reused" << stats.connections_reused
+                          << "opened" << stats.connections_opened
+                          << "requests" << stats.requests;
+        const PipelineStats ps = pipeline_.stats();
+        const double seconds = heartbeatTimer_.interval() / 1000.0;
+        qCDebug(lcBridge) << "public ws" << (publicFormat_ == WsFormat::Simple ? "SIMPLE" : "DEFAULT")
+                          << "bytes/s" << qRound64((ps.bytes - lastPipelineBytes_) / seconds)
+                          << "frames" << ps.frames << "dropped" << ps.dropped;
+        qCDebug(lcBridge) << "pipeline queue depth" << ps.queue_depth << "high-water" << ps.queue_high_water
+                          << "decode p50/p99 us" << ps.decode.p50_us << ps.decode.p99_us
+                          << "queue p50/p99 us" << ps.queue_wait.p50_us << ps.queue_wait.p99_us
+                          << "apply p50/p99 us" << ps.apply.p50_us << ps.apply.p99_us
+                          << "end-to-end p50/p99/max us" << ps.end_to_end.p50_us << ps.end_to_end.p99_us
+                          << ps.end_to_end.max_us;
+        lastPipelineBytes_ = ps.bytes;
+        const GatewayStats gs = gateway_.stats();
+        qCDebug(lcBridge) << "order gateway sent" << gs.completed << "queued" << gs.queued
+                          << "in-flight" << gs.in_flight[static_cast<size_t>(RateGroup::Order)]
+                          << "refused" << gs.rejected_full
+                          << "replaced/aborted" << gs.replaced << gs.replace_aborted
+                          << "queue p50/p99 us" << gs.queue_wait.p50_us << gs.queue_wait.p99_us
+                          << "ack p50/p99/max us" << gs.ack.p50_us << gs.ack.p99_us << gs.ack.max_us;
+        const QString latency = QString::fromStdString(latencyReport_.dump());
+        for (const QString& line : latency.split(QLatin1Char('\n'), Qt::SkipEmptyParts)) {
+            qCInfo(lcBridge).noquote() << "latency" << line;
+        }
     });
 }
 
+EngineBridge::~EngineBridge() {
+    // background work holds raw pointers to the client, archive and shards
+    stopping_ = true;
+    for (QFuture<void>& f : background_) f.waitForFinished();
+    gateway_.stop(); // answers still in flight are posted to us, so before anything else goes
+    netThread_.quit();
+    netThread_.wait();
+    delete publicFeed_; // its thread is gone, so nothing else can touch it
+    pipeline_.stop();
+}
+
+void EngineBridge::setCompactStream(bool compact) {
+    const WsFormat format = compact ? WsFormat::Simple : WsFormat::Default;
+    if (format == publicFormat_) return;
+    publicFormat_ = format;
+    publicFeed_->setFormat(format);
+    // a new subscription replaces the old one, so the stream switches format in place
+    if (!subscribedMarket_.isEmpty()) subscribePublic(subscribedMarket_);
+}
+
 void EngineBridge::start() {
+    // pay the TCP/TLS handshake now instead of on the first order
+    runInBackground([client = &restClient_]() { client->warm_up(); });
     fetchMarkets();
     timer_.start(30'000); // 30초마다 신규 데이터 확인
     ensureSockets();
     wsReconnectTimer_.start();
     heartbeatTimer_.start();
+    snapshotTimer_.start();
 }
 
 void EngineBridge::onFiveMinuteTick() {
     if (!selectionReady_ || market_.isEmpty()) return;
-    fetchCandles5m();
+    // while the public socket is up the trade stream is authoritative; see onPublicWsConnected
+    if (!wsPublicConnected_ || c5_.empty()) fetchCandles5m();
+    evaluateShards();
 }
 
 void EngineBridge::fetchMarkets() {
     if (pending_) return;
-    QUrl url("https://api.upbit.com/v1/market/all");
+    if (deferForRateLimit(RateGroup::Market, [this]() { fetchMarkets(); })) return;
+    QUrl url = restUrl(QStringLiteral("/v1/market/all"));
     QUrlQuery query;
     query.addQueryItem("isDetails", "false");
     url.setQuery(query);
@@ -113,6 +204,7 @@ void EngineBridge::fetchNextTickerChunk() {
         emit marketChanged(market_);
         if (subscribedMarket_ != market_) {
             subscribedMarket_ = market_;
+            book_.clear();
             subscribePublic(market_);
             subscribePrivate(market_);
         }
@@ -128,24 +220,23 @@ void EngineBridge::fetchNextTickerChunk() {
         candidateQueue_.clear();
         const int limit = std::min(kTopCandidates, static_cast<int>(ordered.size()));
         for (int i = 0; i < limit; ++i) candidateQueue_.append(ordered.at(i));
-        candidateIndex_ = 0;
-        bestMarket_.clear();
-        bestScore_ = -std::numeric_limits<double>::infinity();
-        evaluateNextCandidate();
+        rankCandidates();
         return;
     }
 
+    if (deferForRateLimit(RateGroup::Market, [this]() { fetchNextTickerChunk(); })) return;
+
     QStringList chunk;
     for (int i = 0; i < kTickerBatchSize && nextTickerIndex_ < marketsKRW_.size(); ++i) {
         chunk << marketsKRW_.at(nextTickerIndex_++);
     }
 
     if (chunk.isEmpty()) {
-        evaluateNextCandidate();
+        rankCandidates();
         return;
     }
 
-    QUrl url("https://api.upbit.com/v1/ticker");
+    QUrl url = restUrl(QStringLiteral("/v1/ticker"));
     QUrlQuery query;
     query.addQueryItem("markets", chunk.join(","));
     url.setQuery(query);
@@ -159,36 +250,134 @@ void EngineBridge::fetchNextTickerChunk() {
     connect(pending_, &QNetworkReply::finished, this, &EngineBridge::onNetworkReply);
 }
 
-void EngineBridge::evaluateNextCandidate() {
-    if (pending_) return;
-    if (candidateIndex_ >= candidateQueue_.size() || candidateQueue_.isEmpty()) {
-        if (bestMarket_.isEmpty()) {
-            if (!candidateQueue_.isEmpty()) bestMarket_ = candidateQueue_.first();
-            else if (!marketsKRW_.isEmpty()) bestMarket_ = marketsKRW_.first();
-            else bestMarket_ = QStringLiteral("KRW-BTC");
-        }
-        market_ = bestMarket_;
-        selectionReady_ = true;
-        emit marketChanged(market_);
-        if (subscribedMarket_ != market_) {
-            subscribedMarket_ = market_;
-            subscribePublic(market_);
-            subscribePrivate(market_);
-        }
-        fetchCandles5m();
+void EngineBridge::rankCandidates() {
+    if (candidateQueue_.isEmpty()) {
+        finishSelection(!marketsKRW_.isEmpty() ? marketsKRW_.first() : QStringLiteral("KRW-BTC"));
         return;
     }
+    std::vector<Ticker24h> tickers;
+    tickers.reserve(static_cast<size_t>(volume24h_.size()));
+    for (auto it = volume24h_.cbegin(); it != volume24h_.cend(); ++it) {
+        tickers.push_back(Ticker24h{it.key().toStdString(), it.value()});
+    }
+    std::vector<std::string> markets;
+    markets.reserve(static_cast<size_t>(candidateQueue_.size()));
+    for (const QString& market : candidateQueue_) markets.push_back(market.toStdString());
+
+    using Batch = std::vector<std::pair<std::string, std::vector<Candle>>>;
+    auto* watcher = new QFutureWatcher<Batch>(this);
+    connect(watcher, &QFutureWatcher<Batch>::finished, this, [this, watcher, tickers]() {
+        Batch batch = watcher->result();
+        watcher->deleteLater();
+        // the same score the pipeline keeps live, over just the candidates
+        MarketRanker candidates;
+        for (const Ticker24h& t : tickers) candidates.set_turnover(t.market, t.acc_trade_price_24h);
+        for (const auto& [market, candles] : batch) candidates.seed(market, candles);
+        const std::vector<RankedMarket> top = candidates.top(1);
+        pipeline_.set_turnover(tickers);
+        pipeline_.seed_ranking(std::move(batch));
+        finishSelection(top.empty() ? candidateQueue_.first() : QString::fromStdString(top.front().market));
+        seedUniverse();
+    });
+    watcher->setFuture(runInBackground([client = &restClient_, archive = archive_.get(), markets]() {
+        return fetch_candles_cached(*client, archive, markets, 1, kCandlesLookback1m);
+    }));
+}
+
+void EngineBridge::finishSelection(const QString& market) {
+    if (market != market_) resumedFillTimer_.stop();
+    market_ = market;
+    selectionReady_ = true;
+    emit marketChanged(market_);
+    startShards();
+    if (subscribedMarket_ != market_) {
+        subscribedMarket_ = market_;
+        book_.clear();
+        subscribePublic(market_);
+        subscribePrivate(market_);
+    }
+    fetchCandles5m();
+}
+
+void EngineBridge::seedUniverse() {
+    std::vector<std::string> markets;
+    for (auto it = volume24h_.cbegin(); it != volume24h_.cend(); ++it) {
+        if (!candidateQueue_.contains(it.key())) markets.push_back(it.key().toStdString());
+    }
+    if (markets.empty()) return;
+
+    using Batch = std::vector<std::pair<std::string, std::vector<Candle>>>;
+    auto* watcher = new QFutureWatcher<Batch>(this);
+    connect(watcher, &QFutureWatcher<Batch>::finished, this, [this, watcher]() {
+        pipeline_.seed_ranking(watcher->result());
+        watcher->deleteLater();
+        universe_.clear();
+        for (auto it = volume24h_.cbegin(); it != volume24h_.cend(); ++it) universe_.push_back(it.key().toStdString());
+        qCInfo(lcBridge) << "ranking" << universe_.size() << "markets";
+        subscribePublic(market_);
+    });
+    // behind the selection's own requests on the shared limiter, in chunks so
+    // shutdown need not wait out the whole board
+    watcher->setFuture(runInBackground([this, markets]() {
+        Batch out;
+        for (size_t i = 0; i < markets.size() && !stopping_.load(); i += kUniverseSeedChunk) {
+            const size_t end = std::min(markets.size(), i + kUniverseSeedChunk);
+            const std::vector<std::string> chunk(markets.begin() + static_cast<std::ptrdiff_t>(i),
+                                                 markets.begin() + static_cast<std::ptrdiff_t>(end));
+            for (auto& seed : fetch_candles_cached(restClient_, archive_.get(), chunk, 1, kCandlesLookback1m)) {
+                out.push_back(std::move(seed));
+            }
+        }
+        return out;
+    }));
+}
 
-    const QString market = candidateQueue_.at(candidateIndex_++);
-    fetchCandles(1, kCandlesLookback1m, RequestKind::Candles1m, market);
+void EngineBridge::pullRanking() {
+    std::vector<RankedMarket> ranking;
+    if (!pipeline_.read_ranking(rankingVersion_, ranking)) return;
+    const bool reordered = ranking.size() != ranking_.size() ||
+            !std::equal(ranking.begin(), ranking.end(), ranking_.begin(),
+                        [](const RankedMarket& a, const RankedMarket& b) { return a.market == b.market; });
+    ranking_ = std::move(ranking);
+    if (!reordered || ranking_.empty()) return;
+    QStringList line;
+    for (const RankedMarket& r : ranking_) line << QStringLiteral("%1 %2").arg(QString::fromStdString(r.market)).arg(r.score, 0, 'f', 4);
+    qCInfo(lcBridge).noquote() << "top markets" << line.join(QStringLiteral(", "));
 }
 
 void EngineBridge::fetchCandles(int unit, int count, RequestKind kind, const QString& market) {
+    if (pending_ || archiveBusy_) return;
+    if (deferForRateLimit(RateGroup::Candles, [this, unit, count, kind, market]() {
+            fetchCandles(unit, count, kind, market);
+        })) {
+        return;
+    }
+    if (!archive_) {
+        sendCandlesRequest(unit, count, count, kind, market);
+        return;
+    }
+    // the count reads the candle log under the archive lock, which the
+    // pipeline's trade flush also takes, so not on this thread
+    archiveBusy_ = true;
+    auto* watcher = new QFutureWatcher<int>(this);
+    connect(watcher, &QFutureWatcher<int>::finished, this, [this, watcher, unit, count, kind, market]() {
+        const int requested = watcher->result();
+        watcher->deleteLater();
+        archiveBusy_ = false;
+        sendCandlesRequest(unit, count, requested, kind, market);
+        retryDeferred();
+    });
+    watcher->setFuture(runInBackground([archive = archive_.get(), m = market.toStdString(), unit, count]() {
+        return archive->gap_count(m, unit, count, MarketArchive::now_ms());
+    }));
+}
+
+void EngineBridge::sendCandlesRequest(int unit, int count, int requested, RequestKind kind, const QString& market) {
     if (pending_) return;
-    QUrl url(QStringLiteral("https://api.upbit.com/v1/candles/minutes/%1").arg(unit));
+    QUrl url = restUrl(QStringLiteral("/v1/candles/minutes/%1").arg(unit));
     QUrlQuery query;
     query.addQueryItem("market", market);
-    query.addQueryItem("count", QString::number(count));
+    query.addQueryItem("count", QString::number(requested));
     url.setQuery(query);
 
     QNetworkRequest req(url);
@@ -196,43 +385,163 @@ void EngineBridge::fetchCandles(int unit, int count, RequestKind kind, const QSt
     pendingKind_ = kind;
     pendingMarket_ = market;
     pendingUnit_ = unit;
+    pendingLookback_ = count;
     pending_ = net_->get(req);
     connect(pending_, &QNetworkReply::finished, this, &EngineBridge::onNetworkReply);
 }
 
+void EngineBridge::applyCandles5m(const QString& market, const std::vector<Candle>& bars) {
+    // a merge can finish after the user has moved on
+    if (bars.empty() || market != market_) return;
+    c5_.assign(bars);
+    pipeline_.set_market(market.toStdString(), c5_);
+    emit candlesUpdated(market);
+}
+
+void EngineBridge::loadArchivedCandles(const QString& market) {
+    if (!archive_) {
+        emit archivedCandlesLoaded(market, {});
+        return;
+    }
+    using Bars = std::vector<Candle>;
+    auto* watcher = new QFutureWatcher<Bars>(this);
+    connect(watcher, &QFutureWatcher<Bars>::finished, this, [this, watcher, market]() {
+        const Bars bars = watcher->result();
+        watcher->deleteLater();
+        emit archivedCandlesLoaded(market, bars);
+    });
+    // days of history: read and aligned on a worker, not here
+    watcher->setFuture(runInBackground([archive = archive_.get(), m = market.toStdString()]() {
+        Bars bars = archive->load(m, 5, 0, std::numeric_limits<long long>::max());
+        // older archives hold REST's last-trade timestamps
+        for (Candle& c : bars) c.ts_ms = bar_open_ms(c.ts_ms, kBarMs5m);
+        return bars;
+    }));
+}
+
 void EngineBridge::fetchCandles5m() {
     if (market_.isEmpty()) return;
     fetchCandles(5, kCandlesLookback5m, RequestKind::Candles5m, market_);
 }
 
-void EngineBridge::ensureSockets() {
-    if (wsPublic_ && wsPublic_->state() == QAbstractSocket::UnconnectedState) {
-        connectPublicSocket();
+void EngineBridge::startShards() {
+    if (shards_) return;
+    const int topN = qEnvironmentVariableIsSet("UPBIT_TOP_N")
+            ? std::max(1, qEnvironmentVariableIntValue("UPBIT_TOP_N"))
+            : kTopCandidates;
+    std::vector<std::string> markets{market_.toStdString()};
+    for (int i = 0; i < candidateQueue_.size() && static_cast<int>(markets.size()) < topN; ++i) {
+        if (candidateQueue_.at(i) != market_) markets.push_back(candidateQueue_.at(i).toStdString());
+    }
+    shards_ = std::make_unique<MultiMarketEngine>(markets);
+    pipeline_.set_event_sink([shards = shards_.get()](const MarketEvent& ev) {
+        if (ev.type == WsMessageType::Trade) shards->dispatch(ev.trade);
+        else if (ev.type == WsMessageType::Orderbook) shards->dispatch(ev.book);
+    });
+    // the ranking subscribes trades of the whole board; only these are kept
+    pipeline_.set_archived_markets(markets);
+    qCInfo(lcBridge) << "tracking" << markets.size() << "markets on" << shards_->shard_count() << "shards";
+
+    using Batch = std::vector<std::pair<std::string, std::vector<Candle>>>;
+    auto* watcher = new QFutureWatcher<Batch>(this);
+    connect(watcher, &QFutureWatcher<Batch>::finished, this, [this, watcher]() {
+        Batch batch = watcher->result();
+        watcher->deleteLater();
+        for (auto& [market, candles] : batch) shards_->seed_candles(market, std::move(candles));
+    });
+    watcher->setFuture(runInBackground([client = &restClient_, archive = archive_.get(), markets]() {
+        return fetch_candles_cached(*client, archive, markets, 5, kCandlesLookback5m);
+    }));
+}
+
+void EngineBridge::fillCandleGap(qint64 fromMs, qint64 toMs) {
+    const int count = static_cast<int>((toMs - fromMs) / kBarMs5m);
+    if (count <= 0 || market_.isEmpty()) return;
+    std::vector<std::string> markets = shards_ ? shards_->markets() : std::vector<std::string>{};
+    if (std::find(markets.begin(), markets.end(), market_.toStdString()) == markets.end()) {
+        markets.push_back(market_.toStdString());
     }
+
+    using Batch = std::vector<std::pair<std::string, std::vector<Candle>>>;
+    auto* watcher = new QFutureWatcher<Batch>(this);
+    connect(watcher, &QFutureWatcher<Batch>::finished, this, [this, watcher, fromMs, toMs]() {
+        Batch batch = watcher->result();
+        watcher->deleteLater();
+        size_t bars = 0;
+        for (auto& [market, candles] : batch) {
+            bars += candles.size();
+            if (market == market_.toStdString()) pipeline_.merge_candles(market, candles);
+            if (shards_) shards_->merge_candles(market, std::move(candles));
+        }
+        qCInfo(lcBridge) << "filled candle gap" << QDateTime::fromMSecsSinceEpoch(fromMs).toString("HH:mm")
+                         << "-" << QDateTime::fromMSecsSinceEpoch(toMs).toString("HH:mm")
+                         << bars << "bars over" << batch.size() << "markets";
+    });
+    watcher->setFuture(runInBackground([client = &restClient_, markets, count, fromMs, toMs]() {
+        std::vector<std::future<std::vector<Candle>>> pending;
+        pending.reserve(markets.size());
+        for (const auto& m : markets) pending.push_back(client->get_candles_minutes_async(m, 5, count, toMs));
+        Batch out;
+        out.reserve(markets.size());
+        for (size_t i = 0; i < markets.size(); ++i) {
+            std::vector<Candle> page = pending[i].get();
+            // `to`/`count` skips buckets without trades, so older bars can come back too
+            page.erase(std::remove_if(page.begin(), page.end(), [fromMs](const Candle& c) { return c.ts_ms < fromMs; }),
+                       page.end());
+            out.emplace_back(markets[i], std::move(page));
+        }
+        return out;
+    }));
+}
+
+void EngineBridge::evaluateShards() {
+    // the previous round may still be running if a shard is slow
+    if (!shards_ || evaluation_.isRunning()) return;
+    // evaluate_all blocks until every shard is done, so keep it off the GUI thread
+    evaluation_ = runInBackground([shards = shards_.get()]() {
+        shards->evaluate_all(kShardOrderKrw, [](const MarketState& state, const TradeDecision& decision) {
+            if (!decision.enter_long) return;
+            qCInfo(lcBridge) << "signal" << QString::fromStdString(state.code)
+                             << "limit" << decision.limit_price
+                             << "expected" << decision.expected_price;
+        });
+    });
+}
+
+void EngineBridge::ensureSockets() {
+    if (!wsPublicConnected_) connectPublicSocket();
     if (!access_.isEmpty() && !secret_.isEmpty() && wsPrivate_ && wsPrivate_->state() == QAbstractSocket::UnconnectedState) {
         connectPrivateSocket();
     }
 }
 
 void EngineBridge::connectPublicSocket() {
-    if (!wsPublic_) return;
-    wsPublicConnected_ = false;
-    wsPublic_->open(QUrl(QStringLiteral("wss://api.upbit.com/websocket/v1")));
+    // the feed ignores this while its socket is already connecting
+    const QUrl url = wsUrl();
+    QMetaObject::invokeMethod(publicFeed_, [feed = publicFeed_, url]() { feed->open(url); });
 }
 
 void EngineBridge::connectPrivateSocket() {
     if (!wsPrivate_) return;
     wsPrivateConnected_ = false;
-    wsPrivate_->open(QUrl(QStringLiteral("wss://api.upbit.com/websocket/v1")));
+    wsPrivate_->open(wsUrl());
 }
 
 void EngineBridge::subscribePublic(const QString& market) {
-    if (!wsPublicConnected_ || !wsPublic_ || market.isEmpty()) return;
+    if (!wsPublicConnected_ || market.isEmpty()) return;
+    const auto send = [feed = publicFeed_](const QByteArray& message) {
+        QMetaObject::invokeMethod(feed, [feed, message]() { feed->sendSubscription(message); });
+    };
+    if (shards_) {
+        send(QByteArray::fromStdString(shards_->subscription_message("ui-public", publicFormat_, universe_)));
+        return;
+    }
     QJsonArray arr;
     arr.append(QJsonObject{{"ticket", QStringLiteral("ui-public")}});
     arr.append(QJsonObject{{"type", QStringLiteral("trade")}, {"codes", QJsonArray{market}}});
     arr.append(QJsonObject{{"type", QStringLiteral("orderbook")}, {"codes", QJsonArray{market}}, {"isOnlyRealtime", true}});
-    wsPublic_->sendBinaryMessage(QJsonDocument(arr).toJson(QJsonDocument::Compact));
+    if (publicFormat_ == WsFormat::Simple) arr.append(QJsonObject{{"format", QStringLiteral("SIMPLE")}});
+    send(QJsonDocument(arr).toJson(QJsonDocument::Compact));
 }
 
 void EngineBridge::subscribePrivate(const QString& market) {
@@ -252,6 +561,21 @@ void EngineBridge::subscribePrivate(const QString& market) {
 void EngineBridge::onPublicWsConnected() {
     wsPublicConnected_ = true;
     if (!subscribedMarket_.isEmpty()) subscribePublic(subscribedMarket_);
+    if (!selectionReady_ || market_.isEmpty()) return;
+    // REST only fills what the outage missed: the buckets that closed meanwhile
+    // now, and the one the stream resumed in once it closes (the stream only
+    // saw part of it)
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 resumed = bar_open_ms(now, kBarMs5m);
+    if (gapFromMs_ <= 0 || (resumed - gapFromMs_) / kBarMs5m >= kCandlesLookback5m) {
+        resumedFillTimer_.stop(); // the full reload covers it
+        fetchCandles5m();
+    } else {
+        fillCandleGap(gapFromMs_, resumed);
+        resumedFromMs_ = resumed;
+        resumedFillTimer_.start(static_cast<int>(resumed + kBarMs5m + kGapSettleMs - now));
+    }
+    gapFromMs_ = 0;
 }
 
 void EngineBridge::onPrivateWsConnected() {
@@ -261,6 +585,8 @@ void EngineBridge::onPrivateWsConnected() {
 
 void EngineBridge::onPublicWsClosed() {
     wsPublicConnected_ = false;
+    // the forming bar is where the gap starts; kept across failed reconnects
+    if (gapFromMs_ == 0 && !c5_.empty()) gapFromMs_ = c5_.back().ts_ms;
     QTimer::singleShot(2'000, this, [this]() { ensureSockets(); });
 }
 
@@ -271,14 +597,6 @@ void EngineBridge::onPrivateWsClosed() {
     }
 }
 
-void EngineBridge::onPublicTextMessage(const QString& message) {
-    handlePublicMessage(message.toUtf8());
-}
-
-void EngineBridge::onPublicBinaryMessage(const QByteArray& message) {
-    handlePublicMessage(message);
-}
-
 void EngineBridge::onPrivateTextMessage(const QString& message) {
     handlePrivateMessage(message.toUtf8());
 }
@@ -287,23 +605,6 @@ void EngineBridge::onPrivateBinaryMessage(const QByteArray& message) {
     handlePrivateMessage(message);
 }
 
-void EngineBridge::handlePublicMessage(const QByteArray& payload) {
-    if (payload.isEmpty()) return;
-    QJsonParseError err;
-    const QJsonDocument doc = QJsonDocument::fromJson(payload, &err);
-    if (err.error != QJsonParseError::NoError) {
-        const char first = payload.at(0);
-        if (first != '{' && first != '[') return;
-        qCWarning(lcBridge) << "Failed to parse public WS payload" << err.errorString();
-        return;
-    }
-    if (!doc.isObject()) return;
-    const QJsonObject obj = doc.object();
-    const QString type = obj.value("type").toString();
-    if (type == QLatin1String("trade")) processTradeMessage(obj);
-    else if (type == QLatin1String("orderbook")) processOrderbookMessage(obj);
-}
-
 void EngineBridge::handlePrivateMessage(const QByteArray& payload) {
     if (payload.isEmpty()) return;
     QJsonParseError err;
@@ -318,127 +619,97 @@ void EngineBridge::handlePrivateMessage(const QByteArray& payload) {
     const QJsonObject obj = doc.object();
     const QString type = obj.value("type").toString();
     if (type == QLatin1String("myOrder") || type == QLatin1String("myOrders")) {
-        processMyOrderMessage(obj);
-    }
-}
-
-void EngineBridge::processTradeMessage(const QJsonObject& obj) {
-    if (c5_.empty()) return;
-    const QString code = obj.value("code").toString();
-    if (!code.isEmpty() && !market_.isEmpty() && code != market_) return;
-    const double price = jsonToDouble(obj.value("trade_price"));
-    const double volume = jsonToDouble(obj.value("trade_volume"));
-    const qint64 ts = jsonToTimestampMs(obj.value("trade_timestamp"));
-    if (price <= 0.0 || ts <= 0) return;
-
-    Candle& last = c5_.back();
-    if (ts < last.ts_ms) return;
-    const qint64 windowMs = 5LL * 60LL * 1000LL;
-    if (ts - last.ts_ms >= windowMs) {
-        Candle next{};
-        next.ts_ms = ts;
-        next.open = last.close;
-        next.close = price;
-        next.high = std::max(next.open, price);
-        next.low = std::min(next.open, price);
-        next.volume = volume;
-        c5_.push_back(next);
-        if (c5_.size() > static_cast<size_t>(kCandlesLookback5m)) {
-            c5_.erase(c5_.begin());
-        }
-    } else {
-        last.close = price;
-        last.high = std::max(last.high, price);
-        last.low = std::min(last.low, price);
-        last.volume += volume;
+        processMyOrderMessage(payload);
     }
+}
+
+void EngineBridge::pullSnapshot() {
+    pullRanking();
+    if (!pipeline_.read_snapshot(snapshotVersion_, snapshot_)) return;
+    if (market_.isEmpty() || snapshot_.market != market_.toStdString()) return;
+    book_ = snapshot_.book;
+    if (snapshot_.candles_5m.empty()) return;
+    c5_.assign(snapshot_.candles_5m);
     scheduleRealtimeEmit();
 }
 
-void EngineBridge::processOrderbookMessage(const QJsonObject& obj) {
-    const QJsonArray units = obj.value("orderbook_units").toArray();
-    if (units.isEmpty()) return;
-    const QJsonObject top = units.first().toObject();
-    bestBid_ = jsonToDouble(top.value("bid_price"));
-    bestAsk_ = jsonToDouble(top.value("ask_price"));
-}
-
-void EngineBridge::processMyOrderMessage(const QJsonObject& obj) {
-    const QString uuid = obj.value("uuid").toString();
-    const QString sideStr = obj.value("side").toString();
-    const bool isBuy = sideStr.compare(QStringLiteral("bid"), Qt::CaseInsensitive) == 0;
-    double tradePrice = jsonToDouble(obj.value("trade_price"));
-    double tradeVolume = jsonToDouble(obj.value("trade_volume"));
-    qint64 tradeTs = jsonToTimestampMs(obj.value("trade_timestamp"));
-
-    const auto handleFill = [this, isBuy, &uuid](double price, double volume, qint64 ts) {
-        if (price <= 0.0 || volume <= 0.0) return;
-        if (ts <= 0) ts = QDateTime::currentMSecsSinceEpoch();
-        emit orderExecuted(market_, ts, price, isBuy);
-        updatePosition(isBuy, price, volume, ts);
-        auto it = pendingOrders_.find(uuid);
-        if (it != pendingOrders_.end()) {
-            PendingOrder& ctx = it.value();
-            const double prevFilled = ctx.filledVolume;
-            ctx.filledVolume += volume;
-            if (ctx.filledVolume > 0.0) {
-                ctx.weightedFillPrice = ((ctx.weightedFillPrice * prevFilled) + price * volume) / ctx.filledVolume;
-            }
-            const double reference = ctx.isBuy
-                    ? (ctx.bestAskAtSubmit > 0.0 ? ctx.bestAskAtSubmit : ctx.price)
-                    : (ctx.bestBidAtSubmit > 0.0 ? ctx.bestBidAtSubmit : ctx.price);
-            if (reference > 0.0) {
-                const double slipAbs = ctx.isBuy ? price - reference : reference - price;
-                const double slipBps = (slipAbs / reference) * 10'000.0;
-                qCInfo(lcBridge) << "order" << uuid
-                                 << "fill" << volume
-                                 << "@" << price
-                                 << "slippage" << slipAbs
-                                 << "(" << slipBps << "bps)";
-            }
-            const double fillRate = ctx.volume > 0.0 ? ctx.filledVolume / ctx.volume : 1.0;
-            qCInfo(lcBridge) << "order" << uuid << "fill-rate" << fillRate;
+void EngineBridge::processMyOrderMessage(const QByteArray& payload) {
+    OrderEvent event;
+    if (!parse_order_event(std::string_view(payload.constData(), static_cast<size_t>(payload.size())), event)) return;
+    orders_.on_event(event, QDateTime::currentMSecsSinceEpoch(), orderUpdates_);
+    applyOrderUpdates();
+}
+
+void EngineBridge::applyOrderUpdates() {
+    for (const OrderUpdate& u : orderUpdates_) {
+        const QString uuid = QString::fromStdString(u.uuid);
+        // copied: slots reached through the signals below may place orders
+        QString identifier;
+        bool hasCtx = false;
+        PendingOrder ctx;
+        if (u.order) {
+            identifier = QString::fromStdString(u.order->identifier);
+            const auto it = pendingOrders_.constFind(identifier);
+            hasCtx = it != pendingOrders_.constEnd();
+            if (hasCtx) ctx = it.value();
         }
-    };
+        const auto referenceOf = [](const PendingOrder& c, const TrackedOrder& o) {
+            return o.is_buy ? (c.bestAskAtSubmit > 0.0 ? c.bestAskAtSubmit : o.price)
+                            : (c.bestBidAtSubmit > 0.0 ? c.bestBidAtSubmit : o.price);
+        };
 
-    if (tradeVolume > 0.0 && tradePrice > 0.0) {
-        handleFill(tradePrice, tradeVolume, tradeTs);
-    } else if (obj.contains("trades")) {
-        const QJsonArray trades = obj.value("trades").toArray();
-        for (const QJsonValue& v : trades) {
-            const QJsonObject t = v.toObject();
-            const double px = jsonToDouble(t.value("trade_price"));
-            const double vol = jsonToDouble(t.value("trade_volume"));
-            const qint64 ts = jsonToTimestampMs(t.value("trade_timestamp"));
-            handleFill(px, vol, ts);
+        if (u.fill_volume > 0.0 && u.fill_price > 0.0) {
+            emit orderExecuted(market_, u.fill_ts, u.fill_price, u.is_buy);
+            updatePosition(u.is_buy, u.fill_price, u.fill_volume, u.fill_ts);
+            if (u.order && hasCtx) {
+                if (u.order->fills == 1 && ctx.submitNs > 0) {
+                    LatencyRecorder::record(LatencyStage::SendToFill, LatencyRecorder::now_ns() - ctx.submitNs);
+                }
+                const double reference = referenceOf(ctx, *u.order);
+                if (reference > 0.0) {
+                    const double slipAbs = u.is_buy ? u.fill_price - reference : reference - u.fill_price;
+                    const double slipBps = (slipAbs / reference) * 10'000.0;
+                    qCInfo(lcBridge) << "order" << uuid
+                                     << "fill" << u.fill_volume
+                                     << "@" << u.fill_price
+                                     << "slippage" << slipAbs
+                                     << "(" << slipBps << "bps)";
+                }
+                const double fillRate = u.order->volume > 0.0 ? u.order->filled_volume / u.order->volume : 1.0;
+                qCInfo(lcBridge) << "order" << uuid << "fill-rate" << fillRate;
+            }
         }
-    }
+        if (!u.order || !u.state_changed) continue;
 
-    const double remaining = jsonToDouble(obj.value("remaining_volume"));
-    const QString state = obj.value("state").toString();
-    if (remaining <= 0.0 || state == QLatin1String("done")) {
-        auto it = pendingOrders_.find(uuid);
-        if (it != pendingOrders_.end()) {
-            const PendingOrder& ctx = it.value();
-            const double fillRate = ctx.volume > 0.0 ? ctx.filledVolume / ctx.volume : 1.0;
-            const double reference = ctx.isBuy
-                    ? (ctx.bestAskAtSubmit > 0.0 ? ctx.bestAskAtSubmit : ctx.price)
-                    : (ctx.bestBidAtSubmit > 0.0 ? ctx.bestBidAtSubmit : ctx.price);
-            const double avgFill = ctx.weightedFillPrice;
+        const TrackedOrder& o = *u.order;
+        qCInfo(lcBridge) << "order" << identifier << uuid << order_state_name(u.previous) << "->" << order_state_name(o.state);
+        if (!is_terminal(o.state)) continue;
+        if (hasCtx && o.filled_volume > 0.0) {
+            const double fillRate = o.volume > 0.0 ? o.filled_volume / o.volume : 1.0;
+            const double reference = referenceOf(ctx, o);
+            const double avgFill = o.avg_fill_price();
             double slipAbs = 0.0;
             double slipBps = 0.0;
+            double expectedBps = 0.0;
             if (reference > 0.0 && avgFill > 0.0) {
-                slipAbs = ctx.isBuy ? avgFill - reference : reference - avgFill;
+                slipAbs = o.is_buy ? avgFill - reference : reference - avgFill;
                 slipBps = (slipAbs / reference) * 10'000.0;
             }
+            if (reference > 0.0 && ctx.expectedFillAtSubmit > 0.0) {
+                const double expectedAbs = o.is_buy ? ctx.expectedFillAtSubmit - reference
+                                                    : reference - ctx.expectedFillAtSubmit;
+                expectedBps = (expectedAbs / reference) * 10'000.0;
+            }
             qCInfo(lcBridge) << "order" << uuid
                              << "completed fill-rate" << fillRate
                              << "avg-fill" << avgFill
                              << "slippage" << slipAbs
-                             << "(" << slipBps << "bps)";
+                             << "(" << slipBps << "bps, book predicted" << expectedBps << "bps)";
         }
-        pendingOrders_.remove(uuid);
+        pendingOrders_.remove(identifier);
     }
+    orderUpdates_.clear();
+    orders_.forget_closed(QDateTime::currentMSecsSinceEpoch() - kClosedOrderRetainMs);
 }
 
 void EngineBridge::updatePosition(bool isBuy, double price, double volume, qint64 ts_ms) {
@@ -476,7 +747,48 @@ void EngineBridge::scheduleRealtimeEmit() {
 }
 
 void EngineBridge::logRateLimit(const QString& context, int status, const QString& message) {
-    qCWarning(lcBridge) << "Rate limit" << context << "status" << status << message;
+    const RateGroup group = context == QLatin1String("order") || context == QLatin1String("cancel")
+            ? RateGroup::Order : RateGroup::Default;
+    const RateGroupStats stats = restClient_.rate_limiter().stats(group);
+    qCWarning(lcBridge) << "Rate limit" << context << "status" << status << message
+                        << "delayed" << stats.delayed << "limited" << stats.rate_limited;
+}
+
+bool EngineBridge::deferForRateLimit(RateGroup group, std::function<void()> retry) {
+    // behind earlier deferred requests, so they keep their order
+    if (!deferred_.empty() && !retryingDeferred_) {
+        deferred_.push_back(std::move(retry));
+        return true;
+    }
+    const long waitMs = restClient_.rate_limiter().try_acquire(group, RateLane::Low);
+    if (waitMs <= 0) return false;
+    // a retry sent away again keeps its place at the front
+    if (retryingDeferred_) deferred_.push_front(std::move(retry));
+    else deferred_.push_back(std::move(retry));
+    rateRetryTimer_.start(static_cast<int>(waitMs));
+    return true;
+}
+
+void EngineBridge::retryDeferred() {
+    // one request in flight at a time: the rest wait for its reply (or for
+    // the archive work around a candle fetch)
+    while (!deferred_.empty() && !pending_ && !archiveBusy_ && !rateRetryTimer_.isActive()) {
+        const std::function<void()> retry = std::move(deferred_.front());
+        deferred_.pop_front();
+        retryingDeferred_ = true;
+        retry();
+        retryingDeferred_ = false;
+    }
+}
+
+RateGroup EngineBridge::rateGroupFor(RequestKind kind) {
+    switch (kind) {
+        case RequestKind::Markets:
+        case RequestKind::Tickers: return RateGroup::Market;
+        case RequestKind::Candles5m: return RateGroup::Candles;
+        case RequestKind::None:
+        default: return RateGroup::Default;
+    }
 }
 
 void EngineBridge::placeLimitOrder(double price, double volume, bool isBuy) {
@@ -499,84 +811,172 @@ void EngineBridge::placeLimitOrder(double price, double volume, bool isBuy) {
         return;
     }
 
-    auto* watcher = new QFutureWatcher<OrderResult>(this);
-    connect(watcher, &QFutureWatcher<OrderResult>::finished, this, [this, watcher, normalized, isBuy]() {
-        const OrderResult res = watcher->result();
-        watcher->deleteLater();
-        if (res.accepted) {
-            const QString uuid = QString::fromStdString(res.uuid);
-            PendingOrder ctx;
-            ctx.isBuy = isBuy;
-            ctx.price = normalized.price;
-            ctx.volume = normalized.volume;
-            ctx.submittedMs = QDateTime::currentMSecsSinceEpoch();
-            ctx.filledVolume = 0.0;
-            ctx.weightedFillPrice = 0.0;
-            ctx.bestBidAtSubmit = bestBid_;
-            ctx.bestAskAtSubmit = bestAsk_;
-            pendingOrders_.insert(uuid, ctx);
-            qCInfo(lcBridge) << "order" << uuid << "accepted" << (isBuy ? "BUY" : "SELL")
-                             << "px" << ctx.price
-                             << "vol" << ctx.volume
-                             << "bestBid" << bestBid_
-                             << "bestAsk" << bestAsk_;
-            emit orderAccepted(market_, uuid, isBuy, normalized.price, normalized.volume);
-        } else {
-            QString msg = QString::fromStdString(res.error_message);
-            if (msg.isEmpty()) msg = QString::fromStdString(res.raw_response);
-            if (msg.isEmpty()) msg = QStringLiteral("unknown error");
-            const QString reason = res.http_status > 0
-                    ? QStringLiteral("HTTP %1 %2").arg(res.http_status).arg(msg)
-                    : QStringLiteral("REST failure: %1").arg(msg);
-            if (res.http_status == 429) {
-                logRateLimit(QStringLiteral("order"), res.http_status, reason);
-            } else {
-                qCWarning(lcBridge) << "order rejected" << reason;
-            }
-            emit orderRejected(market_, reason);
-        }
+    // tracked under its client identifier from here on, so private-socket
+    // reports that beat the REST response still find it
+    orders_.submit(normalized, QDateTime::currentMSecsSinceEpoch());
+    const QString identifier = QString::fromStdString(normalized.identifier);
+    PendingOrder ctx;
+    ctx.bestBidAtSubmit = book_.best_bid();
+    ctx.bestAskAtSubmit = book_.best_ask();
+    ctx.expectedFillAtSubmit = book_.vwap_to_size(isBuy ? BookSide::Ask : BookSide::Bid, normalized.volume);
+    ctx.submitNs = LatencyRecorder::now_ns();
+    recordTickToTrade(normalized.market, ctx.submitNs);
+    pendingOrders_.insert(identifier, ctx);
+
+    const bool queued = gateway_.post(normalized, [this, normalized](const GatewayReport& report) {
+        QMetaObject::invokeMethod(this, [this, normalized, report]() {
+            handlePostResult(normalized, report);
+            applyOrderUpdates();
+        }, Qt::QueuedConnection);
     });
-    watcher->setFuture(QtConcurrent::run([client = &restClient_, normalized]() {
-        return client->post_order(normalized);
-    }));
+    if (!queued) {
+        qCWarning(lcBridge) << "order" << identifier << "not sent: order queue full";
+        orders_.on_not_sent(normalized.identifier, "order queue full", QDateTime::currentMSecsSinceEpoch(), orderUpdates_);
+        emit orderRejected(market_, QStringLiteral("Order queue full"));
+        applyOrderUpdates();
+    }
 }
 
 void EngineBridge::cancelOrder(const QString& uuid) {
     if (uuid.isEmpty()) return;
-    CancelRequest req;
-    req.uuid = uuid.toStdString();
-    auto* watcher = new QFutureWatcher<OrderResult>(this);
-    connect(watcher, &QFutureWatcher<OrderResult>::finished, this, [this, watcher, uuid]() {
-        const OrderResult res = watcher->result();
-        watcher->deleteLater();
-        if (!res.accepted) {
-            QString msg = QString::fromStdString(res.error_message);
-            if (msg.isEmpty()) msg = QString::fromStdString(res.raw_response);
-            if (msg.isEmpty()) msg = QStringLiteral("unknown error");
-            const QString reason = res.http_status > 0
-                    ? QStringLiteral("Cancel HTTP %1 %2").arg(res.http_status).arg(msg)
-                    : QStringLiteral("Cancel failed: %1").arg(msg);
-            if (res.http_status == 429) {
-                logRateLimit(QStringLiteral("cancel"), res.http_status, reason);
+    const bool queued = gateway_.cancel(uuid.toStdString(), [this, uuid](const GatewayReport& report) {
+        QMetaObject::invokeMethod(this, [this, uuid, report]() {
+            handleCancelResult(uuid, report.cancel);
+            applyOrderUpdates();
+        }, Qt::QueuedConnection);
+    });
+    if (!queued) emit orderRejected(market_, QStringLiteral("Cancel not sent: order queue full"));
+}
+
+void EngineBridge::replaceOrder(const QString& uuid, double newPrice) {
+    const TrackedOrder* old = orders_.find_by_uuid(uuid.toStdString());
+    if (!old || is_terminal(old->state) || old->state == OrderState::PendingNew) {
+        emit orderRejected(market_, QStringLiteral("Replace: order %1 is not open").arg(uuid));
+        return;
+    }
+    OrderRequest req;
+    req.market = old->market;
+    req.side = old->is_buy ? "buy" : "sell";
+    req.ord_type = "limit";
+    req.price = UpbitRestClient::normalize_price(newPrice);
+    if (req.price <= 0.0) {
+        emit orderRejected(market_, QStringLiteral("Invalid order parameters"));
+        return;
+    }
+    // tracked at what is open now; the gateway re-posts whatever the cancel
+    // reply says was left, so a fill racing the cancel is not bought twice
+    OrderRequest tracked = req;
+    tracked.volume = old->volume - old->filled_volume;
+    const bool isBuy = old->is_buy;
+    orders_.submit(tracked, QDateTime::currentMSecsSinceEpoch());
+    req.identifier = tracked.identifier;
+    PendingOrder ctx;
+    ctx.bestBidAtSubmit = book_.best_bid();
+    ctx.bestAskAtSubmit = book_.best_ask();
+    ctx.expectedFillAtSubmit = book_.vwap_to_size(isBuy ? BookSide::Ask : BookSide::Bid, tracked.volume);
+    ctx.submitNs = LatencyRecorder::now_ns();
+    recordTickToTrade(req.market, ctx.submitNs);
+    pendingOrders_.insert(QString::fromStdString(req.identifier), ctx);
+
+    const bool queued = gateway_.cancel_replace(uuid.toStdString(), req, [this, uuid, req](const GatewayReport& report) {
+        QMetaObject::invokeMethod(this, [this, uuid, req, report]() {
+            handleCancelResult(uuid, report.cancel);
+            if (report.replacement_sent) {
+                OrderRequest sent = req;
+                sent.volume = report.replacement_volume;
+                handlePostResult(sent, report);
             } else {
-                qCWarning(lcBridge) << reason;
+                const std::string reason = report.cancel.accepted ? report.result.error_message : "cancel failed";
+                qCInfo(lcBridge) << "replace of" << uuid << "dropped:" << QString::fromStdString(reason);
+                orders_.on_not_sent(req.identifier, reason, QDateTime::currentMSecsSinceEpoch(), orderUpdates_);
             }
-            emit orderRejected(market_, reason);
-        } else {
-            pendingOrders_.remove(uuid);
-            qCInfo(lcBridge) << "order" << uuid << "cancel confirmed";
-        }
+            applyOrderUpdates();
+        }, Qt::QueuedConnection);
     });
-    watcher->setFuture(QtConcurrent::run([client = &restClient_, req]() {
-        return client->cancel_order(req);
-    }));
+    if (!queued) {
+        orders_.on_not_sent(req.identifier, "order queue full", QDateTime::currentMSecsSinceEpoch(), orderUpdates_);
+        emit orderRejected(market_, QStringLiteral("Replace not sent: order queue full"));
+        applyOrderUpdates();
+    }
+}
+
+void EngineBridge::recordTickToTrade(const std::string& market, long long sentNs) {
+    // the newest frame behind the book and candles this order was decided on
+    if (snapshot_.market != market || snapshot_.last_recv_ns <= 0) return;
+    LatencyRecorder::record(LatencyStage::TickToTrade, sentNs - snapshot_.last_recv_ns);
+}
+
+void EngineBridge::handlePostResult(const OrderRequest& req, const GatewayReport& report) {
+    const OrderResult& res = report.result;
+    const QString market = QString::fromStdString(req.market);
+    const QString identifier = QString::fromStdString(req.identifier);
+    const bool isBuy = req.side == "buy";
+    orders_.on_post_result(req.identifier, res, QDateTime::currentMSecsSinceEpoch(), orderUpdates_);
+    if (res.accepted) {
+        const QString uuid = QString::fromStdString(res.uuid);
+        const PendingOrder ctx = pendingOrders_.value(identifier);
+        qCInfo(lcBridge) << "order" << identifier << uuid << "accepted" << (isBuy ? "BUY" : "SELL")
+                         << "px" << req.price
+                         << "vol" << req.volume
+                         << "bestBid" << ctx.bestBidAtSubmit
+                         << "bestAsk" << ctx.bestAskAtSubmit
+                         << "expected-fill" << ctx.expectedFillAtSubmit
+                         << "imbalance" << book_.imbalance()
+                         << "queued/ack us" << report.queue_us << report.ack_us;
+        emit orderAccepted(market, uuid, isBuy, req.price, req.volume);
+        return;
+    }
+    QString msg = QString::fromStdString(res.error_message);
+    if (msg.isEmpty()) msg = QString::fromStdString(res.raw_response);
+    if (msg.isEmpty()) msg = QStringLiteral("unknown error");
+    const QString reason = res.http_status > 0
+            ? QStringLiteral("HTTP %1 %2").arg(res.http_status).arg(msg)
+            : QStringLiteral("REST failure: %1").arg(msg);
+    if (res.http_status == 429) {
+        logRateLimit(QStringLiteral("order"), res.http_status, reason);
+    } else {
+        qCWarning(lcBridge) << "order rejected" << reason;
+    }
+    emit orderRejected(market, reason);
+}
+
+void EngineBridge::handleCancelResult(const QString& uuid, const OrderResult& res) {
+    if (res.accepted) {
+        qCInfo(lcBridge) << "order" << uuid << "cancel confirmed";
+        orders_.on_cancel_result(uuid.toStdString(), res, QDateTime::currentMSecsSinceEpoch(), orderUpdates_);
+        return;
+    }
+    QString msg = QString::fromStdString(res.error_message);
+    if (msg.isEmpty()) msg = QString::fromStdString(res.raw_response);
+    if (msg.isEmpty()) msg = QStringLiteral("unknown error");
+    const QString reason = res.http_status > 0
+            ? QStringLiteral("Cancel HTTP %1 %2").arg(res.http_status).arg(msg)
+            : QStringLiteral("Cancel failed: %1").arg(msg);
+    if (res.http_status == 429) {
+        logRateLimit(QStringLiteral("cancel"), res.http_status, reason);
+    } else {
+        qCWarning(lcBridge) << reason;
+    }
+    emit orderRejected(market_, reason);
 }
 
 void EngineBridge::onNetworkReply() {
     if (!pending_) return;
     QNetworkReply* reply = pending_;
     pending_ = nullptr;
-    const auto guard = qScopeGuard([reply]() { reply->deleteLater(); });
+    const auto guard = qScopeGuard([this, reply]() {
+        reply->deleteLater();
+        retryDeferred();
+    });
+
+    RateLimiter& limiter = restClient_.rate_limiter();
+    const QByteArray remaining = reply->rawHeader("Remaining-Req");
+    if (!remaining.isEmpty()) limiter.on_response(std::string_view(remaining.constData(), static_cast<size_t>(remaining.size())));
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 429) {
+        limiter.on_rate_limited(rateGroupFor(pendingKind_));
+        logRateLimit(QStringLiteral("quotation"), status, QString::fromUtf8(remaining));
+    }
 
     if (reply->error() != QNetworkReply::NoError) {
         qCWarning(lcBridge) << "network request failed" << reply->errorString();
@@ -586,7 +986,6 @@ void EngineBridge::onNetworkReply() {
             switch (failedKind) {
                 case RequestKind::Markets: fetchMarkets(); break;
                 case RequestKind::Tickers: fetchNextTickerChunk(); break;
-                case RequestKind::Candles1m: evaluateNextCandidate(); break;
                 case RequestKind::Candles5m: fetchCandles5m(); break;
                 case RequestKind::None:
                 default: break;
@@ -629,46 +1028,6 @@ void EngineBridge::onNetworkReply() {
         fetchNextTickerChunk();
         break;
     }
-    case RequestKind::Candles1m: {
-        std::vector<Candle> minutes;
-        if (doc.isArray()) {
-            const QJsonArray arr = doc.array();
-            minutes.reserve(arr.size());
-            for (const QJsonValue& v : arr) {
-                const QJsonObject obj = v.toObject();
-                Candle c{};
-                c.ts_ms = static_cast<long long>(obj.value("timestamp").toVariant().toLongLong());
-                c.open = obj.value("opening_price").toDouble();
-                c.high = obj.value("high_price").toDouble();
-                c.low = obj.value("low_price").toDouble();
-                c.close = obj.value("trade_price").toDouble();
-                c.volume = obj.value("candle_acc_trade_volume").toDouble();
-                minutes.push_back(c);
-            }
-        }
-        if (minutes.size() > 1) {
-            std::reverse(minutes.begin(), minutes.end());
-            double sumSq = 0.0;
-            size_t n = 0;
-            for (size_t i = 1; i < minutes.size(); ++i) {
-                if (minutes[i-1].close <= 0.0 || minutes[i].close <= 0.0) continue;
-                const double r = std::log(minutes[i].close / minutes[i-1].close);
-                sumSq += r * r;
-                ++n;
-            }
-            const double rv = (n > 0) ? std::sqrt(sumSq / static_cast<double>(n)) : 0.0;
-            const double vol24 = volume24h_.value(pendingMarket_, 0.0);
-            if (rv > 0.0 && vol24 > 0.0) {
-                const double score = std::log(vol24) * rv;
-                if (score > bestScore_) {
-                    bestScore_ = score;
-                    bestMarket_ = pendingMarket_;
-                }
-            }
-        }
-        evaluateNextCandidate();
-        break;
-    }
     case RequestKind::Candles5m: {
         std::vector<Candle> updated;
         if (doc.isArray()) {
@@ -677,7 +1036,8 @@ void EngineBridge::onNetworkReply() {
             for (const QJsonValue& v : arr) {
                 const QJsonObject obj = v.toObject();
                 Candle c{};
-                c.ts_ms = static_cast<long long>(obj.value("timestamp").toVariant().toLongLong());
+                // `timestamp` is the bar's last trade; bars are keyed by their bucket start
+                c.ts_ms = bar_open_ms(obj.value("timestamp").toVariant().toLongLong(), pendingUnit_ * 60'000LL);
                 c.open = obj.value("opening_price").toDouble();
                 c.high = obj.value("high_price").toDouble();
                 c.low = obj.value("low_price").toDouble();
@@ -686,11 +1046,27 @@ void EngineBridge::onNetworkReply() {
                 updated.push_back(c);
             }
         }
-        if (!updated.empty()) {
-            std::reverse(updated.begin(), updated.end());
-            c5_ = std::move(updated);
-            emit candlesUpdated(pendingMarket_);
+        std::reverse(updated.begin(), updated.end());
+        if (updated.empty()) break;
+        if (!archive_) {
+            applyCandles5m(pendingMarket_, updated);
+            break;
         }
+        // the merge writes the candle log under the archive lock; see fetchCandles
+        using Bars = std::vector<Candle>;
+        archiveBusy_ = true;
+        auto* watcher = new QFutureWatcher<Bars>(this);
+        connect(watcher, &QFutureWatcher<Bars>::finished, this, [this, watcher, market = pendingMarket_]() {
+            const Bars bars = watcher->result();
+            watcher->deleteLater();
+            archiveBusy_ = false;
+            applyCandles5m(market, bars);
+            retryDeferred();
+        });
+        watcher->setFuture(runInBackground([archive = archive_.get(), m = pendingMarket_.toStdString(), unit = pendingUnit_,
+                                            lookback = static_cast<size_t>(pendingLookback_), bars = std::move(updated)]() {
+            return archive->merge(m, unit, bars, lookback, MarketArchive::now_ms());
+        }));
         break;
     }
     case RequestKind::None:
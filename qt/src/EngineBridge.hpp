@@ -1,32 +1,54 @@
 #pragma once
 #include <QObject>
+#include <QFuture>
 #include <QTimer>
+#include <QThread>
 #include <QString>
 #include <QStringList>
 #include <QHash>
 #include <QList>
 #include <QPair>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <limits>
+#include "latency_histogram.hpp"
+#include "market_archive.hpp"
+#include "market_pipeline.hpp"
+#include "market_selector.hpp"
+#include "multi_market_engine.hpp"
+#include "order_book.hpp"
+#include "order_gateway.hpp"
+#include "order_tracker.hpp"
 #include "types.hpp"
 #include "upbit_rest.hpp"
+#include "ws_decoder.hpp"
 
 class QNetworkAccessManager;
 class QNetworkReply;
 class QWebSocket;
+class PublicFeed;
 class QFutureWatcherBase;
-class QJsonObject;
 
 class EngineBridge : public QObject {
     Q_OBJECT
 public:
     EngineBridge(QString access, QString secret, QObject* parent=nullptr);
+    ~EngineBridge() override;
     void start();
-    const std::vector<Candle>& candles() const { return c5_; }
+    // Subscribes the public socket in Upbit's SIMPLE (abbreviated-key) format.
+    void setCompactStream(bool compact);
+    CandleSpan candles() const { return c5_.view(); }
+    // Loads every archived 5m bar of `market` off this thread and hands them
+    // to archivedCandlesLoaded, oldest first (none without UPBIT_ARCHIVE_DIR).
+    void loadArchivedCandles(const QString& market);
 
 signals:
     void marketChanged(const QString& market);
     void candlesUpdated(const QString& market);
+    void archivedCandlesLoaded(const QString& market, const std::vector<Candle>& bars);
     void orderExecuted(const QString& market, qint64 ts_ms, double price, bool isBuy);
     void positionInfo(const QString& market, double qty, double avgPrice);
     void orderAccepted(const QString& market, const QString& uuid, bool isBuy, double price, double volume);
@@ -39,80 +61,136 @@ private slots:
     void onPrivateWsConnected();
     void onPublicWsClosed();
     void onPrivateWsClosed();
-    void onPublicTextMessage(const QString& message);
-    void onPublicBinaryMessage(const QByteArray& message);
     void onPrivateTextMessage(const QString& message);
     void onPrivateBinaryMessage(const QByteArray& message);
 
 public slots:
     void placeLimitOrder(double price, double volume, bool isBuy);
     void cancelOrder(const QString& uuid);
+    // Cancels the order and re-posts what is left of it at newPrice.
+    void replaceOrder(const QString& uuid, double newPrice);
 
 private:
-    enum class RequestKind { None, Markets, Tickers, Candles5m, Candles1m };
+    enum class RequestKind { None, Markets, Tickers, Candles5m };
 
+    // Book state when an order was sent; fills are measured against it.
     struct PendingOrder {
-        bool isBuy{};
-        double price{};
-        double volume{};
-        qint64 submittedMs{};
-        double filledVolume{0.0};
-        double weightedFillPrice{0.0};
         double bestBidAtSubmit{0.0};
         double bestAskAtSubmit{0.0};
+        double expectedFillAtSubmit{0.0}; // book VWAP for the full volume when submitted
+        long long submitNs{0};            // LatencyRecorder::now_ns
     };
 
     void fetchMarkets();
     void fetchNextTickerChunk();
-    void evaluateNextCandidate();
+    // Seeds the ranker from the candidates' 1m bars, fetched as one batch,
+    // and picks the best of them.
+    void rankCandidates();
+    void finishSelection(const QString& market);
+    // Seeds the rest of the KRW markets in the background; their trades keep
+    // the pipeline's ranking live from then on.
+    void seedUniverse();
+    // Logs the pipeline's ranking when its order changed.
+    void pullRanking();
     void fetchCandles(int unit, int count, RequestKind kind, const QString& market);
+    // `count` bars are wanted; `requested` is what is missing from the archive.
+    void sendCandlesRequest(int unit, int count, int requested, RequestKind kind, const QString& market);
+    // Takes fetched (and archive-merged) 5m bars as the charted market's history.
+    void applyCandles5m(const QString& market, const std::vector<Candle>& bars);
     void fetchCandles5m();
+    // Fetches the 5m buckets [fromMs, toMs) of every tracked market with
+    // `to`/`count` and merges them under the streamed bars.
+    void fillCandleGap(qint64 fromMs, qint64 toMs);
+    void startShards();
+    void evaluateShards();
     void ensureSockets();
     void connectPublicSocket();
     void connectPrivateSocket();
     void subscribePublic(const QString& market);
     void subscribePrivate(const QString& market);
-    void handlePublicMessage(const QByteArray& payload);
     void handlePrivateMessage(const QByteArray& payload);
-    void processTradeMessage(const QJsonObject& obj);
-    void processOrderbookMessage(const QJsonObject& obj);
-    void processMyOrderMessage(const QJsonObject& obj);
+    void pullSnapshot();
+    void processMyOrderMessage(const QByteArray& payload);
+    // Gateway answers, on this thread; both feed orderUpdates_.
+    void handlePostResult(const OrderRequest& req, const GatewayReport& report);
+    void handleCancelResult(const QString& uuid, const OrderResult& res);
+    void recordTickToTrade(const std::string& market, long long sentNs);
+    // Emits fills and logs transitions for everything in orderUpdates_, then clears it.
+    void applyOrderUpdates();
     void updatePosition(bool isBuy, double price, double volume, qint64 ts_ms);
     QByteArray authToken(const QList<QPair<QString, QString>>& params = {}) const;
     void scheduleRealtimeEmit();
     void logRateLimit(const QString& context, int status, const QString& message);
+    // Returns true (and queues retry) when the shared limiter has no token for the group yet,
+    // or when earlier deferred requests are still queued.
+    bool deferForRateLimit(RateGroup group, std::function<void()> retry);
+    // Runs queued retries in order while no quotation request is in flight.
+    void retryDeferred();
+    static RateGroup rateGroupFor(RequestKind kind);
+    // QtConcurrent::run, kept so the destructor can wait for it.
+    template <typename Fn>
+    auto runInBackground(Fn fn);
 
     QString access_;
     QString secret_;
     QString market_;
-    std::vector<Candle> c5_;
+    MarketState::Candles5m c5_;
     QTimer timer_;
     class QNetworkAccessManager* net_{nullptr};
     class QNetworkReply* pending_{nullptr};
     RequestKind pendingKind_{RequestKind::None};
     QString pendingMarket_;
     int pendingUnit_{0};
+    int pendingLookback_{0};
+    // quotation requests the limiter sent away, oldest first; none is dropped
+    std::deque<std::function<void()>> deferred_;
+    QTimer rateRetryTimer_;
+    bool retryingDeferred_{false};
+    bool archiveBusy_{false}; // a candle gap count or merge is running on the archive
 
     QStringList marketsKRW_;
     int nextTickerIndex_{0};
     QHash<QString, double> volume24h_;
     QStringList candidateQueue_;
-    int candidateIndex_{0};
-    QString bestMarket_;
-    double bestScore_{-std::numeric_limits<double>::infinity()};
+    std::vector<std::string> universe_; // every KRW market with turnover, subscribed for trades once seeded
+    std::uint64_t rankingVersion_{0};
+    std::vector<RankedMarket> ranking_;
     bool selectionReady_{false};
-    QWebSocket* wsPublic_{nullptr};
+    PublicFeed* publicFeed_{nullptr}; // lives on netThread_
     QWebSocket* wsPrivate_{nullptr};
     QTimer wsReconnectTimer_;
     QTimer heartbeatTimer_;
+    LatencyReport latencyReport_; // stage percentiles per heartbeat
     QString subscribedMarket_;
     bool wsPublicConnected_{false};
+    qint64 gapFromMs_{0}; // bucket the public socket dropped in; 0 while no gap is pending
+    // refills the bucket the stream resumed in once it closes; restarted per reconnect
+    QTimer resumedFillTimer_;
+    qint64 resumedFromMs_{0};
     bool wsPrivateConnected_{false};
     UpbitRestClient restClient_;
-    QHash<QString, PendingOrder> pendingOrders_;
+    // orders leave through here, pipelined; its callbacks hop back to this thread
+    OrderGateway gateway_;
+    OrderTracker orders_;
+    std::vector<OrderUpdate> orderUpdates_;
+    QHash<QString, PendingOrder> pendingOrders_; // by client identifier
     double positionQty_{0.0};
     double positionAvg_{0.0};
-    double bestBid_{0.0};
-    double bestAsk_{0.0};
+    OrderBook book_;
+    // every tracked market (the charted one included), fed from one combined subscription
+    std::unique_ptr<MultiMarketEngine> shards_;
+    // candles and trades on disk (UPBIT_ARCHIVE_DIR); REST then only fills the gap since the last run
+    std::unique_ptr<MarketArchive> archive_;
+    // public frames: network thread -> SPSC ring -> strategy thread; the GUI only polls snapshots
+    QThread netThread_;
+    MarketPipeline pipeline_;
+    QTimer snapshotTimer_;
+    std::uint64_t snapshotVersion_{0};
+    MarketSnapshot snapshot_;
+    std::uint64_t lastPipelineBytes_{0};
+    WsFormat publicFormat_{WsFormat::Default};
     qint64 lastRealtimeEmitMs_{0};
+    QList<QFuture<void>> background_; // unfinished work touching members; see runInBackground
+    QFuture<void> evaluation_;        // the running evaluate_all, if any
+    std::atomic<bool> stopping_{false};
 };
@@ -18,6 +18,7 @@ MainWindow::MainWindow(const QString& accessKey, const QString& secretKey, QWidg
         statusBar()->showMessage(QStringLiteral("%1 선택. 5분봉 실시간 업데이트.").arg(market));
     });
     connect(engine_, &EngineBridge::candlesUpdated, this, &MainWindow::onCandlesUpdated);
+    connect(engine_, &EngineBridge::archivedCandlesLoaded, this, &MainWindow::onArchivedCandlesLoaded);
     connect(engine_, &EngineBridge::orderExecuted, this, &MainWindow::onOrderExecuted);
     connect(engine_, &EngineBridge::positionInfo, this, &MainWindow::onPositionInfo);
     connect(engine_, &EngineBridge::orderAccepted, this, [this](const QString& market, const QString& uuid, bool isBuy, double price, double volume) {
@@ -41,8 +42,21 @@ MainWindow::MainWindow(const QString& accessKey, const QString& secretKey, QWidg
 MainWindow::~MainWindow() = default;
 
 void MainWindow::onCandlesUpdated(const QString& market) {
-    Q_UNUSED(market);
-    chart_->setCandles(engine_->candles());
+    // a new market redraws from scratch with the live bars, and again once its
+    // archived history has loaded; the same one only moves its newest bars
+    if (market != chartMarket_) {
+        chartMarket_ = market;
+        chart_->setCandles(engine_->candles());
+        engine_->loadArchivedCandles(market);
+        return;
+    }
+    chart_->syncCandles(engine_->candles());
+}
+
+void MainWindow::onArchivedCandlesLoaded(const QString& market, const std::vector<Candle>& bars) {
+    if (market != chartMarket_ || bars.empty()) return;
+    chart_->setCandles(bars);
+    chart_->syncCandles(engine_->candles());
 }
 
 void MainWindow::onOrderExecuted(const QString& market, qint64 ts_ms, double price, bool isBuy) {
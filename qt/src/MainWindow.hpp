@@ -1,6 +1,8 @@
 #pragma once
 #include <QMainWindow>
 #include <QString>
+#include <vector>
+#include "types.hpp"
 
 class ChartWidget;
 class EngineBridge;
@@ -13,11 +15,13 @@ public:
 
 private slots:
     void onCandlesUpdated(const QString& market);
+    void onArchivedCandlesLoaded(const QString& market, const std::vector<Candle>& bars);
     void onOrderExecuted(const QString& market, qint64 ts_ms, double price, bool isBuy);
     void onPositionInfo(const QString& market, double qty, double avgPrice);
 
 private:
     ChartWidget* chart_{nullptr};
     EngineBridge* engine_{nullptr};
+    QString chartMarket_;
 };
 
@@ -0,0 +1,41 @@
+#include "PublicFeed.hpp"
+#include "market_pipeline.hpp"
+#include <QWebSocket>
+
+PublicFeed::PublicFeed(MarketPipeline& pipeline) : QObject(nullptr), pipeline_(pipeline) {}
+
+void PublicFeed::open(const QUrl& url) {
+    if (!socket_) {
+        socket_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+        connect(socket_, &QWebSocket::connected, this, &PublicFeed::connected);
+        connect(socket_, &QWebSocket::disconnected, this, &PublicFeed::disconnected);
+        connect(socket_, &QWebSocket::binaryMessageReceived, this, &PublicFeed::onBinaryMessage);
+        connect(socket_, &QWebSocket::textMessageReceived, this, &PublicFeed::onTextMessage);
+    }
+    if (socket_->state() != QAbstractSocket::UnconnectedState) return;
+    socket_->open(url);
+}
+
+void PublicFeed::sendSubscription(const QByteArray& message) {
+    if (socket_ && socket_->state() == QAbstractSocket::ConnectedState) socket_->sendBinaryMessage(message);
+}
+
+void PublicFeed::ping() {
+    if (socket_ && socket_->state() == QAbstractSocket::ConnectedState) socket_->ping();
+}
+
+void PublicFeed::onBinaryMessage(const QByteArray& message) {
+    // Upbit sends binary frames; decode straight from Qt's buffer
+    handleFrame(message);
+}
+
+void PublicFeed::onTextMessage(const QString& message) {
+    handleFrame(message.toUtf8());
+}
+
+void PublicFeed::handleFrame(const QByteArray& payload) {
+    if (payload.isEmpty()) return;
+    const auto format = static_cast<WsFormat>(format_.load(std::memory_order_relaxed));
+    const std::string_view frame(payload.constData(), static_cast<size_t>(payload.size()));
+    pipeline_.on_frame(frame, format);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+#include <atomic>
+#include "ws_decoder.hpp"
+
+class QWebSocket;
+class MarketPipeline;
+
+// Owns the public market-data socket on the network thread. Frames are
+// decoded right here and handed to the pipeline; nothing touches the GUI
+// thread except the connection-state signals.
+class PublicFeed : public QObject {
+    Q_OBJECT
+public:
+    explicit PublicFeed(MarketPipeline& pipeline);
+
+    // Safe from any thread; applies to the next frame.
+    void setFormat(WsFormat format) { format_.store(static_cast<int>(format), std::memory_order_relaxed); }
+
+public slots:
+    void open(const QUrl& url);
+    void sendSubscription(const QByteArray& message);
+    void ping();
+
+signals:
+    void connected();
+    void disconnected();
+
+private slots:
+    void onBinaryMessage(const QByteArray& message);
+    void onTextMessage(const QString& message);
+
+private:
+    void handleFrame(const QByteArray& payload);
+
+    MarketPipeline& pipeline_;
+    QWebSocket* socket_{nullptr}; // created on first open() so it lives on the feed's thread
+    std::atomic<int> format_{static_cast<int>(WsFormat::Default)};
+};